@@ -0,0 +1,132 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "symbolic/sx/sx_tools.hpp"
+#include "symbolic/mx/mx_tools.hpp"
+#include "symbolic/fx/sx_function.hpp"
+#include "symbolic/fx/mx_function.hpp"
+#include "symbolic/thread_pool.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+
+using namespace std;
+using namespace CasADi;
+
+/** Measures the time for evaluating a function for many sets of inputs, calling evaluate once per set 
+    or evaluateBatch, serially or in parallel.
+    Usage: batch_benchmark [num_evaluations]
+*/
+
+// Van der Pol oscillator
+SXMatrix vdp(const SXMatrix& x, const SX& u, const SX& mu){
+  SXMatrix xdot(2,1,0);
+  xdot[0] = x[1];
+  xdot[1] = mu*(1-x[0]*x[0])*x[1] - x[0] + u;
+  return xdot;
+}
+
+// Van der Pol oscillator with an uncertain parameter, integrated with a number of explicit RK4 steps
+SXFunction vdpRK4(int nsteps){
+  SXMatrix x = ssym("x",2);
+  SXMatrix u = ssym("u",nsteps);
+  SXMatrix mu = ssym("mu");
+  SX h = 10.0/nsteps;
+  SXMatrix xk = x;
+  for(int k=0; k<nsteps; ++k){
+    SXMatrix k1 = vdp(xk,u.at(k),mu.at(0));
+    SXMatrix k2 = vdp(xk + h/2*k1,u.at(k),mu.at(0));
+    SXMatrix k3 = vdp(xk + h/2*k2,u.at(k),mu.at(0));
+    SXMatrix k4 = vdp(xk + h*k3,u.at(k),mu.at(0));
+    xk += h/6*(k1 + 2*k2 + 2*k3 + k4);
+  }
+  vector<SXMatrix> arg(3);
+  arg[0] = x;
+  arg[1] = u;
+  arg[2] = mu;
+  return SXFunction(arg,xk);
+}
+
+// Linear map with a nonlinearity, as matrix-valued operations
+MXFunction linearMapMX(int n){
+  MX x = msym("x",n);
+  DMatrix A(n,n,0);
+  for(int k=0; k<A.size(); ++k) A.data()[k] = cos(0.1*k);
+  return MXFunction(x,sin(mul(MX(A),x)) + x);
+}
+
+void benchmark(const string& name, FX f, int n){
+  f.init();
+  
+  // Random inputs, stored one evaluation after another
+  vector<vector<double> > arg(f.getNumInputs()), res_ref(f.getNumOutputs()), res(f.getNumOutputs());
+  vector<const double*> argp(arg.size());
+  vector<double*> resp(res.size());
+  for(int ind=0; ind<arg.size(); ++ind){
+    arg[ind].resize(n*f.input(ind).size());
+    for(int k=0; k<arg[ind].size(); ++k) arg[ind][k] = rand()/double(RAND_MAX);
+    argp[ind] = getPtr(arg[ind]);
+  }
+  for(int ind=0; ind<res.size(); ++ind){
+    res_ref[ind].resize(n*f.output(ind).size());
+    res[ind].resize(n*f.output(ind).size());
+    resp[ind] = getPtr(res[ind]);
+  }
+  
+  // One evaluation at a time
+  double t0 = ThreadPool::getWallTime();
+  for(int j=0; j<n; ++j){
+    for(int ind=0; ind<arg.size(); ++ind){
+      int nnz = f.input(ind).size();
+      f.input(ind).set(&arg[ind][j*nnz]);
+    }
+    f.evaluate();
+    for(int ind=0; ind<res.size(); ++ind){
+      int nnz = f.output(ind).size();
+      f.output(ind).get(&res_ref[ind][j*nnz]);
+    }
+  }
+  double t_ref = ThreadPool::getWallTime()-t0;
+  
+  // Batch, serial and parallel
+  double t_batch[2];
+  bool equal[2];
+  for(int parallel=0; parallel<2; ++parallel){
+    t0 = ThreadPool::getWallTime();
+    f.evaluateBatch(n,getPtr(argp),getPtr(resp),parallel);
+    t_batch[parallel] = ThreadPool::getWallTime()-t0;
+    equal[parallel] = res==res_ref;
+  }
+  
+  cout << setw(20) << name << ": " << n << " evaluations, evaluate " << setw(10) << t_ref*1e3 << " ms, batch " 
+       << setw(10) << t_batch[0]*1e3 << " ms, parallel batch (" << ThreadPool::getInstance().getNumThreads() << " threads) " 
+       << setw(10) << t_batch[1]*1e3 << " ms" << (equal[0] && equal[1] ? "" : ", RESULTS DIFFER") << endl;
+}
+
+int main(int argc, char* argv[]){
+  int n = argc>1 ? atoi(argv[1]) : 10000;
+  benchmark("vdp rk4 (100)",vdpRK4(100),n);
+  benchmark("linear map mx (100)",linearMapMX(100),n);
+  return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "symbolic/matrix/crs_sparsity.hpp"
+#include "symbolic/matrix/sparsity_tools.hpp"
+#include "symbolic/thread_pool.hpp"
+#include "symbolic/casadi_options.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+
+using namespace std;
+using namespace CasADi;
+
+/** Compares the sequential and the parallel graph colorings used for Jacobian and Hessian compression.
+    Usage: coloring_benchmark [num_threads] [n]
+*/
+
+// Random symmetric pattern with a given number of nonzeros per row (on average)
+CRSSparsity sp_random(int n, int nnz_per_row){
+  vector<int> row, col;
+  srand(0);
+  for(int i=0; i<n; ++i){
+    row.push_back(i);
+    col.push_back(i);
+    for(int k=0; k<nnz_per_row/2; ++k){
+      row.push_back(i);
+      col.push_back(rand() % n);
+    }
+  }
+  CRSSparsity sp = sp_triplet(n,n,row,col);
+  return sp.patternUnion(sp.transpose());
+}
+
+// Time a coloring and print the result
+void benchmark(const string& name, const CRSSparsity& sp){
+  CRSSparsity spT = sp.transpose();
+  double t0 = ThreadPool::getWallTime();
+  CRSSparsity D_uni = sp.unidirectionalColoring(spT);
+  double t1 = ThreadPool::getWallTime();
+  CRSSparsity D_uni_par = sp.unidirectionalColoringParallel(spT);
+  double t2 = ThreadPool::getWallTime();
+  CRSSparsity D_star = sp.starColoring();
+  double t3 = ThreadPool::getWallTime();
+  CRSSparsity D_star_par = sp.starColoringParallel();
+  double t4 = ThreadPool::getWallTime();
+  
+  cout << setw(24) << left << name << " n=" << setw(8) << sp.size1() << " nnz=" << setw(9) << sp.size() << right << endl;
+  cout << "  unidirectional: " << setw(5) << D_uni.size1() << " colors in " << setw(8) << t1-t0 << " s, parallel: " 
+       << setw(5) << D_uni_par.size1() << " colors in " << setw(8) << t2-t1 << " s" << endl;
+  cout << "  star:           " << setw(5) << D_star.size1() << " colors in " << setw(8) << t3-t2 << " s, parallel: " 
+       << setw(5) << D_star_par.size1() << " colors in " << setw(8) << t4-t3 << " s" << endl;
+}
+
+int main(int argc, char* argv[]){
+  // Number of threads in the pool, 0 means one per processor
+  int num_threads = argc>1 ? atoi(argv[1]) : 0;
+  CasadiOptions::setNumThreads(num_threads);
+  cout << "Using " << ThreadPool::getInstance().getNumThreads() << " threads" << endl;
+  
+  // Problem size
+  int n = argc>2 ? atoi(argv[2]) : 100000;
+
+  // Banded patterns
+  benchmark("tridiagonal",sp_banded(n,1));
+  benchmark("banded (bandwidth 5)",sp_banded(n,5));
+  benchmark("band + diagonal",sp_band(n,0) + sp_band(n,20) + sp_band(n,-20));
+  
+  // Block diagonal patterns
+  benchmark("block diagonal 4x4",blkdiag(vector<CRSSparsity>(n/4,sp_dense(4,4))));
+  benchmark("block diagonal 20x20",blkdiag(vector<CRSSparsity>(n/20,sp_dense(20,20))));
+
+  // Random patterns
+  benchmark("random (6 per row)",sp_random(n,6));
+  benchmark("random (20 per row)",sp_random(n/10,20));
+  
+  return 0;
+}
@@ -0,0 +1,87 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "symbolic/casadi.hpp"
+#include "symbolic/thread_pool.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+
+using namespace std;
+using namespace CasADi;
+
+/** Compares the Jacobian sparsity detection with one and several bit words per nonzero.
+    Usage: sparsity_benchmark [n]
+*/
+
+// Time the Jacobian sparsity detection for a given number of words per nonzero
+double timeJacSparsity(const SXMatrix& x, const SXMatrix& g, int sparsity_width, int& nnz){
+  SXFunction f(x,g);
+  f.setOption("sparsity_width",sparsity_width);
+  f.init();
+  double t0 = ThreadPool::getWallTime();
+  nnz = f.jacSparsity().size();
+  return ThreadPool::getWallTime()-t0;
+}
+
+// Print the timings
+void benchmark(const string& name, const SXMatrix& x, const SXMatrix& g){
+  cout << setw(24) << left << name << " n=" << setw(8) << x.size() << " m=" << setw(8) << g.size() << right;
+  int nnz_ref;
+  double t_ref = timeJacSparsity(x,g,1,nnz_ref);
+  cout << " nnz=" << setw(9) << nnz_ref << " 1 word: " << setw(10) << t_ref << " s";
+  int nw[] = {4,8,16};
+  for(int k=0; k<3; ++k){
+    int nnz;
+    double t = timeJacSparsity(x,g,nw[k],nnz);
+    casadi_assert(nnz==nnz_ref);
+    cout << ", " << nw[k] << " words: " << setw(10) << t << " s (x" << setprecision(3) << t_ref/t << ")" << setprecision(6);
+  }
+  cout << endl;
+}
+
+int main(int argc, char* argv[]){
+  // Problem size
+  int n = argc>1 ? atoi(argv[1]) : 20000;
+  SXMatrix x = ssym("x",n);
+  vector<SX> g;
+
+  // Constraints of a discretized optimal control problem
+  g.clear();
+  for(int i=0; i<n; ++i) g.push_back(x.at((i+1)%n) - x.at(i) - 0.1*sin(x.at(i))*x.at((i+2)%n));
+  benchmark("banded",x,g);
+
+  // Random sparse constraints
+  g.clear();
+  srand(0);
+  for(int i=0; i<n; ++i) g.push_back(x.at(i)*x.at(rand()%n) + sin(x.at(rand()%n)));
+  benchmark("random",x,g);
+
+  // Constraints coupled through a common term
+  g.clear();
+  SX s = 0;
+  for(int i=0; i<n; ++i) s += x.at(i);
+  for(int i=0; i<n/10; ++i) g.push_back(s*x.at(i));
+  benchmark("coupled",x,g);
+
+  return 0;
+}
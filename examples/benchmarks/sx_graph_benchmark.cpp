@@ -0,0 +1,76 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "symbolic/sx/sx_tools.hpp"
+#include "symbolic/thread_pool.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <sys/resource.h>
+
+using namespace std;
+using namespace CasADi;
+
+/** Measures the time needed to construct and destroy large SX expression graphs, and the peak memory usage.
+    Usage: sx_graph_benchmark [n]
+*/
+
+// Peak resident set size in MB
+double peakRSS(){
+  struct rusage usage;
+  getrusage(RUSAGE_SELF,&usage);
+  return usage.ru_maxrss/1024.0;
+}
+
+// Chained Rosenbrock-type objective with couplings between neighbouring variables
+SXMatrix objective(const SXMatrix& x){
+  int n = x.size();
+  SX f = 0;
+  for(int i=0; i<n-1; ++i){
+    SX a = x.at(i+1) - x.at(i)*x.at(i);
+    SX b = 1 - x.at(i);
+    f += 100*a*a + b*b + sin(x.at(i)*x.at(i+1))*exp(-x.at(i+1));
+  }
+  return f;
+}
+
+int main(int argc, char* argv[]){
+  // Problem size
+  int n = argc>1 ? atoi(argv[1]) : 20000;
+  SXMatrix x = ssym("x",n);
+
+  for(int rep=0; rep<3; ++rep){
+    double t0 = ThreadPool::getWallTime();
+    double t1, t2;
+    {
+      SXMatrix f = objective(x);
+      SXMatrix H = hessian(f,x);
+      t1 = ThreadPool::getWallTime();
+      cout << "n=" << n << ", nnz(H)=" << H.size() << endl;
+    }
+    t2 = ThreadPool::getWallTime();
+    cout << "  construction (f and hessian): " << setw(8) << t1-t0 << " s, destruction: " << setw(8) << t2-t1 
+         << " s, peak RSS: " << setw(8) << peakRSS() << " MB" << endl;
+  }
+  
+  return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "symbolic/sx/sx_tools.hpp"
+#include "symbolic/fx/sx_function.hpp"
+#include "symbolic/thread_pool.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+
+using namespace std;
+using namespace CasADi;
+
+/** Measures the numerical evaluation time of SXFunction with and without the compact algorithm,
+    dispatched with a switch or with the direct-threaded interpreter.
+    Usage: sx_layout_benchmark [num_evaluations]
+*/
+
+// Van der Pol oscillator
+SXMatrix vdp(const SXMatrix& x, const SX& u){
+  SXMatrix xdot(2,1,0);
+  xdot[0] = x[1];
+  xdot[1] = (1-x[0]*x[0])*x[1] - x[0] + u;
+  return xdot;
+}
+
+// Van der Pol oscillator, integrated with a number of explicit RK4 steps
+SXFunction vdpRK4(int nsteps){
+  SXMatrix x = ssym("x",2);
+  SXMatrix u = ssym("u",nsteps);
+  SX h = 10.0/nsteps;
+  SXMatrix xk = x;
+  for(int k=0; k<nsteps; ++k){
+    SXMatrix k1 = vdp(xk,u.at(k));
+    SXMatrix k2 = vdp(xk + h/2*k1,u.at(k));
+    SXMatrix k3 = vdp(xk + h/2*k2,u.at(k));
+    SXMatrix k4 = vdp(xk + h*k3,u.at(k));
+    xk += h/6*(k1 + 2*k2 + 2*k3 + k4);
+  }
+  vector<SXMatrix> arg(2);
+  arg[0] = x;
+  arg[1] = u;
+  return SXFunction(arg,xk);
+}
+
+// Hessian of a chained Rosenbrock function
+SXFunction rosenbrockHessian(int n){
+  SXMatrix x = ssym("x",n);
+  SX f = 0;
+  for(int i=0; i<n-1; ++i){
+    SX a = x.at(i+1) - x.at(i)*x.at(i);
+    SX b = 1 - x.at(i);
+    f += 100*a*a + b*b;
+  }
+  return SXFunction(x,hessian(f,x));
+}
+
+// Evaluate a function repeatedly, returning the time per evaluation and a checksum of the outputs
+void timeEvaluation(SXFunction f, bool compact, bool threaded, int neval, double& t, double& checksum){
+  f.setOption("compact_algorithm",compact);
+  f.setOption("threaded_interpreter",threaded);
+  f.init();
+  for(int ind=0; ind<f.getNumInputs(); ++ind){
+    vector<double>& v = f.input(ind).data();
+    for(int k=0; k<v.size(); ++k) v[k] = 0.1 + 0.01*k;
+  }
+  double t0 = ThreadPool::getWallTime();
+  for(int r=0; r<neval; ++r) f.evaluate();
+  t = (ThreadPool::getWallTime()-t0)/neval;
+  checksum = 0;
+  for(int ind=0; ind<f.getNumOutputs(); ++ind){
+    const vector<double>& v = f.output(ind).data();
+    for(int k=0; k<v.size(); ++k) checksum += v[k];
+  }
+}
+
+void benchmark(const string& name, SXFunction f, int neval){
+  double t_old, t_new, t_thr, c_old, c_new, c_thr;
+  timeEvaluation(f,false,false,neval,t_old,c_old);
+  timeEvaluation(f,true,false,neval,t_new,c_new);
+  timeEvaluation(f,true,true,neval,t_thr,c_thr);
+  cout << setw(20) << name << ": " << setw(8) << f.getAlgorithmSize() << " operations, reference " << setw(10) << t_old*1e6 
+       << " us, compact " << setw(10) << t_new*1e6 << " us, threaded " << setw(10) << t_thr*1e6 << " us, speedup " 
+       << setw(6) << t_old/t_thr << (c_old==c_new && c_old==c_thr ? "" : ", RESULTS DIFFER") << endl;
+}
+
+// Linearized subsystem: dense constant matrix times the state, followed by a nonlinearity
+SXFunction linearMap(int n){
+  SXMatrix x = ssym("x",n);
+  DMatrix A(n,n,0);
+  for(int k=0; k<A.size(); ++k) A.data()[k] = cos(0.1*k);
+  return SXFunction(x,sin(mul(SXMatrix(A),x)));
+}
+
+int main(int argc, char* argv[]){
+  int neval = argc>1 ? atoi(argv[1]) : 1000;
+  benchmark("vdp rk4 (100)",vdpRK4(100),neval);
+  benchmark("vdp rk4 (5000)",vdpRK4(5000),neval/10);
+  benchmark("rosenbrock hess (1000)",rosenbrockHessian(1000),neval);
+  benchmark("rosenbrock hess (50000)",rosenbrockHessian(50000),neval/10);
+  benchmark("linear map (100)",linearMap(100),neval);
+  benchmark("linear map (500)",linearMap(500),neval/10);
+  return 0;
+}
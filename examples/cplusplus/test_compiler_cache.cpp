@@ -0,0 +1,165 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/** 
+ *  Test of the on-disk cache of compiled generated code: cache hits, misses and
+ *  eviction of the least recently used entries.
+ */
+
+#include "symbolic/casadi.hpp"
+#include "symbolic/fx/compiler_cache.hpp"
+#include "symbolic/thread_pool.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace CasADi;
+using namespace std;
+
+// Does a file exist
+bool exists(const string& fname){
+  ifstream f(fname.c_str());
+  return f.good();
+}
+
+// Number of temporary files left in the cache directory
+int numTemporary(const string& dir){
+  int n = 0;
+  DIR* d = opendir(dir.c_str());
+  if(d==0) return 0;
+  for(struct dirent* e = readdir(d); e!=0; e = readdir(d)){
+    if(string(e->d_name).compare(0,4,"tmp_")==0) n++;
+  }
+  closedir(d);
+  return n;
+}
+
+// Does compiling fail
+bool fails(const string& code, const string& compiler){
+  try{
+    CompilerCache::compile(code,compiler);
+  } catch(exception& e){
+    return true;
+  }
+  return false;
+}
+
+// Concurrent requests for the same entry
+void compileTask(void* user_data, int task, int thread){
+  CompilerCache::compile(*static_cast<string*>(user_data),"gcc -fPIC -O0");
+}
+
+int main(){
+  // Use a private cache directory
+  char dir_buf[] = "/tmp/casadi_cache_test_XXXXXX";
+  casadi_assert(mkdtemp(dir_buf)!=0);
+  string dir = dir_buf;
+  CasadiOptions::setCodegenCacheDir(dir);
+  CasadiOptions::setCodegenCacheMaxSize(0);
+  CompilerCache::clear();
+  CompilerCache::resetStats();
+
+  string compiler = "gcc -fPIC -O0";
+  string code_a = "double a(double x){ return x+1;}\n";
+  string code_b = "double b(double x){ return x+2;}\n";
+  string code_c = "double c(double x){ return x+3;}\n";
+
+  // First request is a miss, the second a hit
+  string dl_a = CompilerCache::compile(code_a,compiler);
+  casadi_assert(CompilerCache::getNumMisses()==1 && CompilerCache::getNumHits()==0);
+  casadi_assert(exists(dl_a));
+  casadi_assert(CompilerCache::compile(code_a,compiler)==dl_a);
+  casadi_assert(CompilerCache::getNumMisses()==1 && CompilerCache::getNumHits()==1);
+  
+  // Different code or a different compiler command gives a different entry
+  string dl_b = CompilerCache::compile(code_b,compiler);
+  casadi_assert(dl_b!=dl_a);
+  casadi_assert(CompilerCache::compile(code_a,compiler + " -g")!=dl_a);
+  casadi_assert(CompilerCache::getNumMisses()==3 && CompilerCache::getNumHits()==1);
+  casadi_assert(CompilerCache::getNumEvictions()==0);
+  casadi_assert(numTemporary(dir)==0);
+  cout << "hits and misses ok" << endl;
+
+  // A tiny size limit evicts everything except the entry just compiled
+  CasadiOptions::setCodegenCacheMaxSize(1);
+  string dl_c = CompilerCache::compile(code_c,compiler);
+  casadi_assert(CompilerCache::getNumEvictions()==3);
+  casadi_assert(exists(dl_c));
+  casadi_assert(!exists(dl_a) && !exists(dl_b));
+
+  // An evicted entry must be compiled again
+  CompilerCache::resetStats();
+  casadi_assert(CompilerCache::compile(code_a,compiler)==dl_a);
+  casadi_assert(CompilerCache::getNumMisses()==1 && CompilerCache::getNumHits()==0);
+  casadi_assert(CompilerCache::getNumEvictions()==1);
+  casadi_assert(exists(dl_a) && !exists(dl_c));
+  cout << "eviction ok" << endl;
+
+  // Identical functions that are natively just-in-time compiled share the entry
+  CasadiOptions::setCodegenCacheMaxSize(0);
+  CompilerCache::resetStats();
+  SXMatrix x = ssym("x",2);
+  for(int k=0; k<2; ++k){
+    SXFunction f(x,sin(x)*x);
+    f.setOption("just_in_time_native",true);
+    f.init();
+  }
+  casadi_assert(CompilerCache::getNumMisses()==1 && CompilerCache::getNumHits()==1);
+  cout << "just-in-time compilation ok" << endl;
+
+  // Every concurrent request is counted once
+  CompilerCache::resetStats();
+  string code_d = "double d(double x){ return x+4;}\n";
+  ThreadPool pool(4);
+  pool.run(compileTask,&code_d,16);
+  casadi_assert(CompilerCache::getNumMisses()>=1);
+  casadi_assert(CompilerCache::getNumMisses()+CompilerCache::getNumHits()==16);
+  casadi_assert(numTemporary(dir)==0);
+  cout << "concurrent requests ok" << endl;
+  
+  // A failed compilation leaves no temporary files
+  casadi_assert(fails("this is not C code\n",compiler));
+  casadi_assert(numTemporary(dir)==0);
+  cout << "failed compilation ok" << endl;
+
+  // Directories that other users could place libraries in are rejected
+  chmod(dir.c_str(),0777);
+  casadi_assert(fails(code_a,compiler));
+  chmod(dir.c_str(),0700);
+  casadi_assert(!fails(code_a,compiler));
+  string link = dir + "_link";
+  casadi_assert(symlink(dir.c_str(),link.c_str())==0);
+  CasadiOptions::setCodegenCacheDir(link);
+  casadi_assert(fails(code_a,compiler));
+  remove(link.c_str());
+  CasadiOptions::setCodegenCacheDir(dir);
+  cout << "directory checks ok" << endl;
+
+  // Clean up
+  CompilerCache::clear();
+  casadi_assert(numTemporary(dir)==0);
+  remove(dir.c_str());
+  return 0;
+}
@@ -0,0 +1,163 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/** 
+ *  Test of FX::evaluateBatch: evaluating a function for a batch of input sets, serially and
+ *  in parallel, must give the same result as one evaluate() call per input set, also with
+ *  missing arguments or results and batch sizes that do not divide into the groups and tasks.
+ */
+
+#include "symbolic/casadi.hpp"
+#include "symbolic/casadi_options.hpp"
+#include "symbolic/fx/c_function.hpp"
+#include "symbolic/thread_pool.hpp"
+#include <cmath>
+#include <limits>
+
+using namespace CasADi;
+using namespace std;
+
+// Test value for nonzero j of input i of evaluation k
+double testValue(int i, int j, int k){
+  return 0.05*k + 0.3*(i+1) + 0.7*sin(j+1.);
+}
+
+// Check a function for batches of n evaluations with all combinations of missing arguments and results
+void check(FX& f, int n, const string& name){
+  int n_in = f.getNumInputs(), n_out = f.getNumOutputs();
+  for(int a=0; a < (1<<n_in); ++a){
+    for(int r=0; r < (1<<n_out); ++r){
+      // Reference solution with one evaluate() call per evaluation
+      vector<vector<double> > ref(n_out);
+      for(int k=0; k<n; ++k){
+        for(int i=0; i<n_in; ++i){
+          for(int j=0; j<f.input(i).size(); ++j){
+            f.input(i).at(j) = (a>>i) & 1 ? 0 : testValue(i,j,k);
+          }
+        }
+        f.evaluate();
+        for(int i=0; i<n_out; ++i) ref[i].insert(ref[i].end(),f.output(i).begin(),f.output(i).end());
+      }
+      
+      // Arguments and results, stored one evaluation after another
+      vector<vector<double> > argv(n_in), resv(n_out);
+      vector<const double*> arg(n_in,0);
+      vector<double*> res(n_out,0);
+      for(int i=0; i<n_in; ++i){
+        for(int k=0; k<n; ++k){
+          for(int j=0; j<f.input(i).size(); ++j) argv[i].push_back(testValue(i,j,k));
+        }
+        if(!((a>>i) & 1)) arg[i] = getPtr(argv[i]);
+      }
+      
+      for(int parallel=0; parallel<2; ++parallel){
+        for(int i=0; i<n_out; ++i){
+          resv[i].assign(n*f.output(i).size(),numeric_limits<double>::quiet_NaN());
+          res[i] = (r>>i) & 1 ? 0 : getPtr(resv[i]);
+        }
+        f.evaluateBatch(n,getPtr(arg),getPtr(res),parallel);
+        
+        // Compare
+        double err = 0;
+        for(int i=0; i<n_out; ++i){
+          if(res[i]==0) continue;
+          for(int j=0; j<resv[i].size(); ++j){
+            double d = fabs(resv[i][j]-ref[i][j]);
+            err = d==d ? max(err,d) : numeric_limits<double>::infinity();
+          }
+        }
+        if(err>1e-12){
+          cout << name << ": difference " << err << " for " << n << " evaluations" << (parallel ? " in parallel" : "") 
+               << " with arguments " << a << " and results " << r << " missing" << endl;
+          casadi_assert(err<=1e-12);
+        }
+      }
+    }
+  }
+  cout << name << ": " << n << " evaluations ok" << endl;
+}
+
+// Check a function for batch sizes that are smaller than, equal to and not divisible by the groups and tasks
+void check(FX& f, const string& name){
+  int n[] = {0, 1, 5, 16, 37};
+  for(int k=0; k<sizeof(n)/sizeof(*n); ++k) check(f,n[k],name);
+}
+
+// Function implemented as plain code, evaluated by the generic implementation
+void cfcn(CFunction& f, int nfdir, int nadir, void* user_data){
+  const vector<double>& x = f.input(0).data();
+  vector<double>& y = f.output(0).data();
+  y[0] = x[0]*x[1] + sin(x[2]);
+  y[1] = x[0] - x[2]/3;
+}
+
+int main(){
+  // Use several threads, regardless of the number of processors
+  CasadiOptions::setNumThreads(4);
+  casadi_assert(ThreadPool::getInstance().getNumThreads()==4);
+  
+  // SXFunction
+  SXMatrix x = ssym("x",3), y = ssym("y",2,2);
+  vector<SXMatrix> f_in(2), f_out(2);
+  f_in[0] = x;
+  f_in[1] = y;
+  f_out[0] = sin(x)*y.at(0) + x.at(2)*x;
+  f_out[1] = mul(y,y) + cos(x.at(1));
+  SXFunction f(f_in,f_out);
+  f.init();
+  check(f,"SXFunction");
+  
+  // Generic implementation, not reentrant so that the evaluations are always serial
+  vector<CRSSparsity> c_in(1,sp_dense(3,1)), c_out(1,sp_dense(2,1));
+  CFunction c(cfcn,c_in,c_out);
+  c.init();
+  casadi_assert(!c.isReentrant());
+  check(c,"CFunction");
+
+  // MXFunction with sparse and dense multiplications, calls to f and to the non-reentrant c
+  MX X = msym("X",3), Y = msym("Y",2,2), A = msym("A",sp_tril(3));
+  vector<MX> arg1(2);
+  arg1[0] = 2*X;
+  arg1[1] = Y;
+  vector<MX> g_in(3), g_out(3);
+  g_in[0] = X;
+  g_in[1] = Y;
+  g_in[2] = A;
+  g_out[0] = f.call(arg1)[0] + mul(A,X);
+  g_out[1] = mul(Y,Y) + mul(trans(A),A,sp_diag(3))(range(2),range(2));
+  g_out[2] = c.call(vector<MX>(1,X))[0];
+  MXFunction g(g_in,g_out);
+  g.init();
+  check(g,"MXFunction");
+  
+  // MXFunction with only multiplications, reentrant so that the parallel evaluation is used
+  vector<MX> h_out(3);
+  h_out[0] = mul(A,X);
+  h_out[1] = mul(A,trans(A),sp_tril(3));
+  h_out[2] = mul(Y,trans(Y));
+  MXFunction h(g_in,h_out);
+  h.init();
+  casadi_assert(h.isReentrant());
+  check(h,"Multiplication");
+  
+  return 0;
+}
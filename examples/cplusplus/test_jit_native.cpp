@@ -0,0 +1,85 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/** 
+ *  Test of the native just-in-time compilation of SXFunction: the compiled function
+ *  must give the same outputs and directional derivatives as the interpreter.
+ */
+
+#include "symbolic/casadi.hpp"
+#include <cmath>
+
+using namespace CasADi;
+using namespace std;
+
+int main(){
+  // A function with a sparse output and a mix of operations
+  SXMatrix x = ssym("x",3);
+  SXMatrix y = ssym("y",2);
+  SXMatrix f = SXMatrix::sparse(4,1);
+  f(0) = sin(x.at(0))*y.at(1) + x.at(2)/y.at(0);
+  f(2) = exp(-x.at(1)*x.at(1)) + sqrt(y.at(0)*y.at(0) + 1);
+  f(3) = fmax(x.at(0),y.at(1)) - 2*x.at(2);
+  vector<SXMatrix> in(2);
+  in[0] = x;
+  in[1] = y;
+
+  // Interpreted and compiled versions
+  SXFunction F_int(in,f), F_jit(in,f);
+  F_jit.setOption("just_in_time_native",true);
+  SXFunction* F[] = {&F_int, &F_jit};
+  for(int k=0; k<2; ++k){
+    F[k]->setOption("number_of_fwd_dir",1);
+    F[k]->setOption("number_of_adj_dir",1);
+    F[k]->init();
+  }
+
+  // Evaluate both, nondifferentiated and with one forward and one adjoint direction
+  double x0[] = {0.3, -1.2, 2.5}, y0[] = {1.7, 0.4};
+  double xs[] = {1, 0.5, -2}, ys[] = {0.1, 3};
+  double fs[] = {1, 2, -1};
+  for(int nd=0; nd<2; ++nd){
+    for(int k=0; k<2; ++k){
+      F[k]->setInput(x0,0);
+      F[k]->setInput(y0,1);
+      F[k]->setFwdSeed(xs,0);
+      F[k]->setFwdSeed(ys,1);
+      F[k]->setAdjSeed(fs);
+      F[k]->evaluate(nd,nd);
+    }
+
+    // Compare
+    double err = 0;
+    for(int i=0; i<F_int.output().size(); ++i){
+      err = max(err,fabs(F_int.output().at(i)-F_jit.output().at(i)));
+      if(nd) err = max(err,fabs(F_int.fwdSens().at(i)-F_jit.fwdSens().at(i)));
+    }
+    for(int j=0; j<2 && nd; ++j){
+      for(int i=0; i<F_int.adjSens(j).size(); ++i){
+        err = max(err,fabs(F_int.adjSens(j).at(i)-F_jit.adjSens(j).at(i)));
+      }
+    }
+    cout << "number of directions " << nd << ": difference between interpreted and compiled " << err << endl;
+    casadi_assert(err<1e-12);
+  }
+  return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/** 
+ *  Test of CasadiOptions::debug_option_access: reading an option while a function is being
+ *  evaluated must give a warning, reading it in init() must not. The integrators read their
+ *  options (print_stats, calc_ic, calc_icB, the initial guess of the startup integrator, ...)
+ *  in init() and must evaluate without warnings.
+ */
+
+#include "symbolic/casadi.hpp"
+#include "symbolic/casadi_options.hpp"
+#include "symbolic/fx/c_function.hpp"
+#include "interfaces/sundials/cvodes_integrator.hpp"
+#include "interfaces/sundials/idas_integrator.hpp"
+#include "interfaces/sundials/kinsol_solver.hpp"
+#include "interfaces/csparse/csparse.hpp"
+#include "integration/collocation_integrator.hpp"
+#include <sstream>
+
+using namespace CasADi;
+using namespace std;
+
+// Warning printed for an option lookup during evaluation
+const string warning = "looked up during evaluation";
+
+// Function that looks up an option each time it is evaluated
+void cfcn(CFunction& f, int nfdir, int nadir, void* user_data){
+  bool verbose = f.getOption("verbose");
+  f.output(0).set((verbose ? 3 : 2)*f.input(0).at(0));
+}
+
+// Capture everything written to cerr and cout between construction and str()
+class Capture{
+  public:
+    Capture() : cerr_buf_(cerr.rdbuf(ss_.rdbuf())), cout_buf_(cout.rdbuf(out_.rdbuf())){}
+    ~Capture(){ restore();}
+    void restore(){
+      if(cerr_buf_) cerr.rdbuf(cerr_buf_);
+      if(cout_buf_) cout.rdbuf(cout_buf_);
+      cerr_buf_ = cout_buf_ = 0;
+    }
+    string str() const{ return ss_.str();}
+  private:
+    stringstream ss_, out_;
+    streambuf *cerr_buf_, *cout_buf_;
+};
+
+// Number of warnings in a string
+int countWarnings(const string& s){
+  int n=0;
+  for(size_t pos=s.find(warning); pos!=string::npos; pos=s.find(warning,pos+1)) n++;
+  return n;
+}
+
+// Initialize and evaluate an integrator, no option may be looked up during evaluation
+void checkIntegrator(Integrator I, const string& name, bool with_sens=true){
+  I.setOption("tf",1.0);
+  I.setOption("print_stats",true);
+  Capture c;
+  I.init();
+  I.setInput(1.0,"x0");
+  I.setInput(0.5,"p");
+  I.evaluate();
+
+  // Forward and adjoint sensitivities
+  if(with_sens){
+    I.setFwdSeed(1.0,"x0");
+    I.setAdjSeed(1.0,"xf");
+    I.evaluate(1,1);
+  }
+  c.restore();
+  int n = countWarnings(c.str());
+  cout << name << ": " << n << " warnings" << endl;
+  if(n!=0) cerr << c.str();
+  casadi_assert_message(n==0,name << ": option looked up during evaluation");
+}
+
+int main(){
+  CasadiOptions::setDebugOptionAccess(true);
+
+  // Lookup in the evaluation gives a warning for each evaluation
+  vector<CRSSparsity> c_in(1,sp_dense(1,1)), c_out(1,sp_dense(1,1));
+  CFunction f(cfcn,c_in,c_out);
+  f.setOption("name","lookup_function");
+  {
+    Capture c;
+    f.init();
+    bool verbose = f.getOption("verbose");
+    casadi_assert(!verbose);
+    c.restore();
+    casadi_assert_message(countWarnings(c.str())==0,"Warning for an option lookup outside evaluation");
+  }
+  {
+    Capture c;
+    f.setInput(3.0);
+    f.evaluate();
+    f.evaluate();
+    c.restore();
+    casadi_assert(f.output().at(0)==6.0);
+    cout << "CFunction: " << countWarnings(c.str()) << " warnings" << endl;
+    casadi_assert_message(countWarnings(c.str())==2,"Missing warning for an option lookup during evaluation");
+    casadi_assert(c.str().find("\"verbose\" of \"lookup_function\"")!=string::npos);
+  }
+
+  // No warning without the option
+  CasadiOptions::setDebugOptionAccess(false);
+  {
+    Capture c;
+    f.evaluate();
+    c.restore();
+    casadi_assert_message(countWarnings(c.str())==0,"Warning without debug_option_access");
+  }
+  CasadiOptions::setDebugOptionAccess(true);
+
+  // SXFunction
+  SXMatrix x = ssym("x"), z = ssym("z"), p = ssym("p");
+  SXFunction g(x,sin(x)*x);
+  {
+    Capture c;
+    g.init();
+    g.setInput(1.0);
+    g.evaluate();
+    c.restore();
+    casadi_assert_message(countWarnings(c.str())==0,"SXFunction: option looked up during evaluation");
+  }
+
+  // CVodes, reads print_stats in init()
+  SXFunction ode(daeIn("x",x,"p",p),daeOut("ode",-p*x,"quad",x*x));
+  checkIntegrator(CVodesIntegrator(ode),"CVodesIntegrator");
+
+  // IDAS, reads print_stats, calc_ic and calc_icB in init()
+  SXFunction dae(daeIn("x",x,"z",z,"p",p),daeOut("ode",-z,"alg",z-p*x,"quad",x*x));
+  IdasIntegrator I(dae);
+  I.setOption("calc_ic",true);
+  I.setOption("calc_icB",true);
+  checkIntegrator(I,"IdasIntegrator");
+
+  // Collocation, reads the initial guess for the algebraic variables of the startup integrator in init()
+  CollocationIntegrator C(dae);
+  C.setOption("implicit_solver",KinsolSolver::creator);
+  Dictionary kinsol_options;
+  kinsol_options["linear_solver"] = CSparse::creator;
+  C.setOption("implicit_solver_options",kinsol_options);
+  C.setOption("startup_integrator",IdasIntegrator::creator);
+  Dictionary startup_options;
+  startup_options["init_z"] = vector<double>(1,0.5);
+  C.setOption("startup_integrator_options",startup_options);
+  checkIntegrator(C,"CollocationIntegrator",false);
+
+  return 0;
+}
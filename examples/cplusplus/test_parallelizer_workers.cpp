@@ -0,0 +1,106 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/** 
+ *  Test of the Parallelizer with worker processes: a worker that dies must result in an error
+ *  in the parent, which must be able to continue, and the thread pool must work in the workers.
+ */
+
+#include "symbolic/casadi.hpp"
+#include "symbolic/fx/compiler_cache.hpp"
+#include "symbolic/fx/parallelizer.hpp"
+
+using namespace CasADi;
+using namespace std;
+
+// A scalar function that terminates the process for negative arguments
+const char* crashing_code = 
+  "#include <stdlib.h>\n"
+  "#include <unistd.h>\n"
+  "int s_io[] = {0,1};\n"
+  "int init(int *n_in, int *n_out){ *n_in = *n_out = 1; return 0;}\n"
+  "int getSparsity(int i, int *nrow, int *ncol, int **rowind, int **col){\n"
+  "  *nrow = *ncol = 1; *rowind = s_io; *col = s_io; return 0;}\n"
+  "int evaluateWrap(const double** x, double** r){\n"
+  "  if(x[0][0]==-1) _exit(3);\n"
+  "  if(x[0][0]==-2) abort();\n"
+  "  r[0][0] = 2*x[0][0]; return 0;}\n";
+
+// Evaluate with given arguments, returns false if an error was raised
+bool evaluate(FX& p, double x0, double x1){
+  p.setInput(x0,0);
+  p.setInput(x1,1);
+  try{
+    p.evaluate();
+  } catch(exception& ex){
+    cout << "error raised: " << ex.what() << endl;
+    return false;
+  }
+  casadi_assert(p.output(0).at(0)==2*x0 && p.output(1).at(0)==2*x1);
+  return true;
+}
+
+int main(){
+  // Make sure that the thread pool has several threads
+  CasadiOptions::setNumThreads(4);
+
+  // Two instances of the crashing function in worker processes
+  ExternalFunction f(CompilerCache::compile(crashing_code,"gcc -fPIC -O2"));
+  vector<FX> f2(2,f);
+  Parallelizer p(f2);
+  p.setOption("parallelization","mpi");
+  p.setOption("num_workers",2);
+  p.init();
+  casadi_assert(evaluate(p,1,2));
+  
+  // A worker exits or is killed by a signal, the parent must get an error and continue with new workers
+  casadi_assert(!evaluate(p,3,-1));
+  casadi_assert(evaluate(p,4,5));
+  casadi_assert(!evaluate(p,-2,6));
+  casadi_assert(evaluate(p,7,8));
+  cout << "crashing workers ok" << endl;
+  
+  // A function using the thread pool, which is started in the parent before the workers are forked
+  SXMatrix x = ssym("x");
+  SXFunction g(x,2*x);
+  g.init();
+  Parallelizer q(vector<FX>(2,g));
+  q.setOption("parallelization","threads");
+  q.init();
+  casadi_assert(evaluate(q,1,2));
+  vector<FX> q2(2,q);
+  Parallelizer pq(q2);
+  pq.setOption("parallelization","mpi");
+  pq.setOption("num_workers",2);
+  pq.init();
+  for(int k=0; k<4; ++k){
+    pq.setInput(k,0);
+    pq.setInput(k+1,1);
+    pq.setInput(k+2,2);
+    pq.setInput(k+3,3);
+    pq.evaluate();
+    for(int i=0; i<4; ++i) casadi_assert(pq.output(i).at(0)==2*(k+i));
+  }
+  cout << "thread pool in workers ok" << endl;
+  
+  return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/** 
+ *  Test of FX::evaluate(arg,res,iw,w): evaluation with memory owned by the caller must give
+ *  the same result as evaluate(), also with missing arguments or results and when the same
+ *  function object is evaluated concurrently.
+ */
+
+#include "symbolic/casadi.hpp"
+#include "symbolic/casadi_options.hpp"
+#include "symbolic/thread_pool.hpp"
+#include "symbolic/fx/compiler_cache.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <limits>
+
+using namespace CasADi;
+using namespace std;
+
+// Test values for the nonzeros of input i, shifted by k
+vector<double> testValues(const FX& f, int i, int k){
+  vector<double> v(f.input(i).size());
+  for(int j=0; j<v.size(); ++j) v[j] = 0.1*k + 0.3*(i+1) + 0.7*sin(j+1.);
+  return v;
+}
+
+// Reference solution with evaluate()
+vector<vector<double> > reference(FX& f, int k, const vector<bool>& arg_null){
+  for(int i=0; i<f.getNumInputs(); ++i){
+    if(arg_null[i]){
+      f.input(i).setZero();
+    } else {
+      f.setInput(testValues(f,i,k),i);
+    }
+  }
+  f.evaluate();
+  vector<vector<double> > ret(f.getNumOutputs());
+  for(int i=0; i<ret.size(); ++i) ret[i] = f.output(i).data();
+  return ret;
+}
+
+// Evaluate with caller-owned memory, return the largest difference to evaluate()
+double compare(FX& f, int k, const vector<bool>& arg_null, const vector<bool>& res_null){
+  vector<vector<double> > ref = reference(f,k,arg_null);
+  
+  // Arguments and results
+  vector<vector<double> > argv(f.getNumInputs()), resv(f.getNumOutputs());
+  vector<const double*> arg(argv.size(),0);
+  vector<double*> res(resv.size(),0);
+  for(int i=0; i<argv.size(); ++i){
+    argv[i] = testValues(f,i,k);
+    if(!arg_null[i]) arg[i] = getPtr(argv[i]);
+  }
+  for(int i=0; i<resv.size(); ++i){
+    resv[i].resize(f.output(i).size(),numeric_limits<double>::quiet_NaN());
+    if(!res_null[i]) res[i] = getPtr(resv[i]);
+  }
+  
+  // Work vectors
+  size_t ni, nr;
+  f.nWork(ni,nr);
+  vector<int> iw(ni);
+  vector<double> w(nr);
+  f.evaluate(getPtr(arg),getPtr(res),getPtr(iw),getPtr(w));
+
+  // Compare
+  double err = 0;
+  for(int i=0; i<resv.size(); ++i){
+    if(res_null[i]) continue;
+    for(int j=0; j<resv[i].size(); ++j){
+      double d = fabs(resv[i][j]-ref[i][j]);
+      err = d==d ? max(err,d) : numeric_limits<double>::infinity();
+    }
+  }
+  return err;
+}
+
+// Check a function for all combinations of missing arguments and results
+void check(FX& f, const string& name){
+  int n_in = f.getNumInputs(), n_out = f.getNumOutputs();
+  for(int a=0; a < (1<<n_in); ++a){
+    for(int r=0; r < (1<<n_out); ++r){
+      vector<bool> arg_null(n_in), res_null(n_out);
+      for(int i=0; i<n_in; ++i) arg_null[i] = (a>>i) & 1;
+      for(int i=0; i<n_out; ++i) res_null[i] = (r>>i) & 1;
+      double err = compare(f,a+r,arg_null,res_null);
+      if(err>1e-12){
+        cout << name << ": difference " << err << " with arguments " << arg_null << " and results " << res_null << " missing" << endl;
+        casadi_assert(err<=1e-12);
+      }
+    }
+  }
+  cout << name << ": ok" << endl;
+}
+
+// Concurrent evaluation of the same function object
+struct ConcurrentData{
+  FX f;
+  vector<vector<vector<double> > > ref;
+  vector<double> err;
+};
+
+void concurrentTask(void* user_data, int task, int thread){
+  ConcurrentData* d = static_cast<ConcurrentData*>(user_data);
+  FX& f = d->f;
+  vector<vector<double> > argv(f.getNumInputs()), resv(f.getNumOutputs());
+  vector<const double*> arg(argv.size());
+  vector<double*> res(resv.size());
+  for(int i=0; i<argv.size(); ++i){
+    argv[i] = testValues(f,i,task);
+    arg[i] = getPtr(argv[i]);
+  }
+  for(int i=0; i<resv.size(); ++i){
+    resv[i].resize(f.output(i).size());
+    res[i] = getPtr(resv[i]);
+  }
+  size_t ni, nr;
+  f.nWork(ni,nr);
+  vector<int> iw(ni);
+  vector<double> w(nr);
+  for(int rep=0; rep<50; ++rep){
+    f.evaluate(getPtr(arg),getPtr(res),getPtr(iw),getPtr(w));
+    for(int i=0; i<resv.size(); ++i){
+      for(int j=0; j<resv[i].size(); ++j){
+        d->err[task] = max(d->err[task],fabs(resv[i][j]-d->ref[task][i][j]));
+      }
+    }
+  }
+}
+
+void checkConcurrent(FX& f, const string& name){
+  casadi_assert(f.isReentrant());
+  int ntask = 16;
+  ConcurrentData d;
+  d.f = f;
+  d.err.resize(ntask,0);
+  for(int k=0; k<ntask; ++k) d.ref.push_back(reference(f,k,vector<bool>(f.getNumInputs(),false)));
+  ThreadPool pool(4);
+  pool.run(concurrentTask,&d,ntask);
+  double err = *max_element(d.err.begin(),d.err.end());
+  cout << name << ": concurrent evaluation difference " << err << endl;
+  casadi_assert(err<=1e-12);
+}
+
+int main(){
+  // SXFunction
+  SXMatrix x = ssym("x",3), y = ssym("y",2,2);
+  vector<SXMatrix> f_in(2), f_out(2);
+  f_in[0] = x;
+  f_in[1] = y;
+  f_out[0] = sin(x)*y.at(0) + x.at(2)*x;
+  f_out[1] = mul(y,y) + cos(x.at(1));
+  SXFunction f(f_in,f_out);
+  f.init();
+  check(f,"SXFunction");
+  checkConcurrent(f,"SXFunction");
+
+  // MXFunction with calls to f, one with an argument whose sparsity differs from the input of f
+  MX X = msym("X",3), Y = msym("Y",2,2), Z = msym("Z",sp_diag(2));
+  vector<MX> arg1(2), arg2(2);
+  arg1[0] = 2*X;
+  arg1[1] = Y;
+  arg2[0] = X;
+  arg2[1] = Z;
+  vector<MX> g_in(3), g_out(3);
+  g_in[0] = X;
+  g_in[1] = Y;
+  g_in[2] = Z;
+  g_out[0] = f.call(arg1)[0] + sin(X);
+  g_out[1] = f.call(arg2)[1]*trans(Y);
+  g_out[2] = X(vector<int>(2,1)) - 1;
+  MXFunction g(g_in,g_out);
+  g.init();
+  check(g,"MXFunction");
+  checkConcurrent(g,"MXFunction");
+
+  // The functions are registered in a new profiling session by the concurrent evaluations
+  CasadiOptions::startProfiling("test_reentrant_evaluate_profile.json");
+  checkConcurrent(g,"MXFunction with profiling");
+  CasadiOptions::stopProfiling();
+  remove("test_reentrant_evaluate_profile.json");
+
+#ifdef WITH_DL
+  // ExternalFunction generated from f
+  string cname = "test_reentrant_evaluate_gen.c";
+  f.generateCode(cname);
+  ifstream cfile(cname.c_str());
+  stringstream code;
+  code << cfile.rdbuf();
+  cfile.close();
+  remove(cname.c_str());
+  ExternalFunction h(CompilerCache::compile(code.str(),"gcc -fPIC -O2"));
+  h.init();
+  check(h,"ExternalFunction");
+  checkConcurrent(h,"ExternalFunction");
+#endif // WITH_DL
+  
+  return 0;
+}
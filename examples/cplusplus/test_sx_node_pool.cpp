@@ -0,0 +1,115 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/** 
+ *  Test of the pools from which the nodes of SX expression graphs are allocated: the blocks must be
+ *  reused by later graphs, and the chunks released when the last node of the process is destroyed.
+ */
+
+#include "symbolic/casadi.hpp"
+#include "symbolic/sx/binary_sx.hpp"
+#include "symbolic/sx/unary_sx.hpp"
+
+using namespace CasADi;
+using namespace std;
+
+typedef SXNodePool<BinarySX> BinaryPool;
+typedef SXNodePool<UnarySX> UnaryPool;
+
+// Build a graph much larger than one chunk
+SX buildGraph(const SXMatrix& x, int n){
+  SX e = x.at(0);
+  for(int k=0; k<n; ++k){
+    e = sin(e)*x.at(0) + (k+1);
+  }
+  return e;
+}
+
+void printPools(const string& when){
+  cout << when << ": " << BinaryPool::getNumUsed() << " binary nodes in " << BinaryPool::getNumChunks() << " chunks, " 
+       << UnaryPool::getNumUsed() << " unary nodes in " << UnaryPool::getNumChunks() << " chunks" << endl;
+}
+
+int main(){
+  // Nodes in use before the test, e.g. by static objects, only changes relative to these are checked
+  size_t binary_used0 = BinaryPool::getNumUsed(), unary_used0 = UnaryPool::getNumUsed();
+  size_t binary_chunks0 = BinaryPool::getNumChunks(), unary_chunks0 = UnaryPool::getNumChunks();
+  printPools("initially");
+  
+  // Build and destroy a graph several times
+  int n = 5*BinaryPool::chunk_blocks;
+  size_t binary_peak = 0, unary_peak = 0;
+  for(int rep=0; rep<3; ++rep){
+    {
+      SXMatrix x = ssym("x");
+      SX e = buildGraph(x,n);
+      printPools("built");
+      casadi_assert(BinaryPool::getNumUsed() >= binary_used0 + 2*n);
+      casadi_assert(UnaryPool::getNumUsed() >= unary_used0 + n);
+      casadi_assert(BinaryPool::getNumChunks() >= binary_chunks0 + (2*n)/BinaryPool::chunk_blocks);
+      
+      // Rebuilding the same graph reuses the blocks of the previous one
+      if(rep==0){
+        binary_peak = BinaryPool::getNumChunks();
+        unary_peak = UnaryPool::getNumChunks();
+      } else {
+        casadi_assert(BinaryPool::getNumChunks()<=binary_peak);
+        casadi_assert(UnaryPool::getNumChunks()<=unary_peak);
+      }
+    }
+    
+    // All nodes are returned, and the chunks are released if and only if no nodes are in use
+    printPools("destroyed");
+    casadi_assert(BinaryPool::getNumUsed()==binary_used0);
+    casadi_assert(UnaryPool::getNumUsed()==unary_used0);
+    casadi_assert(BinaryPool::getNumChunks()==(binary_used0==0 ? 0 : binary_peak));
+    casadi_assert(UnaryPool::getNumChunks()==(unary_used0==0 ? 0 : unary_peak));
+  }
+  
+  // A long-lived expression keeps all the chunks allocated after a large graph is destroyed
+  {
+    SXMatrix y = ssym("y");
+    SX keep = sin(y.at(0))*y.at(0);
+    size_t binary_used1 = BinaryPool::getNumUsed(), unary_used1 = UnaryPool::getNumUsed();
+    size_t binary_peak1, unary_peak1;
+    {
+      SXMatrix x = ssym("x");
+      SX e = buildGraph(x,n);
+      binary_peak1 = BinaryPool::getNumChunks();
+      unary_peak1 = UnaryPool::getNumChunks();
+    }
+    printPools("destroyed with a long-lived expression");
+    casadi_assert(BinaryPool::getNumUsed()==binary_used1);
+    casadi_assert(UnaryPool::getNumUsed()==unary_used1);
+    casadi_assert(BinaryPool::getNumChunks()==binary_peak1);
+    casadi_assert(UnaryPool::getNumChunks()==unary_peak1);
+  }
+  
+  // Released together with the last node
+  printPools("long-lived expression destroyed");
+  casadi_assert(BinaryPool::getNumUsed()==binary_used0);
+  casadi_assert(UnaryPool::getNumUsed()==unary_used0);
+  if(binary_used0==0) casadi_assert(BinaryPool::getNumChunks()==0);
+  if(unary_used0==0) casadi_assert(UnaryPool::getNumChunks()==0);
+  
+  return 0;
+}
@@ -28,7 +28,6 @@
 #include "symbolic/fx/sx_function.hpp"
 #include "symbolic/mx/mx_tools.hpp"
 
-#include "symbolic/profiling.hpp"
 #include "symbolic/casadi_options.hpp"
 
 using namespace std;
@@ -413,6 +412,13 @@ namespace CasADi{
     
       // Initialize the startup integrator
       startup_integrator_.init();
+
+      // Initial guess for the algebraic variables, if provided by the startup integrator
+      if(startup_integrator_.hasSetOption("init_z") && !startup_integrator_.getOption("init_z").isNull()){
+        startup_init_z_ = startup_integrator_.getOption("init_z").toDoubleVector();
+      } else {
+        startup_init_z_.clear();
+      }
     }
 
     // Mark the system not yet integrated
@@ -423,15 +429,6 @@ namespace CasADi{
   }
 
   void CollocationIntegratorInternal::reset(int nsens, int nsensB, int nsensB_store){
-    // Set up timers for profiling
-    double time_zero;
-    double time_start;
-    double time_stop;
-    if (CasadiOptions::profiling) {
-      time_zero = getRealTime();
-      CasadiOptions::profilingLog  << "start " << this << ":" <<getOption("name") << std::endl; 
-    }
-    
     // Call the base class method
     IntegratorInternal::reset(nsens,nsensB,nsensB_store);
   
@@ -482,10 +479,9 @@ namespace CasADi{
 
           // Skip algebraic variables (for now) // FIXME
           if(j>0){
-            if (has_startup_integrator && startup_integrator_.hasOption("init_z")) {
-              std::vector<double> init_z = startup_integrator_.getOption("init_z");
+            if (has_startup_integrator && !startup_init_z_.empty()) {
               for(int i=0; i<nz_; ++i){
-                v.at(offs++) = init_z.at(i);
+                v.at(offs++) = startup_init_z_.at(i);
               }
             } else {
               offs += nz_;
@@ -513,17 +509,14 @@ namespace CasADi{
 
     }
     
-    if (CasadiOptions::profiling) {
-      time_start = getRealTime(); // Start timer
-    }
-    
     // Solve the system of equations
-    explicit_fcn_.evaluate(nsens);
-    
-    // Write out profiling information
-    if (CasadiOptions::profiling) {
-      time_stop = getRealTime(); // Stop timer
-      CasadiOptions::profilingLog  << double(time_stop-time_start)*1e6 << " ns | " << double(time_stop-time_zero)*1e3 << " ms | " << this << ":" << getOption("name") << ":0|" << explicit_fcn_.get() << ":" << explicit_fcn_.getOption("name") << "|solve system" << std::endl;
+    if(CasadiOptions::profiling){
+      int profiling_id = profilingId();
+      Profiler::begin(profiling_id,0,nsens);
+      explicit_fcn_.evaluate(nsens);
+      Profiler::end(profiling_id,0,nsens);
+    } else {
+      explicit_fcn_.evaluate(nsens);
     }
   
     // Mark the system integrated at least once
@@ -545,4 +538,8 @@ namespace CasADi{
   void CollocationIntegratorInternal::integrateB(double t_out){
   }
 
+  std::vector<std::string> CollocationIntegratorInternal::getProfilingNodes() const{
+    return std::vector<std::string>(1,"solve system");
+  }
+
 } // namespace CasADi
@@ -68,8 +68,14 @@ public:
   /// Integrate backwards in time until a specified time point
   virtual void integrateB(double t_out);
 
+  /// Descriptions of the profiled sections
+  virtual std::vector<std::string> getProfilingNodes() const;
+
   // Startup integrator (generates an initial trajectory guess)
   Integrator startup_integrator_;
+
+  // Initial guess for the algebraic variables, taken from the startup integrator
+  std::vector<double> startup_init_z_;
   
   // Implicit function solver
   ImplicitFunction implicit_solver_;
@@ -27,6 +27,7 @@ using namespace std;
 namespace CasADi{
 
   CSparseInternal::CSparseInternal(const CRSSparsity& sparsity, int nrhs)  : LinearSolverInternal(sparsity,nrhs){
+    addOption("ordering", OT_STRING, "natural", "Fill-reducing ordering of the columns", "natural: no reordering|amd: approximate minimum degree ordering of A+A', for matrices with a nearly symmetric pattern|amd_ata: approximate minimum degree ordering of A'A with dense rows removed, for unsymmetric matrices");
     N_ = 0;
     S_ = 0;
   }
@@ -54,13 +55,127 @@ namespace CasADi{
     AT_.x = &input().front(); // row indices, size nzmax
     AT_.nz = -1; // of entries in triplet matrix, -1 for compressed-col 
 
-    // Temporary
-    temp_.resize(AT_.n);
+    // Temporary, holds a panel of right hand sides during the solve
+    temp_.resize(AT_.n*rhs_panel_);
   
+    // Fill-reducing ordering
+    if(getOption("ordering")=="natural"){
+      order_ = 0;
+    } else if(getOption("ordering")=="amd"){
+      order_ = 1;
+    } else if(getOption("ordering")=="amd_ata"){
+      order_ = 2;
+    } else {
+      casadi_error("CSparseInternal::init: Unknown ordering \"" << getOption("ordering") << "\"");
+    }
+
     // Has the routine been called once
     called_once_ = false;
+
+    // No factorization to reuse
+    if(N_) cs_nfree(N_);
+    N_ = 0;
   }
 
+  namespace{
+    /* Numeric LU factorization with the pattern and pivot sequence of an existing factorization N 
+       (as returned by cs_lu for the symbolic analysis S), overwriting the nonzeros of N. The L and U
+       entries of each column are stored in the order of the triangular solve in cs_lu, so they can be
+       processed in the same order. Returns false if a pivot has become too small compared to the 
+       other entries of its column, in which case a factorization with new pivoting is needed. */
+    bool cs_relu(const cs *A, const css *S, csn *N, double tol, double *x){
+      int n = A->n;
+      const int *q = S->q, *pinv = N->pinv;
+      const int *Ap = A->p, *Ai = A->i, *Lp = N->L->p, *Li = N->L->i, *Up = N->U->p, *Ui = N->U->i;
+      const double *Ax = A->x;
+      double *Lx = N->L->x, *Ux = N->U->x;
+      for(int i=0; i<n; ++i) x[i] = 0;
+      for(int k=0; k<n; ++k){
+        // Scatter the column of A, rows in pivot order
+        int col = q ? q[k] : k;
+        for(int p=Ap[col]; p<Ap[col+1]; ++p) x[pinv[Ai[p]]] = Ax[p];
+
+        // Eliminate with the previous columns of L, the last entry of U(:,k) is the pivot
+        for(int p=Up[k]; p<Up[k+1]-1; ++p){
+          int j = Ui[p];
+          double u = Ux[p] = x[j];
+          x[j] = 0;
+          for(int pl=Lp[j]+1; pl<Lp[j+1]; ++pl) x[Li[pl]] -= Lx[pl]*u;
+        }
+
+        // Check the pivot against the largest entry below it
+        double pivot = x[k], a = fabs(pivot);
+        x[k] = 0;
+        for(int p=Lp[k]+1; p<Lp[k+1]; ++p) a = std::max(a,fabs(x[Li[p]]));
+        bool ok = pivot!=0 && fabs(pivot) >= a*tol;
+
+        // Divide by pivot
+        Ux[Up[k+1]-1] = pivot;
+        for(int p=Lp[k]+1; p<Lp[k+1]; ++p){
+          Lx[p] = x[Li[p]]/pivot;
+          x[Li[p]] = 0;
+        }
+        if(!ok) return false;
+      }
+      return true;
+    }
+
+    /* The following are the triangular solves cs_lsolve, cs_usolve, cs_ltsolve and cs_utsolve for a panel 
+       of np right hand sides, stored interleaved: entry i of right hand side r is X[i*np+r]. The loops over 
+       the right hand sides are contiguous in memory and each nonzero of the factor is loaded only once. */
+    void cs_lsolve_panel(const cs *L, double *X, int np){
+      const int *Lp = L->p, *Li = L->i;
+      const double *Lx = L->x;
+      for(int j=0; j<L->n; ++j){
+        double *xj = X + j*np;
+        for(int r=0; r<np; ++r) xj[r] /= Lx[Lp[j]];
+        for(int p=Lp[j]+1; p<Lp[j+1]; ++p){
+          double *xi = X + Li[p]*np;
+          for(int r=0; r<np; ++r) xi[r] -= Lx[p]*xj[r];
+        }
+      }
+    }
+
+    void cs_usolve_panel(const cs *U, double *X, int np){
+      const int *Up = U->p, *Ui = U->i;
+      const double *Ux = U->x;
+      for(int j=U->n-1; j>=0; --j){
+        double *xj = X + j*np;
+        for(int r=0; r<np; ++r) xj[r] /= Ux[Up[j+1]-1];
+        for(int p=Up[j]; p<Up[j+1]-1; ++p){
+          double *xi = X + Ui[p]*np;
+          for(int r=0; r<np; ++r) xi[r] -= Ux[p]*xj[r];
+        }
+      }
+    }
+
+    void cs_ltsolve_panel(const cs *L, double *X, int np){
+      const int *Lp = L->p, *Li = L->i;
+      const double *Lx = L->x;
+      for(int j=L->n-1; j>=0; --j){
+        double *xj = X + j*np;
+        for(int p=Lp[j]+1; p<Lp[j+1]; ++p){
+          const double *xi = X + Li[p]*np;
+          for(int r=0; r<np; ++r) xj[r] -= Lx[p]*xi[r];
+        }
+        for(int r=0; r<np; ++r) xj[r] /= Lx[Lp[j]];
+      }
+    }
+
+    void cs_utsolve_panel(const cs *U, double *X, int np){
+      const int *Up = U->p, *Ui = U->i;
+      const double *Ux = U->x;
+      for(int j=0; j<U->n; ++j){
+        double *xj = X + j*np;
+        for(int p=Up[j]; p<Up[j+1]-1; ++p){
+          const double *xi = X + Ui[p]*np;
+          for(int r=0; r<np; ++r) xj[r] -= Ux[p]*xi[r];
+        }
+        for(int r=0; r<np; ++r) xj[r] /= Ux[Up[j+1]-1];
+      }
+    }
+  } // namespace
+
   void CSparseInternal::prepare(){
     if(!called_once_){
       if(verbose()){
@@ -68,11 +183,13 @@ namespace CasADi{
       }
         
       // ordering and symbolic analysis 
-      int order = 0; // ordering?
       if(S_) cs_sfree(S_);
-      S_ = cs_sqr (order, &AT_, 0) ;              
+      S_ = cs_sqr (order_, &AT_, 0) ;              
     }
   
+    // Nothing to do if the linear system has not changed since the last factorization
+    if(sameMatrix() && prepared_) return;
+
     prepared_ = false;
     called_once_ = true;
   
@@ -93,6 +210,15 @@ namespace CasADi{
 
     double tol = 1e-8;
   
+    // Reuse the pattern and pivot sequence of the last factorization, if the pivots are still acceptable
+    if(N_ && cs_relu(&AT_, S_, N_, tol, getPtr(temp_))){
+      if(verbose()){
+        cout << "CSparseInternal::prepare: refactorized with the previous pivot sequence" << endl;
+      }
+      prepared_ = true;
+      return;
+    }
+
     if(N_) cs_nfree(N_);
     N_ = cs_lu(&AT_, S_, tol) ;                 // numeric LU factorization 
     if(N_==0){
@@ -124,29 +250,43 @@ namespace CasADi{
   void CSparseInternal::solve(double* x, int nrhs, bool transpose){
     casadi_assert(prepared_);
     casadi_assert(N_!=0);
+    casadi_assert(N_->U!=0);
   
     double *t = &temp_.front();
+    int n = AT_.n;
+    const int *q = S_->q, *pinv = N_->pinv;
   
-    for(int k=0; k<nrhs; ++k){
+    // Process the right hand sides in panels
+    for(int r0=0; r0<nrhs; r0+=rhs_panel_){
+      int np = std::min(nrhs-r0, int(rhs_panel_));
       if(transpose){
-        cs_pvec (S_->q, x, t, AT_.n) ;       // t = P2*b 
-        casadi_assert(N_->U!=0);
-        cs_utsolve (N_->U, t) ;              // t = U'\t 
-        cs_ltsolve (N_->L, t) ;              // t = L'\t 
-        cs_pvec (N_->pinv, t, x, AT_.n) ;    // x = P1*t 
+        for(int k=0; k<n; ++k){                      // t = P2*b 
+          for(int r=0; r<np; ++r) t[k*np+r] = x[(q ? q[k] : k) + r*n];
+        }
+        cs_utsolve_panel(N_->U, t, np);              // t = U'\t 
+        cs_ltsolve_panel(N_->L, t, np);              // t = L'\t 
+        for(int k=0; k<n; ++k){                      // x = P1*t 
+          for(int r=0; r<np; ++r) x[k + r*n] = t[pinv[k]*np+r];
+        }
       } else {
-        cs_ipvec (N_->pinv, x, t, AT_.n) ;   // t = P1\b
-        cs_lsolve (N_->L, t) ;               // t = L\t 
-        cs_usolve (N_->U, t) ;               // t = U\t 
-        cs_ipvec (S_->q, t, x, AT_.n) ;      // x = P2\t 
+        for(int k=0; k<n; ++k){                      // t = P1\b
+          for(int r=0; r<np; ++r) t[pinv[k]*np+r] = x[k + r*n];
+        }
+        cs_lsolve_panel(N_->L, t, np);               // t = L\t 
+        cs_usolve_panel(N_->U, t, np);               // t = U\t 
+        for(int k=0; k<n; ++k){                      // x = P2\t 
+          for(int r=0; r<np; ++r) x[(q ? q[k] : k) + r*n] = t[k*np+r];
+        }
       }
-      x += nrow();
+      x += np*n;
     }
   }
 
 
   CSparseInternal* CSparseInternal::clone() const{
-    return new CSparseInternal(input(LINSOL_A).sparsity(),input(LINSOL_B).size1());
+    CSparseInternal* node = new CSparseInternal(input(LINSOL_A).sparsity(),input(LINSOL_B).size1());
+    node->setOption(dictionary());
+    return node;
   }
 
 } // namespace CasADi
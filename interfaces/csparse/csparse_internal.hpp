@@ -61,6 +61,9 @@ namespace CasADi{
     
     // Has the solve function been called once
     bool called_once_;
+
+    // Ordering passed to cs_sqr
+    int order_;
     
     // The tranpose of linear system in CSparse form (CCS)
     cs AT_;
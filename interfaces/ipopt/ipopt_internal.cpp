@@ -147,6 +147,7 @@ namespace CasADi{
     
     // Read user options
     exact_hessian_ = !hasSetOption("hessian_approximation") || getOption("hessian_approximation")=="exact";
+    print_time_ = getOption("print_time");
 #ifdef WITH_SIPOPT
     if(hasSetOption("run_sens")){
       run_sens_ = getOption("run_sens")=="yes";
@@ -160,9 +161,11 @@ namespace CasADi{
     }
 #endif // WITH_SIPOPT
 
-    // Get/generate required functions
-    gradF();
+    // Get/generate required functions, the objective gradient separately only if it cannot be fused with the constraint Jacobian
     jacG();
+    if(gradFJacG().isNull()){
+      gradF();
+    }
     if(exact_hessian_){
       hessLag();
     }
@@ -246,8 +249,12 @@ namespace CasADi{
     
     checkInitialBounds();
 
+    // The parameters may have changed since the last solve
+    clearEvalCache();
+
     // Reset the counters
     t_eval_f_ = t_eval_grad_f_ = t_eval_g_ = t_eval_jac_g_ = t_eval_h_ = t_callback_fun_ = t_callback_prepare_ = t_mainloop_ = 0;
+    n_call_f_ = n_call_grad_f_ = n_call_g_ = n_call_jac_g_ = 0;
   
     // Get back the smart pointers
     Ipopt::SmartPtr<Ipopt::TNLP> *userclass = static_cast<Ipopt::SmartPtr<Ipopt::TNLP>*>(userclass_);
@@ -284,7 +291,7 @@ namespace CasADi{
     }
 #endif // WITH_SIPOPT
   
-    if (hasOption("print_time") && bool(getOption("print_time"))) {
+    if (print_time_) {
       // Write timings
       cout << "time spent in eval_f: " << t_eval_f_ << " s." << endl;
       cout << "time spent in eval_grad_f: " << t_eval_grad_f_ << " s." << endl;
@@ -337,6 +344,14 @@ namespace CasADi{
     stats_["t_mainloop"] = t_mainloop_;
     stats_["t_callback_fun"] = t_callback_fun_;
     stats_["t_callback_prepare"] = t_callback_prepare_;
+    stats_["n_call_f"] = n_call_f_;
+    stats_["n_call_grad_f"] = n_call_grad_f_;
+    stats_["n_call_g"] = n_call_g_;
+    stats_["n_call_jac_g"] = n_call_jac_g_;
+    stats_["n_eval_fg"] = n_eval_fg_;
+    stats_["n_eval_grad_f"] = n_eval_grad_f_;
+    stats_["n_eval_jac_g"] = n_eval_jac_g_;
+    stats_["n_eval_grad_f_jac_g"] = n_eval_grad_f_jac_g_;
   
   }
 
@@ -378,7 +393,7 @@ namespace CasADi{
         return 1;
       }
     } catch (exception& ex){
-      if (getOption("iteration_callback_ignore_errors")) {
+      if (callback_ignore_errors_) {
         cerr << "intermediate_callback: " << ex.what() << endl;
       } else {
         throw ex;
@@ -482,22 +497,19 @@ namespace CasADi{
             nz++;
           }
       } else {
-        // Pass the argument to the function
-        jacG.setInput(x,NL_X);
-        jacG.setInput(input(NLP_SOLVER_P),NL_P);
-      
-        // Evaluate the function
-        jacG.evaluate();
+        // Evaluate, or reuse an evaluation at the same point
+        evalJacG(x);
+        n_call_jac_g_++;
 
         // Get the output
-        jacG.getOutput(values);
+        cache_jac_g_.get(values);
       
         if(monitored("eval_jac_g")){
-          cout << "x = " << jacG.input(NL_X).data() << endl;
+          cout << "x = " << cache_x_ << endl;
           cout << "J = " << endl;
-          jacG.output().printSparse();
+          cache_jac_g_.printSparse();
         }
-        if (regularity_check_ && !isRegular(jacG.output().data())) casadi_error("IpoptInternal::jac_g: NaN or Inf detected.");
+        if (regularity_check_ && !isRegular(cache_jac_g_.data())) casadi_error("IpoptInternal::jac_g: NaN or Inf detected.");
       }
     
       double time2 = clock();
@@ -520,23 +532,20 @@ namespace CasADi{
       double time1 = clock();
       casadi_assert(n == nx_);
 
-      // Pass the argument to the function
-      nlp_.setInput(x,NL_X);
-      nlp_.setInput(input(NLP_SOLVER_P),NL_P);
-      
-      // Evaluate the function
-      nlp_.evaluate();
+      // Evaluate, or reuse an evaluation at the same point
+      evalFG(x);
+      n_call_f_++;
 
       // Get the result
-      nlp_.getOutput(obj_value,NL_F);
+      cache_f_.get(obj_value);
 
       // Printing
       if(monitored("eval_f")){
-        cout << "x = " << nlp_.input(NL_X) << endl;
+        cout << "x = " << cache_x_ << endl;
         cout << "obj_value = " << obj_value << endl;
       }
 
-      if (regularity_check_ && !isRegular(nlp_.output(NL_F).data())) casadi_error("IpoptInternal::f: NaN or Inf detected.");
+      if (regularity_check_ && !isRegular(cache_f_.data())) casadi_error("IpoptInternal::f: NaN or Inf detected.");
     
       double time2 = clock();
       t_eval_f_ += double(time2-time1)/CLOCKS_PER_SEC;
@@ -557,24 +566,21 @@ namespace CasADi{
       double time1 = clock();
 
       if(m>0){
-        // Pass the argument to the function
-        nlp_.setInput(x,NL_X);
-        nlp_.setInput(input(NLP_SOLVER_P),NL_P);
-
-        // Evaluate the function and tape
-        nlp_.evaluate();
+        // Evaluate, or reuse an evaluation at the same point
+        evalFG(x);
+        n_call_g_++;
 
         // Ge the result
-        nlp_.getOutput(g,NL_G);
+        cache_g_.get(g);
 
         // Printing
         if(monitored("eval_g")){
-          cout << "x = " << nlp_.input(NL_X) << endl;
-          cout << "g = " << nlp_.output(NL_G) << endl;
+          cout << "x = " << cache_x_ << endl;
+          cout << "g = " << cache_g_ << endl;
         }
-      }
     
-      if (regularity_check_ && !isRegular(nlp_.output(NL_G).data())) casadi_error("IpoptInternal::g: NaN or Inf detected.");
+        if (regularity_check_ && !isRegular(cache_g_.data())) casadi_error("IpoptInternal::g: NaN or Inf detected.");
+      }
           
       double time2 = clock();
       t_eval_g_ += double(time2-time1)/CLOCKS_PER_SEC;
@@ -594,23 +600,20 @@ namespace CasADi{
       double time1 = clock();
       casadi_assert(n == nx_);
     
-      // Pass the argument to the function
-      gradF_.setInput(x,NL_X);
-      gradF_.setInput(input(NLP_SOLVER_P),NL_P);
-      
-      // Evaluate, adjoint mode
-      gradF_.evaluate();
+      // Evaluate, or reuse an evaluation at the same point
+      evalGradF(x);
+      n_call_grad_f_++;
       
       // Get the result
-      gradF_.output().getArray(grad_f,n,DENSE);
+      cache_grad_f_.getArray(grad_f,n,DENSE);
       
       // Printing
       if(monitored("eval_grad_f")){
-        cout << "x = " << gradF_.input(NL_X) << endl;
-        cout << "grad_f = " << gradF_.output() << endl;
+        cout << "x = " << cache_x_ << endl;
+        cout << "grad_f = " << cache_grad_f_ << endl;
       }
 
-      if (regularity_check_ && !isRegular(gradF_.output().data())) casadi_error("IpoptInternal::grad_f: NaN or Inf detected.");
+      if (regularity_check_ && !isRegular(cache_grad_f_.data())) casadi_error("IpoptInternal::grad_f: NaN or Inf detected.");
     
       double time2 = clock();
       t_eval_grad_f_ += double(time2-time1)/CLOCKS_PER_SEC;
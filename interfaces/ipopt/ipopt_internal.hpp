@@ -52,6 +52,9 @@ public:
 
   /// Exact Hessian?
   bool exact_hessian_;
+
+  /// Print information about execution time
+  bool print_time_;
     
   /** NOTE:
    * To allow this header file to be free of IPOPT types (that are sometimes declared outside their scope!) and after 
@@ -108,6 +111,9 @@ public:
   double t_callback_fun_;  // time spent in callback function
   double t_callback_prepare_; // time spent in callback preparation
   double t_mainloop_; // time spent in the main loop of the solver
+
+  // Number of calls since last reset, the evaluations can be shared between calls at the same point
+  int n_call_f_, n_call_grad_f_, n_call_g_, n_call_jac_g_;
   
   // For parametric sensitivities with sIPOPT
   #ifdef WITH_SIPOPT
@@ -0,0 +1,558 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "lapack_ldl_sparse.hpp"
+#include "../../symbolic/stl_vector_tools.hpp"
+#include "../../symbolic/matrix/crs_sparsity_internal.hpp"
+#include "../../symbolic/thread_pool.hpp"
+
+using namespace std;
+namespace CasADi{
+
+  LapackLDLSparse::LapackLDLSparse(){
+  }
+
+  LapackLDLSparse::LapackLDLSparse(const CRSSparsity& sparsity, int nrhs){
+    assignNode(new LapackLDLSparseInternal(sparsity,nrhs));
+  }
+ 
+  LapackLDLSparseInternal* LapackLDLSparse::operator->(){
+    return static_cast<LapackLDLSparseInternal*>(FX::operator->());
+  }
+
+  const LapackLDLSparseInternal* LapackLDLSparse::operator->() const{
+    return static_cast<const LapackLDLSparseInternal*>(FX::operator->());
+  }
+
+  LapackLDLSparseInternal::LapackLDLSparseInternal(const CRSSparsity& sparsity, int nrhs) : LinearSolverInternal(sparsity,nrhs){
+    addOption("ordering", OT_STRING, "amd", "Fill-reducing ordering", "natural: no reordering|amd: approximate minimum degree ordering");
+    addOption("pivot_tolerance", OT_REAL, 0.01, "Threshold for accepting a pivot: a larger element in the pivot column causes a 2x2 pivot or the pivot to be delayed to the parent supernode");
+  }
+
+  LapackLDLSparseInternal::~LapackLDLSparseInternal(){
+  }
+
+  void LapackLDLSparseInternal::init(){
+    // Call the base class initializer
+    LinearSolverInternal::init();
+
+    // Sparsity pattern of A
+    const CRSSparsity& sp = input(LINSOL_A).sparsity();
+    casadi_assert_message(sp.isTranspose(sp),"LapackLDLSparseInternal::init: the sparsity pattern of the matrix must be symmetric");
+    n_ = sp.size1();
+    
+    // Fill-reducing ordering
+    vector<int> p;
+    if(getOption("ordering")=="natural"){
+      p.resize(n_);
+      for(int k=0; k<n_; ++k) p[k] = k;
+    } else if(getOption("ordering")=="amd"){
+      p = sp->approximateMinimumDegree(1);
+      p.resize(n_);
+    } else {
+      casadi_error("LapackLDLSparseInternal::init: Unknown ordering \"" << getOption("ordering") << "\"");
+    }
+    
+    // Postorder the elimination tree, which makes the columns of each supernode consecutive
+    vector<int> post = CRSSparsityInternal::postorder(sp.pmult(p,true,true,true).eliminationTree(),n_);
+    perm_.resize(n_);
+    for(int k=0; k<n_; ++k) perm_[k] = p[post[k]];
+    vector<int> pinv(n_);
+    for(int k=0; k<n_; ++k) pinv[perm_[k]] = k;
+    
+    // Permuted matrix and its elimination tree
+    CRSSparsity C = sp.pmult(perm_,true,true,true);
+    vector<int> parent = C.eliminationTree();
+    const vector<int>& C_rowind = C.rowind();
+    const vector<int>& C_col = C.col();
+
+    // Column counts of L, by traversing the row subtrees of the elimination tree
+    vector<int> colcount(n_,1), flag(n_,-1);
+    for(int k=0; k<n_; ++k){
+      flag[k] = k;
+      for(int el=C_rowind[k]; el<C_rowind[k+1]; ++el){
+        if(C_col[el]>k) continue;
+        for(int j=C_col[el]; flag[j]!=k; j=parent[j]){
+          colcount[j]++;
+          flag[j] = k;
+        }
+      }
+    }
+
+    // Number of children of each column in the elimination tree
+    vector<int> nchild(n_,0);
+    for(int j=0; j<n_; ++j){
+      if(parent[j]>=0) nchild[parent[j]]++;
+    }
+    
+    // Fundamental supernodes: a column joins the supernode of the previous column if it is its only child and the structures match
+    vector<int> snode(n_);
+    sn_first_.clear();
+    for(int j=0; j<n_; ++j){
+      if(j==0 || parent[j-1]!=j || nchild[j]!=1 || colcount[j-1]!=colcount[j]+1){
+        sn_first_.push_back(j);
+      }
+      snode[j] = sn_first_.size()-1;
+    }
+    int nsn = sn_first_.size();
+    sn_first_.push_back(n_);
+    
+    // Rows below the diagonal block of each supernode, sorted since the rows are visited in increasing order
+    sn_row_ptr_.resize(nsn+1);
+    sn_row_ptr_[0] = 0;
+    for(int s=0; s<nsn; ++s){
+      int nc = sn_first_[s+1]-sn_first_[s];
+      sn_row_ptr_[s+1] = sn_row_ptr_[s] + colcount[sn_first_[s]] - nc;
+    }
+    sn_rows_.resize(sn_row_ptr_.back());
+    vector<int> sn_flag(nsn,-1), sn_fill(sn_row_ptr_.begin(),sn_row_ptr_.end()-1);
+    fill(flag.begin(),flag.end(),-1);
+    for(int k=0; k<n_; ++k){
+      flag[k] = k;
+      for(int el=C_rowind[k]; el<C_rowind[k+1]; ++el){
+        if(C_col[el]>k) continue;
+        for(int j=C_col[el]; flag[j]!=k; j=parent[j]){
+          flag[j] = k;
+          int s = snode[j];
+          if(k>=sn_first_[s+1] && sn_flag[s]!=k){
+            sn_flag[s] = k;
+            sn_rows_[sn_fill[s]++] = k;
+          }
+        }
+      }
+    }
+    
+    // Supernodal elimination tree, children have lower indices than their parents
+    sn_parent_.resize(nsn);
+    child_ptr_.resize(nsn+1);
+    fill(child_ptr_.begin(),child_ptr_.end(),0);
+    for(int s=0; s<nsn; ++s){
+      int j = parent[sn_first_[s+1]-1];
+      sn_parent_[s] = j<0 ? -1 : snode[j];
+      if(j>=0) child_ptr_[sn_parent_[s]+1]++;
+    }
+    for(int s=0; s<nsn; ++s) child_ptr_[s+1] += child_ptr_[s];
+    child_.resize(child_ptr_.back());
+    vector<int> child_fill(child_ptr_.begin(),child_ptr_.end()-1);
+    for(int s=0; s<nsn; ++s){
+      if(sn_parent_[s]>=0) child_[child_fill[sn_parent_[s]]++] = s;
+    }
+    
+    // Factors of the supernodes, the sizes depend on the pivots
+    front_.resize(nsn);
+    ne_.resize(nsn);
+    lx_.resize(nsn);
+    d_.resize(nsn);
+    upd_.resize(nsn);
+
+    // Lower triangular nonzeros of the permuted matrix, grouped by supernode
+    const vector<int>& rowind = sp.rowind();
+    const vector<int>& col = sp.col();
+    vector<int> nz_sn(col.size(),-1);
+    asm_ptr_.resize(nsn+1);
+    fill(asm_ptr_.begin(),asm_ptr_.end(),0);
+    for(int i=0; i<n_; ++i){
+      for(int el=rowind[i]; el<rowind[i+1]; ++el){
+        if(pinv[i]>=pinv[col[el]]){
+          nz_sn[el] = snode[pinv[col[el]]];
+          asm_ptr_[nz_sn[el]+1]++;
+        }
+      }
+    }
+    for(int s=0; s<nsn; ++s) asm_ptr_[s+1] += asm_ptr_[s];
+    asm_nz_.resize(asm_ptr_.back());
+    asm_row_.resize(asm_ptr_.back());
+    asm_col_.resize(asm_ptr_.back());
+    vector<int> asm_fill(asm_ptr_.begin(),asm_ptr_.end()-1);
+    vector<int> nz_row = sp.getRow();
+    for(int el=0; el<nz_sn.size(); ++el){
+      if(nz_sn[el]<0) continue;
+      int k = asm_fill[nz_sn[el]]++;
+      asm_nz_[k] = el;
+      asm_row_[k] = pinv[nz_row[el]];
+      asm_col_[k] = pinv[col[el]];
+    }
+    
+    // Level of each supernode in the elimination tree, leaves at level zero
+    vector<int> level(nsn,0);
+    int nlevel = nsn==0 ? 0 : 1;
+    for(int s=0; s<nsn; ++s){
+      if(sn_parent_[s]>=0) level[sn_parent_[s]] = std::max(level[sn_parent_[s]],level[s]+1);
+      nlevel = std::max(nlevel,level[s]+1);
+    }
+    
+    // Estimated cost of factorizing each supernode
+    vector<double> cost(nsn);
+    for(int s=0; s<nsn; ++s){
+      double nc = sn_first_[s+1]-sn_first_[s];
+      double nr = sn_row_ptr_[s+1]-sn_row_ptr_[s];
+      cost[s] = nc*nc*nc/3 + nr*nc*nc + nr*nr*nc;
+    }
+    
+    // Group the supernodes by level, most expensive first
+    level_ptr_.resize(nlevel+1);
+    fill(level_ptr_.begin(),level_ptr_.end(),0);
+    for(int s=0; s<nsn; ++s) level_ptr_[level[s]+1]++;
+    for(int l=0; l<nlevel; ++l) level_ptr_[l+1] += level_ptr_[l];
+    level_sn_.resize(nsn);
+    vector<int> level_fill(level_ptr_.begin(),level_ptr_.end()-1);
+    for(int s=0; s<nsn; ++s) level_sn_[level_fill[level[s]]++] = s;
+    vector<pair<double,int> > level_order;
+    level_cost_.resize(nsn);
+    for(int l=0; l<nlevel; ++l){
+      level_order.clear();
+      for(int k=level_ptr_[l]; k<level_ptr_[l+1]; ++k){
+        level_order.push_back(pair<double,int>(-cost[level_sn_[k]],level_sn_[k]));
+      }
+      sort(level_order.begin(),level_order.end());
+      for(int k=0; k<level_order.size(); ++k){
+        level_sn_[level_ptr_[l]+k] = level_order[k].second;
+        level_cost_[level_ptr_[l]+k] = -level_order[k].first;
+      }
+    }
+    
+    // Work vectors, one per thread
+    int nthreads = ThreadPool::getInstance().getNumThreads();
+    work_.resize(nthreads);
+    upd_work_.resize(nthreads);
+    pos_.resize(nthreads);
+    for(int t=0; t<nthreads; ++t) pos_[t].resize(n_);
+    y_.resize(n_*rhs_panel_);
+    pivot_tol_ = getOption("pivot_tolerance");
+  }
+
+  namespace{
+    // Factorize one supernode of the current level
+    void ldlSparseTask(void* user_data, int task, int thread){
+      static_cast<LapackLDLSparseInternal*>(user_data)->factorizeLevelTask(task,thread);
+    }
+
+    // Symmetric interchange of rows/columns a and b of the fully summed part of a frontal matrix
+    void swapPivot(double* F, int m, int p, int a, int b, int* ind){
+      if(a==b) return;
+      std::swap_ranges(F+a*m,F+a*m+m,F+b*m);
+      for(int j=0; j<p; ++j) std::swap(F[a+j*m],F[b+j*m]);
+      std::swap(ind[a],ind[b]);
+    }
+
+    // Threshold Bunch-Kaufman pivot search among the remaining fully summed columns k to p-1 of a frontal matrix
+    // of dimension m. Returns the size of the pivot (0 if no acceptable pivot was found) and its rows/columns
+    int findPivot(const double* F, int m, int k, int p, double u, int& r1, int& r2){
+      for(int j=k; j<p; ++j){
+        const double* Fj = F+j*m;
+        
+        // Largest off-diagonal element of the column, among all rows and among the fully summed rows
+        double cmax = 0, rmax = 0;
+        int r = -1;
+        for(int i=k; i<m; ++i){
+          if(i==j) continue;
+          double v = fabs(Fj[i]);
+          if(v>cmax) cmax = v;
+          if(i<p && v>rmax){
+            rmax = v;
+            r = i;
+          }
+        }
+        
+        // 1x1 pivot
+        if(Fj[j]!=0 && fabs(Fj[j])>=u*cmax){
+          r1 = j;
+          return 1;
+        }
+        
+        // 2x2 pivot with the largest fully summed element of the column
+        if(r<0) continue;
+        const double* Fr = F+r*m;
+        double det = Fj[j]*Fr[r] - Fj[r]*Fj[r];
+        if(det==0 || det!=det) continue;
+        double cj = 0, cr = 0;
+        for(int i=k; i<m; ++i){
+          if(i==j || i==r) continue;
+          cj = std::max(cj,fabs(Fj[i]));
+          cr = std::max(cr,fabs(Fr[i]));
+        }
+        if(u*(fabs(Fr[r])*cj + rmax*cr)<=fabs(det) && u*(rmax*cj + fabs(Fj[j])*cr)<=fabs(det)){
+          r1 = std::min(j,r);
+          r2 = std::max(j,r);
+          return 2;
+        }
+      }
+      return 0;
+    }
+  } // namespace
+
+  void LapackLDLSparseInternal::prepare(){
+    // Nothing to do if the linear system has not changed since the last factorization
+    if(sameMatrix() && prepared_) return;
+    prepared_ = false;
+
+    // Factorize the supernodes level by level, the supernodes of a level are independent
+    for(current_level_=0; current_level_+1<level_ptr_.size(); ++current_level_){
+      int ntask = level_ptr_[current_level_+1]-level_ptr_[current_level_];
+      if(ntask==1){
+        factorizeLevelTask(0,0);
+      } else {
+        ThreadPool::getInstance().run(ldlSparseTask,this,ntask,getPtr(level_cost_)+level_ptr_[current_level_]);
+      }
+    }
+    
+    // Work vector for the solve, the size of the fronts depends on the delayed pivots
+    int max_m = 0;
+    for(int s=0; s<front_.size(); ++s) max_m = std::max(max_m,int(front_[s].size()));
+    solve_work_.resize(max_m*rhs_panel_);
+    
+    // Sucess if reached this point
+    prepared_ = true;
+  }
+
+  void LapackLDLSparseInternal::factorizeLevelTask(int task, int thread){
+    factorizeSupernode(level_sn_[level_ptr_[current_level_]+task],thread);
+  }
+
+  void LapackLDLSparseInternal::factorizeSupernode(int s, int thread){
+    // Rows/columns of the frontal matrix: the columns delayed by the children, the columns of the supernode and the rows below
+    vector<int>& ind = front_[s];
+    ind.clear();
+    for(int cc=child_ptr_[s]; cc<child_ptr_[s+1]; ++cc){
+      int c = child_[cc];
+      int ndelay = front_[c].size() - ne_[c] - (sn_row_ptr_[c+1]-sn_row_ptr_[c]);
+      ind.insert(ind.end(),front_[c].begin()+ne_[c],front_[c].begin()+ne_[c]+ndelay);
+    }
+    for(int j=sn_first_[s]; j<sn_first_[s+1]; ++j) ind.push_back(j);
+    ind.insert(ind.end(),sn_rows_.begin()+sn_row_ptr_[s],sn_rows_.begin()+sn_row_ptr_[s+1]);
+    int m = ind.size();
+    int nr = sn_row_ptr_[s+1]-sn_row_ptr_[s];
+    int p = m-nr;
+    int* pos = getPtr(pos_[thread]);
+    for(int i=0; i<m; ++i) pos[ind[i]] = i;
+    
+    // Frontal matrix, both triangles of the fully summed columns are kept up to date, column major
+    vector<double>& Fv = work_[thread];
+    Fv.resize(m*m);
+    fill(Fv.begin(),Fv.end(),0.);
+    double* F = getPtr(Fv);
+    
+    // Assemble the nonzeros of A
+    const vector<double>& a = input(LINSOL_A).data();
+    for(int k=asm_ptr_[s]; k<asm_ptr_[s+1]; ++k){
+      int i = pos[asm_row_[k]], j = pos[asm_col_[k]];
+      F[i + j*m] += a[asm_nz_[k]];
+      if(i!=j) F[j + i*m] += a[asm_nz_[k]];
+    }
+    
+    // Add the lower triangular part of the update matrices of the children
+    for(int cc=child_ptr_[s]; cc<child_ptr_[s+1]; ++cc){
+      int c = child_[cc];
+      int nbc = front_[c].size()-ne_[c];
+      const double* Uc = getPtr(upd_[c]);
+      const int* indc = getPtr(front_[c]) + ne_[c];
+      for(int jc=0; jc<nbc; ++jc){
+        int j = pos[indc[jc]];
+        F[j + j*m] += Uc[jc + jc*nbc];
+        for(int ic=jc+1; ic<nbc; ++ic){
+          int i = pos[indc[ic]];
+          F[i + j*m] += Uc[ic + jc*nbc];
+          F[j + i*m] += Uc[ic + jc*nbc];
+        }
+      }
+      
+      // The update matrix of the child is no longer needed
+      vector<double>().swap(upd_[c]);
+    }
+    
+    // Factorize the fully summed columns with 1x1 and 2x2 pivots, right-looking. At a root of the
+    // elimination tree, the pivots cannot be delayed and any nonsingular pivot is accepted
+    double u = sn_parent_[s]<0 ? 0 : pivot_tol_;
+    vector<double>& D = d_[s];
+    D.resize(2*p);
+    int ne = 0;
+    while(ne<p){
+      int r1, r2;
+      int npiv = findPivot(F,m,ne,p,u,r1,r2);
+      if(npiv==0) break;
+      swapPivot(F,m,p,ne,r1,getPtr(ind));
+      double* F0 = F+ne*m;
+      if(npiv==1){
+        double d0 = F0[ne];
+        for(int j=ne+1; j<p; ++j){
+          double v = F0[j]/d0;
+          if(v==0) continue;
+          double* Fj = F+j*m;
+          for(int i=ne+1; i<m; ++i) Fj[i] -= F0[i]*v;
+        }
+        for(int i=ne+1; i<m; ++i) F0[i] /= d0;
+        F0[ne] = 1;
+        D[2*ne] = d0;
+        D[2*ne+1] = 0;
+      } else {
+        swapPivot(F,m,p,ne+1,r2,getPtr(ind));
+        double* F1 = F+(ne+1)*m;
+        double d0 = F0[ne], e0 = F0[ne+1], d1 = F1[ne+1], det = d0*d1 - e0*e0;
+        for(int j=ne+2; j<p; ++j){
+          double v0 = (d1*F0[j] - e0*F1[j])/det, v1 = (d0*F1[j] - e0*F0[j])/det;
+          double* Fj = F+j*m;
+          for(int i=ne+2; i<m; ++i) Fj[i] -= F0[i]*v0 + F1[i]*v1;
+        }
+        for(int i=ne+2; i<m; ++i){
+          double f0 = F0[i], f1 = F1[i];
+          F0[i] = (d1*f0 - e0*f1)/det;
+          F1[i] = (d0*f1 - e0*f0)/det;
+        }
+        F0[ne] = F1[ne+1] = 1;
+        F0[ne+1] = F1[ne] = 0;
+        D[2*ne] = d0;
+        D[2*ne+1] = e0;
+        D[2*ne+2] = d1;
+        D[2*ne+3] = 0;
+      }
+      ne += npiv;
+    }
+    if(ne<p && u==0){
+      stringstream ss;
+      ss << "LapackLDLSparseInternal::prepare: zero pivot in row " << perm_[ind[ne]] << ". The matrix is singular.";
+      throw CasadiException(ss.str());
+    }
+    ne_[s] = ne;
+    D.resize(2*ne);
+    
+    // Rows below the fully summed columns: W = L21*D
+    if(ne>0 && nr>0){
+      vector<double>& Wv = upd_work_[thread];
+      Wv.resize(nr*ne);
+      double* W = getPtr(Wv);
+      const double* L21 = F+p;
+      for(int j=0; j<ne; ++j){
+        if(D[2*j+1]==0){
+          for(int i=0; i<nr; ++i) W[i+j*nr] = L21[i+j*m]*D[2*j];
+        } else {
+          for(int i=0; i<nr; ++i){
+            W[i+j*nr] = L21[i+j*m]*D[2*j] + L21[i+(j+1)*m]*D[2*j+1];
+            W[i+(j+1)*nr] = L21[i+j*m]*D[2*j+1] + L21[i+(j+1)*m]*D[2*j+2];
+          }
+          j++;
+        }
+      }
+      
+      // Update matrix: F22 -= L21*W^T
+      char trans = 'T', notrans = 'N';
+      double one = 1, minus_one = -1;
+      dgemm_(&notrans, &trans, &nr, &nr, &ne, &minus_one, F+p, &m, W, &nr, &one, F+p+p*m, &m);
+    }
+    
+    // Keep the columns of L
+    lx_[s].assign(F,F+m*ne);
+    
+    // Update matrix passed to the parent, including the delayed columns
+    int nb = m-ne;
+    upd_[s].resize(nb*nb);
+    for(int j=0; j<nb; ++j){
+      copy(F+ne+(ne+j)*m, F+m+(ne+j)*m, upd_[s].begin()+j*nb);
+    }
+  }
+    
+  void LapackLDLSparseInternal::solve(double* x, int nrhs, bool transpose){
+    // The matrix is symmetric, so the transpose flag can be ignored
+    int nsn = sn_first_.size()-1;
+    char side = 'L', uplo = 'L', trans = 'T', notrans = 'N', diag = 'U';
+    double one = 1, zero = 0, minus_one = -1;
+    double* G = getPtr(solve_work_);
+    
+    // Process the right hand sides in panels, stored column major with leading dimension n_
+    for(int r0=0; r0<nrhs; r0+=rhs_panel_){
+      int np = std::min(nrhs-r0, int(rhs_panel_));
+      double* Y = getPtr(y_);
+      
+      // Permute the right hand sides
+      for(int r=0; r<np; ++r){
+        for(int k=0; k<n_; ++k) Y[k+r*n_] = x[perm_[k]+r*n_];
+      }
+      
+      // Solve L*Z = Y and D*W = Z, gathering the rows of each front into G (leading dimension m)
+      for(int s=0; s<nsn; ++s){
+        int ne = ne_[s];
+        if(ne==0) continue;
+        int m = front_[s].size();
+        int nb = m-ne;
+        const int* ind = getPtr(front_[s]);
+        double* F = getPtr(lx_[s]);
+        const double* D = getPtr(d_[s]);
+        for(int r=0; r<np; ++r){
+          for(int i=0; i<ne; ++i) G[i+r*m] = Y[ind[i]+r*n_];
+        }
+        dtrsm_(&side, &uplo, &notrans, &diag, &ne, &np, &one, F, &m, G, &m);
+        if(nb>0){
+          dgemm_(&notrans, &notrans, &nb, &np, &ne, &one, F+ne, &m, G, &m, &zero, G+ne, &m);
+          for(int r=0; r<np; ++r){
+            for(int i=ne; i<m; ++i) Y[ind[i]+r*n_] -= G[i+r*m];
+          }
+        }
+        for(int r=0; r<np; ++r){
+          double* g = G+r*m;
+          for(int i=0; i<ne; ++i){
+            if(D[2*i+1]==0){
+              g[i] /= D[2*i];
+            } else {
+              double det = D[2*i]*D[2*i+2] - D[2*i+1]*D[2*i+1];
+              double g0 = g[i], g1 = g[i+1];
+              g[i] = (D[2*i+2]*g0 - D[2*i+1]*g1)/det;
+              g[i+1] = (D[2*i]*g1 - D[2*i+1]*g0)/det;
+              i++;
+            }
+          }
+          for(int i=0; i<ne; ++i) Y[ind[i]+r*n_] = g[i];
+        }
+      }
+      
+      // Solve L^T*V = W
+      for(int s=nsn-1; s>=0; --s){
+        int ne = ne_[s];
+        if(ne==0) continue;
+        int m = front_[s].size();
+        int nb = m-ne;
+        const int* ind = getPtr(front_[s]);
+        double* F = getPtr(lx_[s]);
+        for(int r=0; r<np; ++r){
+          for(int i=0; i<m; ++i) G[i+r*m] = Y[ind[i]+r*n_];
+        }
+        if(nb>0){
+          dgemm_(&trans, &notrans, &ne, &np, &nb, &minus_one, F+ne, &m, G+ne, &m, &one, G, &m);
+        }
+        dtrsm_(&side, &uplo, &trans, &diag, &ne, &np, &one, F, &m, G, &m);
+        for(int r=0; r<np; ++r){
+          for(int i=0; i<ne; ++i) Y[ind[i]+r*n_] = G[i+r*m];
+        }
+      }
+      
+      // Undo the permutation
+      for(int r=0; r<np; ++r){
+        for(int k=0; k<n_; ++k) x[perm_[k]+r*n_] = Y[k+r*n_];
+      }
+      x += np*n_;
+    }
+  }
+
+  LapackLDLSparseInternal* LapackLDLSparseInternal::clone() const{
+    return new LapackLDLSparseInternal(*this);
+  }
+
+} // namespace CasADi
@@ -0,0 +1,173 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef LAPACK_LDL_SPARSE_HPP
+#define LAPACK_LDL_SPARSE_HPP
+
+#include "symbolic/fx/linear_solver_internal.hpp"
+
+namespace CasADi{
+  
+  /** \brief  Forward declaration of internal class
+
+      @copydoc LinearSolver_doc
+  */
+  class LapackLDLSparseInternal;
+
+  /** \brief  Sparse LDL^T LinearSolver using BLAS on dense supernodes
+   * @copydoc LinearSolver_doc
+   *
+   * This class solves the linear system A.x=b, with A symmetric, by making a sparse LDL^T factorization: \n
+   * P.A.P^T = L.D.L^T, with P a permutation, L unit lower triangular and D block diagonal with 1x1 and 2x2 blocks
+   *
+   * The factorization is multifrontal: columns of L with the same sparsity pattern are grouped into
+   * supernodes that are factorized as dense frontal matrices. Supernodes in different branches
+   * of the elimination tree are independent and are factorized in parallel by the CasADi thread pool.
+   * The factorization is skipped if the nonzeros of A are unchanged since the last call.
+   *
+   * A may be indefinite (e.g. a KKT matrix). Within each front, threshold Bunch-Kaufman pivoting chooses 
+   * 1x1 and 2x2 pivots among the fully summed columns, and columns without an acceptable pivot
+   * ("pivot_tolerance") are delayed to the parent supernode, which increases the fill-in. 
+   * The prepare step fails only if A is singular.
+   * The sparsity pattern of A must be symmetric and the transpose flag has no effect.
+   *
+   * LapackLDLSparse is an CasADi::FX mapping from 2 inputs [ A (matrix),b (vector)] to one output [x (vector)].
+   *
+   */
+  class LapackLDLSparse : public LinearSolver{
+  public:
+
+    /// Default (empty) constructor
+    LapackLDLSparse();
+  
+    /// Create a linear solver given a sparsity pattern
+    LapackLDLSparse(const CRSSparsity& sparsity, int nrhs=1);
+    
+    /// Access functions of the node
+    LapackLDLSparseInternal* operator->();
+    const LapackLDLSparseInternal* operator->() const;
+  
+    /// Static creator function
+#ifdef SWIG
+    %callback("%s_cb");
+#endif
+    static LinearSolver creator(const CRSSparsity& sp, int nrhs){ return LapackLDLSparse(sp,nrhs);}
+#ifdef SWIG
+    %nocallback;
+#endif
+
+  };
+
+#ifndef SWIG
+
+  /// Solve a triangular system of equations with multiple right hand sides (blas)
+  extern "C" void dtrsm_(char *side, char *uplo, char *transa, char *diag, int *m, int *n, double *alpha, double *a, int *lda, double *b, int *ldb);
+
+  /// Matrix-matrix product (blas)
+  extern "C" void dgemm_(char *transa, char *transb, int *m, int *n, int *k, double *alpha, double *a, int *lda, double *b, int *ldb, double *beta, double *c, int *ldc);
+
+  /// Internal class
+  class LapackLDLSparseInternal : public LinearSolverInternal{
+  public:
+    // Create a linear solver given a sparsity pattern and a number of right hand sides
+    LapackLDLSparseInternal(const CRSSparsity& sparsity, int nrhs);
+
+    // Clone
+    virtual LapackLDLSparseInternal* clone() const;
+    
+    // Destructor
+    virtual ~LapackLDLSparseInternal();
+    
+    // Initialize the solver
+    virtual void init();
+
+    // Prepare the solution of the linear system
+    virtual void prepare();
+    
+    // Solve the system of equations
+    virtual void solve(double* x, int nrhs, bool transpose);
+
+    // Factorize a supernode of the current level, called from the thread pool
+    void factorizeLevelTask(int task, int thread);
+
+  protected:
+
+    // Factorize a supernode, its children must have been factorized
+    void factorizeSupernode(int s, int thread);
+
+    // Dimension
+    int n_;
+
+    // Fill-reducing permutation: row/column k of the factorized matrix is row/column perm_[k] of A
+    std::vector<int> perm_;
+
+    // Columns of L in each supernode: sn_first_[s] to sn_first_[s+1]-1
+    std::vector<int> sn_first_;
+
+    // Rows of L below the diagonal block of each supernode, sorted
+    std::vector<int> sn_row_ptr_, sn_rows_;
+
+    // Parent and children of each supernode in the supernodal elimination tree
+    std::vector<int> sn_parent_, child_ptr_, child_;
+
+    // Nonzeros of A assembled into each supernode: a[asm_nz_[k]] is element (asm_row_[k],asm_col_[k]) of the permuted matrix
+    std::vector<int> asm_ptr_, asm_nz_, asm_row_, asm_col_;
+
+    // Supernodes grouped by level in the elimination tree, leaves first, most expensive first within each level
+    std::vector<int> level_ptr_, level_sn_;
+
+    // Estimated number of flops to factorize each supernode, aligned with level_sn_
+    std::vector<double> level_cost_;
+
+    // Level being factorized
+    int current_level_;
+
+    // Threshold for accepting a pivot
+    double pivot_tol_;
+
+    // Rows/columns of the frontal matrix of each supernode, the ne_[s] eliminated columns first
+    std::vector<std::vector<int> > front_;
+    std::vector<int> ne_;
+
+    // Eliminated columns of L of each supernode (unit diagonal, column major, leading dimension is the size of the front)
+    std::vector<std::vector<double> > lx_;
+
+    // Blocks of D of each supernode: diagonal and subdiagonal interleaved, the subdiagonal is nonzero for the first column of a 2x2 block
+    std::vector<std::vector<double> > d_;
+
+    // Update matrices of the supernodes, including the delayed columns, released when added to the parent
+    std::vector<std::vector<double> > upd_;
+
+    // Work vectors, one per thread: frontal matrix, scaled columns of L and position of each row in the front
+    std::vector<std::vector<double> > work_, upd_work_;
+    std::vector<std::vector<int> > pos_;
+
+    // Permuted panel of right hand sides and work vector for the solve
+    std::vector<double> y_, solve_work_;
+  };
+
+#endif // SWIG
+
+} // namespace CasADi
+
+#endif //LAPACK_LDL_SPARSE_HPP
@@ -44,6 +44,7 @@ CVodesInternal::CVodesInternal(const FX& f, const FX& g) : SundialsInternal(f,g)
   addOption("nonlinear_solver_iteration",       OT_STRING,              "newton",       "","newton|functional");
   addOption("fsens_all_at_once",                OT_BOOLEAN,             true,           "Calculate all right hand sides of the sensitivity equations at once");
   addOption("disable_internal_warnings",        OT_BOOLEAN,             false,          "Disable CVodes internal warning messages");
+  addOption("evaluate_in_place",                OT_BOOLEAN,             true,           "Evaluate the right hand sides directly on the CVodes data, without copying via the inputs and outputs of f and g");
   addOption("monitor",                          OT_STRINGVECTOR,        GenericType(),  "", "res|resB|resQB|reset|psetupB|djacB", true);
     
   mem_ = 0;
@@ -96,9 +97,19 @@ void CVodesInternal::init(){
   monitor_rhsB_  = monitored("resB");
   monitor_rhs_   = monitored("res");
   monitor_rhsQB_ = monitored("resQB");
-  
-  // Get the number of forward and adjoint directions
-  nfdir_f_ = f_.getOption("number_of_fwd_dir");
+  evaluate_in_place_ = getOption("evaluate_in_place");
+
+  // Work vectors for evaluating the right hand sides directly on the SUNDIALS data
+  size_t ni, nr;
+  f_.nWork(ni,nr);
+  iw_f_.resize(ni);
+  w_f_.resize(nr);
+  if(!g_.isNull()){
+    g_.nWork(ni,nr);
+    iw_g_.resize(ni);
+    w_g_.resize(nr);
+  }
+  fsens_f_ = FX();
 
   // Sundials return flag
   int flag;
@@ -170,7 +181,7 @@ void CVodesInternal::init(){
     if(flag != CV_SUCCESS) cvodes_error("CVodeQuadInit",flag);
     
     // Should the quadrature errors be used for step size control?
-    if(getOption("quad_err_con").toInt()){
+    if(quad_err_con_){
       flag = CVodeSetQuadErrCon(mem_, true);
       if(flag != CV_SUCCESS) cvodes_error("CVodeSetQuadErrCon",flag);
       
@@ -270,19 +281,9 @@ void CVodesInternal::init(){
       rq_ = N_VMake_Serial(nrq_,output(INTEGRATOR_RQF).ptr());
 //     }
     
-    // Get the number of steos per checkpoint
-    int Nd = getOption("steps_per_checkpoint");
-
-    // Get the interpolation type
-    int interpType;
-    if(getOption("interpolation_type")=="hermite")
-      interpType = CV_HERMITE;
-    else if(getOption("interpolation_type")=="polynomial")
-      interpType = CV_POLYNOMIAL;
-    else throw CasadiException("\"interpolation_type\" must be \"hermite\" or \"polynomial\"");
-      
     // Initialize adjoint sensitivities
-    flag = CVodeAdjInit(mem_, Nd, interpType);
+    int interpType = hermite_interpolation_ ? CV_HERMITE : CV_POLYNOMIAL;
+    flag = CVodeAdjInit(mem_, steps_per_checkpoint_, interpType);
     if(flag != CV_SUCCESS) cvodes_error("CVodeAdjInit",flag);
           
     isInitAdj_ = false;
@@ -332,7 +333,7 @@ void CVodesInternal::initAdj(){
   flag = CVodeQuadInitB(mem_,whichB_,rhsQB_wrapper,rq_);
   if(flag!=CV_SUCCESS) cvodes_error("CVodeQuadInitB",flag);
   
-  if(getOption("quad_err_con").toInt()){
+  if(quad_err_con_){
     flag = CVodeSetQuadErrConB(mem_, whichB_,true);
     if(flag != CV_SUCCESS) cvodes_error("CVodeSetQuadErrConB",flag);
       
@@ -350,25 +351,25 @@ void CVodesInternal::rhs(double t, const double* x, double* xdot){
   // Get time
   time1 = clock();
 
-  // Pass input
-  f_.setInput(&t,DAE_T);
-  f_.setInput(x,DAE_X);
-  f_.setInput(input(INTEGRATOR_P),DAE_P);
+  // Pass input and output without copying
+  const double* arg[DAE_NUM_IN] = {0};
+  arg[DAE_T] = &t;
+  arg[DAE_X] = x;
+  arg[DAE_P] = getPtr(input(INTEGRATOR_P).data());
+  double* res[DAE_NUM_OUT] = {0};
+  res[DAE_ODE] = xdot;
 
   if(monitor_rhs_) {
     cout << "t       = " << t << endl;
-    cout << "x       = " << f_.input(DAE_X) << endl;
-    cout << "p       = " << f_.input(DAE_P) << endl;
+    cout << "x       = " << vector<double>(x,x+nx_) << endl;
+    cout << "p       = " << input(INTEGRATOR_P) << endl;
   }
     // Evaluate
-  f_.evaluate();
+  evaluateRhs(f_,arg,res,iw_f_,w_f_);
 
   if(monitor_rhs_) {
-    cout << "xdot       = " << f_.output(DAE_ODE)<< endl;
+    cout << "xdot       = " << vector<double>(xdot,xdot+nx_) << endl;
   }
-    
-  // Get results
-  f_.getOutput(xdot);
 
   // Log time
   time2 = clock();
@@ -417,6 +418,17 @@ void CVodesInternal::reset(int nsens, int nsensB, int nsensB_store){
   
   // Re-initialize sensitivities
   if(nsens>0){
+    // Forward derivative of f for the right hand sides of the sensitivity equations
+    if(fsens_f_.isNull()){
+      fsens_f_ = f_.derivative(nfdir_,0);
+      size_t ni, nr;
+      fsens_f_.nWork(ni,nr);
+      iw_fsens_.resize(ni);
+      w_fsens_.resize(nr);
+      arg_fsens_.resize(fsens_f_.getNumInputs());
+      res_fsens_.resize(fsens_f_.getNumOutputs());
+    }
+
     flag = CVodeSensReInit(mem_,ism_,getPtr(xF0_));
     if(flag != CV_SUCCESS) cvodes_error("CVodeSensReInit",flag);
     
@@ -484,7 +496,7 @@ void CVodesInternal::integrate(double t_out){
 
   
   // Print statistics
-  if(getOption("print_stats")) printStats(std::cout);
+  if(print_stats_) printStats(std::cout);
   
   if (gather_stats_) {
     long nsteps, nfevals, nlinsetups, netfails;
@@ -692,29 +704,9 @@ void CVodesInternal::rhsS(int Ns, double t, N_Vector x, N_Vector xdot, N_Vector
 
   // Record the current cpu time
   time1 = clock();
-  
-    // Pass input
-  f_.setInput(&t,DAE_T);
-  f_.setInput(NV_DATA_S(x),DAE_X);
-  f_.setInput(input(INTEGRATOR_P),DAE_P);
 
-   // Calculate the forward sensitivities, nfdir_f_ directions at a time
-   for(int j=0; j<nfdir_; j += nfdir_f_){
-     for(int dir=0; dir<nfdir_f_ && j+dir<nfdir_; ++dir){
-       // Pass forward seeds 
-       f_.fwdSeed(DAE_T,dir).setZero();
-       f_.setFwdSeed(NV_DATA_S(xF[j+dir]),DAE_X,dir);
-       f_.setFwdSeed(fwdSeed(INTEGRATOR_P,j+dir),DAE_P,dir);
-     }
-
-     // Evaluate the AD forward algorithm
-     f_.evaluate(nfdir_f_,0);
-      
-     // Get the output seeds
-     for(int dir=0; dir<nfdir_f_ && j+dir<nfdir_; ++dir){
-       f_.getFwdSens(NV_DATA_S(xdotF[j+dir]),DAE_ODE,dir);
-     }
-   }
+  // Calculate the forward sensitivities in all directions at once
+  evaluateFSens(t,NV_DATA_S(x),xF,DAE_ODE,xdotF);
   
   // Record timings
   time2 = clock();
@@ -777,39 +769,52 @@ try{
   }
 }
 
+void CVodesInternal::evaluateRhs(FX& fcn, const double** arg, double** res, std::vector<int>& iw, std::vector<double>& w){
+  if(evaluate_in_place_){
+    fcn.evaluate(arg,res,getPtr(iw),getPtr(w));
+  } else {
+    // Copy via the inputs and outputs of the function
+    fcn->FXInternal::evaluate(arg,res,getPtr(iw),getPtr(w));
+  }
+}
+
+void CVodesInternal::evaluateFSens(double t, const double* x, N_Vector *xF, int oind, N_Vector *resF){
+  // Pass nondifferentiated inputs without copying, the other arguments and results are zero or not needed
+  fill(arg_fsens_.begin(),arg_fsens_.end(),static_cast<const double*>(0));
+  fill(res_fsens_.begin(),res_fsens_.end(),static_cast<double*>(0));
+  arg_fsens_[DAE_T] = &t;
+  arg_fsens_[DAE_X] = x;
+  arg_fsens_[DAE_P] = getPtr(input(INTEGRATOR_P).data());
+
+  // Forward seeds and sensitivities, the seed for the time is zero
+  for(int dir=0; dir<nfdir_; ++dir){
+    arg_fsens_[DAE_NUM_IN*(dir+1)+DAE_X] = NV_DATA_S(xF[dir]);
+    arg_fsens_[DAE_NUM_IN*(dir+1)+DAE_P] = getPtr(fwdSeed(INTEGRATOR_P,dir).data());
+    res_fsens_[DAE_NUM_OUT*(dir+1)+oind] = NV_DATA_S(resF[dir]);
+  }
+
+  // Evaluate
+  evaluateRhs(fsens_f_,getPtr(arg_fsens_),getPtr(res_fsens_),iw_fsens_,w_fsens_);
+}
+
 void CVodesInternal::rhsQ(double t, const double* x, double* qdot){
-  // Pass input
-  f_.setInput(&t,DAE_T);
-  f_.setInput(x,DAE_X);
-  f_.setInput(input(INTEGRATOR_P),DAE_P);
+  // Pass input and output without copying
+  const double* arg[DAE_NUM_IN] = {0};
+  arg[DAE_T] = &t;
+  arg[DAE_X] = x;
+  arg[DAE_P] = getPtr(input(INTEGRATOR_P).data());
+  double* res[DAE_NUM_OUT] = {0};
+  res[DAE_QUAD] = qdot;
 
   // Evaluate
-  f_.evaluate();
-    
-  // Get results
-  f_.getOutput(qdot,DAE_QUAD);
+  evaluateRhs(f_,arg,res,iw_f_,w_f_);
 }
 
 void CVodesInternal::rhsQS(int Ns, double t, N_Vector x, N_Vector *xF, N_Vector qdot, N_Vector *qdotF, N_Vector tmp1, N_Vector tmp2){
   casadi_assert(Ns==nfdir_);
   
-  // Pass input
-  f_.setInput(&t,DAE_T);
-  f_.setInput(NV_DATA_S(x),DAE_X);
-  f_.setInput(input(INTEGRATOR_P),DAE_P);
-
-  for(int i=0; i<nfdir_; ++i){
-    // Pass forward seeds
-    f_.fwdSeed(DAE_T).setZero();
-    f_.setFwdSeed(NV_DATA_S(xF[i]),DAE_X);
-    f_.setFwdSeed(fwdSeed(INTEGRATOR_P,i),DAE_P);
-
-    // Evaluate the AD forward algorithm
-    f_.evaluate(1,0);
-      
-    // Get the forward sensitivities
-    f_.getFwdSens(NV_DATA_S(qdotF[i]),DAE_QUAD);
-  }
+  // Calculate the forward sensitivities in all directions at once
+  evaluateFSens(t,NV_DATA_S(x),xF,DAE_QUAD,qdotF);
 }
 
 int CVodesInternal::rhsQS_wrapper(int Ns, double t, N_Vector x, N_Vector *xF, N_Vector qdot, N_Vector *qdotF, void *user_data, N_Vector tmp1, N_Vector tmp2){
@@ -832,29 +837,29 @@ try{
 void CVodesInternal::rhsB(double t, const double* x, const double *rx, double* rxdot){
   log("CVodesInternal::rhsB","begin");
   
-  // Pass inputs
-  g_.setInput(&t,RDAE_T);
-  g_.setInput(x,RDAE_X);
-  g_.setInput(input(INTEGRATOR_P),RDAE_P);
-  g_.setInput(input(INTEGRATOR_RP),RDAE_RP);
-  g_.setInput(rx,RDAE_RX);
+  // Pass inputs and output without copying
+  const double* arg[RDAE_NUM_IN] = {0};
+  arg[RDAE_T] = &t;
+  arg[RDAE_X] = x;
+  arg[RDAE_P] = getPtr(input(INTEGRATOR_P).data());
+  arg[RDAE_RP] = getPtr(input(INTEGRATOR_RP).data());
+  arg[RDAE_RX] = rx;
+  double* res[RDAE_NUM_OUT] = {0};
+  res[RDAE_ODE] = rxdot;
 
   if(monitor_rhsB_){
     cout << "t       = " << t << endl;
-    cout << "x       = " << g_.input(RDAE_X) << endl;
-    cout << "p       = " << g_.input(RDAE_P) << endl;
-    cout << "rx      = " << g_.input(RDAE_RX) << endl;
-    cout << "rp      = " << g_.input(RDAE_RP) << endl;
+    cout << "x       = " << vector<double>(x,x+nx_) << endl;
+    cout << "p       = " << input(INTEGRATOR_P) << endl;
+    cout << "rx      = " << vector<double>(rx,rx+nrx_) << endl;
+    cout << "rp      = " << input(INTEGRATOR_RP) << endl;
   }
   
   // Evaluate
-  g_.evaluate();
-
-  // Save to output
-  g_.getOutput(rxdot,RDAE_ODE);
+  evaluateRhs(g_,arg,res,iw_g_,w_g_);
 
   if(monitor_rhsB_){
-    cout << "xdotB = " << g_.output(RDAE_ODE) << endl;
+    cout << "xdotB = " << vector<double>(rxdot,rxdot+nrx_) << endl;
   }
   
   // Negate (note definition of g)
@@ -943,29 +948,29 @@ void CVodesInternal::rhsQB(double t, const double* x, const double* rx, double*
     cout << "CVodesInternal::rhsQB: begin" << endl;
   }
 
-  // Pass inputs
-  g_.setInput(&t,RDAE_T);
-  g_.setInput(x,RDAE_X);
-  g_.setInput(input(INTEGRATOR_P),RDAE_P);
-  g_.setInput(input(INTEGRATOR_RP),RDAE_RP);
-  g_.setInput(rx,RDAE_RX);
+  // Pass inputs and output without copying
+  const double* arg[RDAE_NUM_IN] = {0};
+  arg[RDAE_T] = &t;
+  arg[RDAE_X] = x;
+  arg[RDAE_P] = getPtr(input(INTEGRATOR_P).data());
+  arg[RDAE_RP] = getPtr(input(INTEGRATOR_RP).data());
+  arg[RDAE_RX] = rx;
+  double* res[RDAE_NUM_OUT] = {0};
+  res[RDAE_QUAD] = rqdot;
 
   if(monitor_rhsB_){
     cout << "t       = " << t << endl;
-    cout << "x       = " << g_.input(RDAE_X) << endl;
-    cout << "p       = " << g_.input(RDAE_P) << endl;
-    cout << "rx      = " << g_.input(RDAE_RX) << endl;
-    cout << "rp      = " << g_.input(RDAE_RP) << endl;
+    cout << "x       = " << vector<double>(x,x+nx_) << endl;
+    cout << "p       = " << input(INTEGRATOR_P) << endl;
+    cout << "rx      = " << vector<double>(rx,rx+nrx_) << endl;
+    cout << "rp      = " << input(INTEGRATOR_RP) << endl;
   }
   
   // Evaluate
-  g_.evaluate();
-
-  // Save to output
-  g_.getOutput(rqdot,RDAE_QUAD);
+  evaluateRhs(g_,arg,res,iw_g_,w_g_);
 
   if(monitor_rhsB_){
-    cout << "qdotB = " << g_.output(RDAE_QUAD) << endl;
+    cout << "qdotB = " << vector<double>(rqdot,rqdot+nrq_) << endl;
   }
   
   // Negate (note definition of g)
@@ -1093,7 +1098,7 @@ void CVodesInternal::djac(long N, double t, N_Vector x, N_Vector xdot, DlsMat Ja
   // Pass inputs to the jacobian function
   jac_.setInput(&t,DAE_T);
   jac_.setInput(NV_DATA_S(x),DAE_X);
-  jac_.setInput(f_.input(DAE_P),DAE_P);
+  jac_.setInput(input(INTEGRATOR_P),DAE_P);
   jac_.setInput(1.0,DAE_NUM_IN);
   jac_.setInput(0.0,DAE_NUM_IN+1);
 
@@ -1226,7 +1231,7 @@ void CVodesInternal::bjac(long N, long mupper, long mlower, double t, N_Vector x
   // Pass inputs to the jacobian function
   jac_.setInput(&t,DAE_T);
   jac_.setInput(NV_DATA_S(x),DAE_X);
-  jac_.setInput(f_.input(DAE_P),DAE_P);
+  jac_.setInput(input(INTEGRATOR_P),DAE_P);
   jac_.setInput(1.0,DAE_NUM_IN);
   jac_.setInput(0.0,DAE_NUM_IN+1);
 
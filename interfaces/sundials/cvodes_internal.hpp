@@ -197,8 +197,23 @@ public:
   // Ids of backward problem
   int whichB_;
 
-  // Number of forward directions for the functions f and g
-  int nfdir_f_, nfdir_g_;
+  // Work vectors for the functions f and g
+  std::vector<int> iw_f_, iw_g_;
+  std::vector<double> w_f_, w_g_;
+
+  // Evaluate f or g without derivatives, directly on the given data if evaluate_in_place_ is true
+  void evaluateRhs(FX& fcn, const double** arg, double** res, std::vector<int>& iw, std::vector<double>& w);
+  bool evaluate_in_place_;
+
+  // Forward derivative of f in all nfdir_ directions, generated when forward sensitivities are first needed
+  FX fsens_f_;
+  std::vector<int> iw_fsens_;
+  std::vector<double> w_fsens_;
+  std::vector<const double*> arg_fsens_;
+  std::vector<double*> res_fsens_;
+
+  // Evaluate the forward sensitivities of output oind of f with fsens_f_, directly on the CVodes data
+  void evaluateFSens(double t, const double* x, N_Vector *xF, int oind, N_Vector *resF);
 
   // Initialize the dense linear solver
   void initDenseLinearSolver();
@@ -134,6 +134,11 @@ void IdasInternal::init(){
   nfdir_f_ = f_.getOption("number_of_fwd_dir");
 
   cj_scaling_ = getOption("cj_scaling");
+
+  // Correct initial conditions, the backwards problem defaults to the forward one
+  calc_ic_ = getOption("calc_ic");
+  calc_icB_ = hasSetOption("calc_icB") ? getOption("calc_icB") : getOption("calc_ic");
+  first_time_ = hasSetOption("first_time") ? double(getOption("first_time")) : tf_;
   
   // Sundials return flag
   int flag;
@@ -234,7 +239,7 @@ void IdasInternal::init(){
     if(flag != IDA_SUCCESS) idas_error("IDAQuadInit",flag);
     
     // Should the quadrature errors be used for step size control?
-    if(getOption("quad_err_con").toInt()){
+    if(quad_err_con_){
       flag = IDASetQuadErrCon(mem_, true);
       casadi_assert_message(flag == IDA_SUCCESS, "IDASetQuadErrCon");
       
@@ -376,19 +381,9 @@ void IdasInternal::initTaping(){
   casadi_assert(!isInitTaping_);
   int flag;
   
-  // Get the number of steos per checkpoint
-  int Nd = getOption("steps_per_checkpoint");
-
-  // Get the interpolation type
-  int interpType;
-  if(getOption("interpolation_type")=="hermite")
-    interpType = IDA_HERMITE;
-  else if(getOption("interpolation_type")=="polynomial")
-    interpType = IDA_POLYNOMIAL;
-  else throw CasadiException("\"interpolation_type\" must be \"hermite\" or \"polynomial\"");
-      
   // Initialize adjoint sensitivities
-  flag = IDAAdjInit(mem_, Nd, interpType);
+  int interpType = hermite_interpolation_ ? IDA_HERMITE : IDA_POLYNOMIAL;
+  flag = IDAAdjInit(mem_, steps_per_checkpoint_, interpType);
   if(flag != IDA_SUCCESS) idas_error("IDAAdjInit",flag);
   
   isInitTaping_ = true;
@@ -418,7 +413,7 @@ void IdasInternal::initAdj(){
   if(flag != IDA_SUCCESS) idas_error("IDASetUserDataB",flag);
 
   // Maximum number of steps
-  IDASetMaxNumStepsB(mem_, whichB_, getOption("max_num_steps").toInt());
+  IDASetMaxNumStepsB(mem_, whichB_, max_num_steps_);
   if(flag != IDA_SUCCESS) idas_error("IDASetMaxNumStepsB",flag);
 
   // Set algebraic components
@@ -456,7 +451,7 @@ void IdasInternal::initAdj(){
   if(flag!=IDA_SUCCESS) idas_error("IDAQuadInitB",flag);
 
   // Quadrature error control
-  if(getOption("quad_err_con").toInt()){
+  if(quad_err_con_){
     flag = IDASetQuadErrConB(mem_, whichB_,true);
     if(flag != IDA_SUCCESS) idas_error("IDASetQuadErrConB",flag);
     
@@ -796,8 +791,7 @@ void IdasInternal::reset(int nsens, int nsensB, int nsensB_store){
   }
 
   // Correct initial conditions, if necessary
-  int calc_ic = getOption("calc_ic");
-  if(calc_ic){
+  if(calc_ic_){
     correctInitialConditions();
   }
 
@@ -832,8 +826,7 @@ void IdasInternal::correctInitialConditions(){
   int icopt = IDA_YA_YDP_INIT; // calculate z and xdot given x
   // int icopt = IDA_Y_INIT; // calculate z and x given zdot and xdot (e.g. start in stationary)
 
-  double t_first = hasSetOption("first_time") ? double(getOption("first_time")) : tf_;
-  int flag = IDACalcIC(mem_, icopt , t_first);
+  int flag = IDACalcIC(mem_, icopt , first_time_);
   if(flag != IDA_SUCCESS) idas_error("IDACalcIC",flag);
 
   // Retrieve the initial values
@@ -914,7 +907,7 @@ void IdasInternal::integrate(double t_out){
   }
     
   // Print statistics
-  if(getOption("print_stats")) printStats(std::cout);
+  if(print_stats_) printStats(std::cout);
   
   if (gather_stats_) {
     long nsteps, nfevals, nlinsetups, netfails;
@@ -961,8 +954,7 @@ void IdasInternal::resetB(){
   }
   
   // Correct initial values for the integration if necessary
-  bool calc_icB = hasSetOption("calc_icB") ?  getOption("calc_icB") : getOption("calc_ic");
-  if(calc_icB){
+  if(calc_icB_){
     log("IdasInternal::resetB","IDACalcICB begin");
     flag = IDACalcICB(mem_, whichB_, t0_, xz_, xzdot_);
     if(flag != IDA_SUCCESS) idas_error("IDACalcICB",flag);
@@ -234,6 +234,12 @@ class IdasInternal : public SundialsInternal{
   // Scaling of cj
   bool cj_scaling_;
 
+  // Use IDACalcIC to get consistent initial conditions for the forward and backward problems
+  bool calc_ic_, calc_icB_;
+
+  // First requested time passed to IDACalcIC
+  double first_time_;
+
   // Disable IDAS internal warning messages
   bool disable_internal_warnings_;
   
@@ -96,6 +96,13 @@ void SundialsInternal::init(){
   exact_jacobian_ = getOption("exact_jacobian");
   exact_jacobianB_ = hasSetOption("exact_jacobianB") ? getOption("exact_jacobianB") && !g_.isNull() : exact_jacobian_;
   max_num_steps_ = getOption("max_num_steps");
+  quad_err_con_ = getOption("quad_err_con");
+  steps_per_checkpoint_ = getOption("steps_per_checkpoint");
+  if(getOption("interpolation_type")=="hermite")
+    hermite_interpolation_ = true;
+  else if(getOption("interpolation_type")=="polynomial")
+    hermite_interpolation_ = false;
+  else throw CasadiException("\"interpolation_type\" must be \"hermite\" or \"polynomial\"");
   finite_difference_fsens_ = getOption("finite_difference_fsens");
   fsens_abstol_ = hasSetOption("fsens_abstol") ? double(getOption("fsens_abstol")) : abstol_;
   fsens_reltol_ = hasSetOption("fsens_reltol") ? double(getOption("fsens_reltol")) : reltol_;
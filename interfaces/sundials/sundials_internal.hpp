@@ -63,6 +63,9 @@ public:
   double fsens_abstol_, fsens_reltol_;
   double abstolB_, reltolB_;
   int max_num_steps_;
+  bool quad_err_con_;
+  int steps_per_checkpoint_;
+  bool hermite_interpolation_;
   bool finite_difference_fsens_;  
   bool stop_at_end_;
   //@}
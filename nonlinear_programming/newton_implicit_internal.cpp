@@ -26,7 +26,6 @@
 #include "symbolic/matrix/matrix_tools.hpp"
 #include "symbolic/fx/mx_function.hpp"
 
-#include "symbolic/profiling.hpp"
 #include "symbolic/casadi_options.hpp"
 
 using namespace std;
@@ -47,14 +46,8 @@ namespace CasADi {
   void NewtonImplicitInternal::solveNonLinear() {
     casadi_log("NewtonImplicitInternal::solveNonLinear:begin");
     
-    // Set up timers for profiling
-    double time_zero;
-    double time_start;
-    double time_stop;
-    if (CasadiOptions::profiling) {
-      time_zero = getRealTime();
-      CasadiOptions::profilingLog  << "start " << this << ":" <<getOption("name") << std::endl; 
-    }
+    // Profiler id, -1 if not profiling
+    int profiling_id = CasadiOptions::profiling ? profilingId() : -1;
     
     // Pass the inputs to J
     for (int i=1;i<jac_.getNumInputs();++i) {
@@ -95,17 +88,9 @@ namespace CasADi {
       // Use Xk to evaluate J
       std::copy(Xk.data().begin(),Xk.data().end(),jac_.input().data().begin());
       
-      if (CasadiOptions::profiling) {
-        time_start = getRealTime(); // Start timer
-      }
-    
+      if(profiling_id>=0) Profiler::begin(profiling_id,0);
       jac_.evaluate();
-      
-      // Write out profiling information
-      if (CasadiOptions::profiling) {
-        time_stop = getRealTime(); // Stop timer
-        CasadiOptions::profilingLog  << double(time_stop-time_start)*1e6 << " ns | " << double(time_stop-time_zero)*1e3 << " ms | " << this << ":" << getOption("name") << ":0|" << jac_.get() << ":" << jac_.getOption("name") << "|evaluate jacobian" << std::endl;
-      }
+      if(profiling_id>=0) Profiler::end(profiling_id,0);
     
       if (monitored("F")) std::cout << "  F = " << F << std::endl;
       if (monitored("normF")) std::cout << "  F (min, max, 1-norm, 2-norm) = " << (*std::min_element(F.data().begin(),F.data().end())) << ", " << (*std::max_element(F.data().begin(),F.data().end())) << ", " << sumAll(fabs(F)) << ", " << sqrt(sumAll(F*F)) << std::endl;
@@ -122,25 +107,14 @@ namespace CasADi {
       // Prepare the linear solver with J
       linsol_.setInput(J,0);
       
-      if (CasadiOptions::profiling) {
-        time_start = getRealTime(); // Start timer
-      }
+      if(profiling_id>=0) Profiler::begin(profiling_id,1);
       linsol_.prepare();
-      // Write out profiling information
-      if (CasadiOptions::profiling) {
-        time_stop = getRealTime(); // Stop timer
-        CasadiOptions::profilingLog  << double(time_stop-time_start)*1e6 << " ns | " << double(time_stop-time_zero)*1e3 << " ms | " << this << ":" << getOption("name") << ":1||prepare linear system" << std::endl;
-      }
+      if(profiling_id>=0) Profiler::end(profiling_id,1);
 
-      if (CasadiOptions::profiling) {
-        time_start = getRealTime(); // Start timer
-      }
       // Solve against F
+      if(profiling_id>=0) Profiler::begin(profiling_id,2);
       linsol_.solve(&F.front(),1,true);
-      if (CasadiOptions::profiling) {
-        time_stop = getRealTime(); // Stop timer
-        CasadiOptions::profilingLog  << double(time_stop-time_start)*1e6 << " ns | " << double(time_stop-time_zero)*1e3 << " ms | " << this << ":" << getOption("name") << ":2||solve linear system" << std::endl;
-      }
+      if(profiling_id>=0) Profiler::end(profiling_id,2);
       
       if (monitored("step")) {
         std::cout << "  step = " << F << std::endl;
@@ -192,5 +166,13 @@ namespace CasADi {
     
   }
 
+  std::vector<std::string> NewtonImplicitInternal::getProfilingNodes() const{
+    std::vector<std::string> ret = ImplicitFunctionInternal::getProfilingNodes();
+    ret[0] = "evaluate jacobian";
+    ret[1] = "prepare linear system";
+    ret[2] = "solve linear system";
+    return ret;
+  }
+
 } // namespace CasADi
 
@@ -54,6 +54,9 @@ namespace CasADi{
 
     /** \brief  Solve the nonlinear system of equations */ 
     virtual void solveNonLinear();
+
+    /** \brief  Descriptions of the profiled sections */
+    virtual std::vector<std::string> getProfilingNodes() const;
   
   protected:
     /// Maximum number of Newton iterations
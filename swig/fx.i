@@ -27,6 +27,7 @@
 #include "symbolic/fx/mx_function.hpp"
 #include "symbolic/fx/linear_solver.hpp"
 #include "symbolic/fx/symbolic_qr.hpp"
+#include "symbolic/fx/block_lu.hpp"
 #include "symbolic/fx/implicit_function.hpp"
 #include "symbolic/fx/integrator.hpp"
 #include "symbolic/fx/simulator.hpp"
@@ -40,6 +41,7 @@
 #include "symbolic/fx/qcqp_solver.hpp"
 #include "symbolic/fx/sdqp_solver.hpp"
 #include "symbolic/fx/external_function.hpp"
+#include "symbolic/fx/compiler_cache.hpp"
 #include "symbolic/fx/parallelizer.hpp"
 #include "symbolic/fx/c_function.hpp"
 #include "symbolic/fx/fx_tools.hpp"
@@ -105,6 +107,7 @@
 %include "symbolic/fx/mx_function.hpp"
 %include "symbolic/fx/linear_solver.hpp"
 %include "symbolic/fx/symbolic_qr.hpp"
+%include "symbolic/fx/block_lu.hpp"
 %include "symbolic/fx/implicit_function.hpp"
 %include "symbolic/fx/integrator.hpp"
 %include "symbolic/fx/simulator.hpp"
@@ -118,6 +121,7 @@
 %include "symbolic/fx/qcqp_solver.hpp"
 %include "symbolic/fx/sdqp_solver.hpp"
 %include "symbolic/fx/external_function.hpp"
+%include "symbolic/fx/compiler_cache.hpp"
 %include "symbolic/fx/parallelizer.hpp"
 %include "symbolic/fx/c_function.hpp"
 %include "symbolic/fx/fx_tools.hpp"
@@ -23,7 +23,9 @@
 %{
 #include "interfaces/lapack/lapack_lu_dense.hpp"
 #include "interfaces/lapack/lapack_qr_dense.hpp"
+#include "interfaces/lapack/lapack_ldl_sparse.hpp"
 %}
 
 %include "interfaces/lapack/lapack_lu_dense.hpp"
 %include "interfaces/lapack/lapack_qr_dense.hpp"
+%include "interfaces/lapack/lapack_ldl_sparse.hpp"
@@ -22,28 +22,24 @@
 
 #include "casadi_options.hpp"
 #include "casadi_exception.hpp"
+#include "profiler.hpp"
 
 namespace CasADi {
 
   bool CasadiOptions::catch_errors_python = true;
   bool CasadiOptions::simplification_on_the_fly = true;
   bool CasadiOptions::profiling = false;
-  std::ofstream CasadiOptions::profilingLog;
+  std::string CasadiOptions::codegen_cache_dir = "";
+  long CasadiOptions::codegen_cache_max_size = 256L*1024L*1024L;
+  int CasadiOptions::num_threads = 0;
+  bool CasadiOptions::debug_option_access = false;
 
   void CasadiOptions::startProfiling(const std::string &filename) {
-    profilingLog.open (filename.c_str(),std::ofstream::out);
-    if (profilingLog.is_open()) {
-      profiling = true;
-    } else {
-      casadi_error("Did not manage to open file " << filename << " for logging.");
-    }
+    Profiler::start(filename);
   }
   
   void CasadiOptions::stopProfiling() {
-    if (profiling) {
-      profilingLog.close();
-    }
-    profiling = false;
+    Profiler::stop();
   }
   
 }
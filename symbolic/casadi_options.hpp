@@ -25,6 +25,16 @@
 
 #include <iostream>
 #include <fstream>
+#include <string>
+
+#ifndef SWIG
+/// Storage class specifier for thread-local variables
+#if defined(_MSC_VER)
+#define CASADI_THREAD_LOCAL __declspec(thread)
+#else
+#define CASADI_THREAD_LOCAL __thread
+#endif
+#endif // SWIG
 
 namespace CasADi {
   /**
@@ -61,11 +71,30 @@ namespace CasADi {
       */
       static bool simplification_on_the_fly;
       
-      /** \brief Stream on which profiling log should be written */
-      static std::ofstream profilingLog;
-      
-      /** \brief flag to indicate if profiling is active */
+      /** \brief flag to indicate if profiling is active, see Profiler */
       static bool profiling;
+
+      /** \brief Directory of the cache of compiled generated code
+      * Default: empty, meaning the subdirectory "casadi_jit" of $TMPDIR (or /tmp)
+      */
+      static std::string codegen_cache_dir;
+
+      /** \brief Maximum total size, in bytes, of the cache of compiled generated code. A nonpositive value means no limit
+      * Default: 256 MB
+      */
+      static long codegen_cache_max_size;
+
+      /** \brief Number of threads in the thread pool used for parallel evaluation, including the calling thread.
+      * Only has an effect before the pool is first used.
+      * Default: 0, meaning the number of processors
+      */
+      static int num_threads;
+
+      /** \brief Issue a warning for each option looked up while a function is being evaluated.
+      * Options used during evaluation should be read into member variables in init(), this flag helps finding those that are not.
+      * Default: false
+      */
+      static bool debug_option_access;
 #endif //SWIG
       // Setter and getter for catch_errors_python
       static void setCatchErrorsPython(bool flag) { catch_errors_python = flag; }
@@ -74,11 +103,28 @@ namespace CasADi {
       // Setter and getter for simplification_on_the_fly
       static void setSimplificationOnTheFly(bool flag) { simplification_on_the_fly = flag; }
       static bool getSimplificationOnTheFly() { return simplification_on_the_fly; }
+
+      // Setter and getter for codegen_cache_dir
+      static void setCodegenCacheDir(const std::string& dir) { codegen_cache_dir = dir; }
+      static std::string getCodegenCacheDir() { return codegen_cache_dir; }
+
+      // Setter and getter for codegen_cache_max_size
+      static void setCodegenCacheMaxSize(long size) { codegen_cache_max_size = size; }
+      static long getCodegenCacheMaxSize() { return codegen_cache_max_size; }
+
+      // Setter and getter for num_threads
+      static void setNumThreads(int n) { num_threads = n; }
+      static int getNumThreads() { return num_threads; }
+
+      // Setter and getter for debug_option_access
+      static void setDebugOptionAccess(bool flag) { debug_option_access = flag; }
+      static bool getDebugOptionAccess() { return debug_option_access; }
       
       /** \brief Start virtual machine profiling
       *
-      *  When profiling is active, each primitive of an MX algorithm is profiling and dumped into the supplied file _filename_
-      *  After the profiling is done, convert the supplied file to a viewable webpage with:
+      *  When profiling is active, the evaluation of each function and each primitive of an MX algorithm is timed.
+      *  When profiling is stopped, the results are written to the supplied file _filename_ in the Chrome trace
+      *  event format, which can be viewed in chrome://tracing, or converted to a webpage with:
       * `python -mcasadi.tools.profilereport -o profiling.html _filename_`
       */
       static void startProfiling(const std::string &filename);
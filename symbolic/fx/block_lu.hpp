@@ -0,0 +1,76 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef BLOCK_LU_HPP
+#define BLOCK_LU_HPP
+
+#include "linear_solver.hpp"
+
+namespace CasADi{
+  
+  // Forward declaration of internal class
+  class BlockLUInternal;
+
+  /** \brief  LinearSolver based on a block triangular decomposition with dense LU factorizations of the diagonal blocks
+      @copydoc LinearSolver_doc
+      
+      The linear system is permuted to lower block triangular form using the Dulmage-Mendelsohn 
+      decomposition of the sparsity pattern. The diagonal blocks are independent and are factorized in
+      parallel by the CasADi thread pool, using dense LU factorizations with partial pivoting. The system is 
+      then solved by block forward substitution (block backward substitution for the transposed system).
+      
+      The solver is efficient when the matrix decomposes into many small blocks, as is typical for 
+      the algebraic equations of DAEs. Blocks larger than "max_dense_block" are factorized by the 
+      sparse linear solver given by the option "sparse_solver", which is then required.
+  */
+  class BlockLU : public LinearSolver{
+  public:
+  
+    /// Default (empty) constructor
+    BlockLU();
+  
+    /// Create a linear solver given a sparsity pattern
+    BlockLU(const CRSSparsity& sp, int nrhs=1);
+
+    /// Access functions of the node
+    BlockLUInternal* operator->();
+
+    /// Const access functions of the node
+    const BlockLUInternal* operator->() const;
+  
+    /// Check if the node is pointing to the right type of object
+    virtual bool checkNode() const;
+
+    /// Static creator function
+#ifdef SWIG
+    %callback("%s_cb");
+#endif
+    static LinearSolver creator(const CRSSparsity& sp, int nrhs){ return BlockLU(sp,nrhs);}
+#ifdef SWIG
+    %nocallback;
+#endif
+
+  };
+
+} // namespace CasADi
+
+#endif //BLOCK_LU_HPP
@@ -0,0 +1,333 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "block_lu_internal.hpp"
+#include "../stl_vector_tools.hpp"
+#include "../matrix/sparsity_tools.hpp"
+#include "../thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+namespace CasADi{
+
+  BlockLUInternal::BlockLUInternal(const CRSSparsity& sparsity, int nrhs) : LinearSolverInternal(sparsity,nrhs){
+    addOption("max_dense_block",       OT_INTEGER,      500,           "Largest diagonal block that is stored and factorized as a dense matrix");
+    addOption("sparse_solver",         OT_LINEARSOLVER, GenericType(), "Sparse linear solver for the diagonal blocks larger than max_dense_block, e.g. CSparse");
+    addOption("sparse_solver_options", OT_DICTIONARY,   GenericType(), "Options to be passed to the sparse linear solver");
+  }
+
+  BlockLUInternal::~BlockLUInternal(){
+  }
+  
+  void BlockLUInternal::init(){
+    // Call the base class initializer
+    LinearSolverInternal::init();
+
+    // Make a BLT transformation of A
+    const CRSSparsity& sp = input(LINSOL_A).sparsity();
+    int n = sp.size1();
+    std::vector<int> rowblock, colblock, coarse_rowblock, coarse_colblock;
+    int nb = sp.dulmageMendelsohn(rowperm_, colperm_, rowblock, colblock, coarse_rowblock, coarse_colblock);
+    rowblock.resize(nb+1);
+    colblock.resize(nb+1);
+    casadi_assert_message(rowblock==colblock, "BlockLUInternal::init: the diagonal blocks are not square, the matrix is structurally singular");
+    block_ = rowblock;
+    
+    // Get the inverted permutations
+    vector<int> inv_rowperm(n), inv_colperm(n);
+    for(int k=0; k<n; ++k){
+      inv_rowperm[rowperm_[k]] = k;
+      inv_colperm[colperm_[k]] = k;
+    }
+    
+    // Block of each row/column of the permuted matrix
+    vector<int> blk(n);
+    for(int b=0; b<nb; ++b){
+      for(int k=block_[b]; k<block_[b+1]; ++k) blk[k] = b;
+    }
+    
+    // Storage for the dense LU factors, the blocks above the threshold are factorized by a sparse linear solver
+    int max_dense_block = getOption("max_dense_block");
+    lu_ptr_.resize(nb+1);
+    lu_ptr_[0] = 0;
+    block_solver_.clear();
+    block_solver_.resize(nb);
+    for(int b=0; b<nb; ++b){
+      int nb_b = block_[b+1]-block_[b];
+      if(nb_b>max_dense_block){
+        casadi_assert_message(hasSetOption("sparse_solver"), "BlockLUInternal::init: diagonal block " << b << " has dimension " << nb_b << ", storing it densely would require " << double(nb_b)*nb_b << " elements. Either set the option \"sparse_solver\" (e.g. to CSparse) or increase \"max_dense_block\" (currently " << max_dense_block << ").");
+        lu_ptr_[b+1] = lu_ptr_[b];
+      } else {
+        lu_ptr_[b+1] = lu_ptr_[b] + nb_b*nb_b;
+      }
+    }
+    lu_.resize(lu_ptr_.back());
+    ipiv_.resize(n);
+    w_.resize(n);
+
+    // Count the nonzeros in the diagonal blocks and left of them
+    const vector<int>& rowind = sp.rowind();
+    const vector<int>& col = sp.col();
+    diag_ptr_.resize(nb+1);
+    fill(diag_ptr_.begin(),diag_ptr_.end(),0);
+    off_rowind_.resize(n+1);
+    fill(off_rowind_.begin(),off_rowind_.end(),0);
+    for(int i=0; i<n; ++i){
+      int bi = blk[inv_rowperm[i]];
+      for(int el=rowind[i]; el<rowind[i+1]; ++el){
+        int bj = blk[inv_colperm[col[el]]];
+        if(bi==bj){
+          diag_ptr_[bi+1]++;
+        } else {
+          casadi_assert_message(bj<bi, "BlockLUInternal::init: the permuted matrix is not lower block triangular");
+          off_rowind_[inv_rowperm[i]+1]++;
+        }
+      }
+    }
+    for(int b=0; b<nb; ++b) diag_ptr_[b+1] += diag_ptr_[b];
+    for(int i=0; i<n; ++i) off_rowind_[i+1] += off_rowind_[i];
+    
+    // Where to put the nonzeros
+    diag_nz_.resize(diag_ptr_.back());
+    diag_dest_.resize(diag_ptr_.back());
+    off_col_.resize(off_rowind_.back());
+    off_nz_.resize(off_rowind_.back());
+    vector<int> diag_fill(diag_ptr_.begin(),diag_ptr_.end()-1);
+    vector<int> off_fill(off_rowind_.begin(),off_rowind_.end()-1);
+    vector<int> diag_row(diag_ptr_.back()), diag_col(diag_ptr_.back());
+    for(int i=0; i<n; ++i){
+      int pi = inv_rowperm[i];
+      int bi = blk[pi];
+      for(int el=rowind[i]; el<rowind[i+1]; ++el){
+        int pj = inv_colperm[col[el]];
+        if(bi==blk[pj]){
+          int k = diag_fill[bi]++;
+          diag_nz_[k] = el;
+          diag_row[k] = pi-block_[bi];
+          diag_col[k] = pj-block_[bi];
+        } else {
+          int k = off_fill[pi]++;
+          off_col_[k] = pj;
+          off_nz_[k] = el;
+        }
+      }
+    }
+    
+    // Destination of the nonzeros of the diagonal blocks, in the dense factors or in the nonzeros of the sparse solvers
+    for(int b=0; b<nb; ++b){
+      int nb_b = block_[b+1]-block_[b];
+      if(lu_ptr_[b]<lu_ptr_[b+1]){
+        for(int k=diag_ptr_[b]; k<diag_ptr_[b+1]; ++k){
+          diag_dest_[k] = lu_ptr_[b] + diag_row[k] + diag_col[k]*nb_b;
+        }
+      } else {
+        vector<int> row(diag_row.begin()+diag_ptr_[b],diag_row.begin()+diag_ptr_[b+1]);
+        vector<int> col(diag_col.begin()+diag_ptr_[b],diag_col.begin()+diag_ptr_[b+1]);
+        vector<int> mapping;
+        CRSSparsity sp_b = sp_triplet(nb_b,nb_b,row,col,mapping);
+        for(int el=0; el<mapping.size(); ++el){
+          diag_dest_[diag_ptr_[b]+mapping[el]] = el;
+        }
+        
+        // Create the sparse linear solver
+        linearSolverCreator sparse_solver_creator = getOption("sparse_solver");
+        block_solver_[b] = sparse_solver_creator(sp_b);
+        if(hasSetOption("sparse_solver_options")){
+          const Dictionary& sparse_solver_options = getOption("sparse_solver_options");
+          block_solver_[b].setOption(sparse_solver_options);
+        }
+        block_solver_[b].init();
+      }
+    }
+    
+    // Factorize the most expensive blocks first
+    vector<pair<double,int> > cost(nb);
+    for(int b=0; b<nb; ++b){
+      double nb_b = block_[b+1]-block_[b];
+      cost[b] = pair<double,int>(-nb_b*nb_b*nb_b,b);
+    }
+    sort(cost.begin(),cost.end());
+    fact_order_.resize(nb);
+    fact_cost_.resize(nb);
+    for(int k=0; k<nb; ++k){
+      fact_order_[k] = cost[k].second;
+      fact_cost_[k] = -cost[k].first;
+    }
+  }
+
+  namespace{
+    // Factorize one diagonal block
+    void blockLUTask(void* user_data, int task, int thread){
+      static_cast<BlockLUInternal*>(user_data)->factorizeBlock(task);
+    }
+  } // namespace
+
+  void BlockLUInternal::prepare(){
+    // Nothing to do if the linear system has not changed since the last factorization
+    if(sameMatrix() && prepared_) return;
+    prepared_ = false;
+    
+    // The diagonal blocks are independent
+    ThreadPool::getInstance().run(blockLUTask,this,fact_order_.size(),getPtr(fact_cost_));
+    
+    // Sucess if reached this point
+    prepared_ = true;
+  }
+  
+  void BlockLUInternal::factorizeBlock(int k){
+    int b = fact_order_[k];
+    int n = block_[b+1]-block_[b];
+    const vector<double>& a = input(LINSOL_A).data();
+
+    // Large block, factorized by the sparse linear solver
+    if(!block_solver_[b].isNull()){
+      vector<double>& a_b = block_solver_[b].input(LINSOL_A).data();
+      for(int el=diag_ptr_[b]; el<diag_ptr_[b+1]; ++el){
+        a_b[diag_dest_[el]] = a[diag_nz_[el]];
+      }
+      block_solver_[b].prepare();
+      return;
+    }
+
+    double* F = getPtr(lu_) + lu_ptr_[b];
+    int* piv = getPtr(ipiv_) + block_[b];
+    
+    // Get the block, dense format
+    fill(F,F+n*n,0.);
+    for(int el=diag_ptr_[b]; el<diag_ptr_[b+1]; ++el){
+      lu_[diag_dest_[el]] = a[diag_nz_[el]];
+    }
+    
+    // LU factorization with partial pivoting
+    for(int j=0; j<n; ++j){
+      // Find the pivot
+      piv[j] = j;
+      double pmax = fabs(F[j+j*n]);
+      for(int i=j+1; i<n; ++i){
+        if(fabs(F[i+j*n])>pmax){
+          piv[j] = i;
+          pmax = fabs(F[i+j*n]);
+        }
+      }
+      if(pmax==0){
+        stringstream ss;
+        ss << "BlockLUInternal::prepare: the matrix is singular, diagonal block " << b << " of size " << n << " could not be factorized";
+        throw CasadiException(ss.str());
+      }
+      
+      // Interchange rows
+      if(piv[j]!=j){
+        for(int c=0; c<n; ++c) swap(F[j+c*n],F[piv[j]+c*n]);
+      }
+      
+      // Eliminate below the pivot
+      for(int i=j+1; i<n; ++i) F[i+j*n] /= F[j+j*n];
+      for(int c=j+1; c<n; ++c){
+        double f = F[j+c*n];
+        if(f==0) continue;
+        for(int i=j+1; i<n; ++i) F[i+c*n] -= F[i+j*n]*f;
+      }
+    }
+  }
+  
+  void BlockLUInternal::solveBlock(int b, double* x, bool transpose){
+    // Large block, note that the linear solvers solve the transposed system when the flag is false
+    if(!block_solver_[b].isNull()){
+      block_solver_[b].solve(x,1,!transpose);
+      return;
+    }
+
+    int n = block_[b+1]-block_[b];
+    const double* F = getPtr(lu_) + lu_ptr_[b];
+    const int* piv = getPtr(ipiv_) + block_[b];
+    if(!transpose){
+      // Interchange rows
+      for(int j=0; j<n; ++j){
+        if(piv[j]!=j) swap(x[j],x[piv[j]]);
+      }
+
+      // Solve L*z = x, L unit lower triangular
+      for(int j=0; j<n; ++j){
+        for(int i=j+1; i<n; ++i) x[i] -= F[i+j*n]*x[j];
+      }
+      
+      // Solve U*x = z
+      for(int j=n-1; j>=0; --j){
+        x[j] /= F[j+j*n];
+        for(int i=0; i<j; ++i) x[i] -= F[i+j*n]*x[j];
+      }
+    } else {
+      // Solve U^T*z = x
+      for(int j=0; j<n; ++j){
+        for(int i=0; i<j; ++i) x[j] -= F[i+j*n]*x[i];
+        x[j] /= F[j+j*n];
+      }
+      
+      // Solve L^T*x = z
+      for(int j=n-1; j>=0; --j){
+        for(int i=j+1; i<n; ++i) x[j] -= F[i+j*n]*x[i];
+      }
+      
+      // Undo the row interchanges
+      for(int j=n-1; j>=0; --j){
+        if(piv[j]!=j) swap(x[j],x[piv[j]]);
+      }
+    }
+  }
+  
+  void BlockLUInternal::solve(double* x, int nrhs, bool transpose){
+    const vector<double>& a = input(LINSOL_A).data();
+    int n = rowperm_.size();
+    int nb = block_.size()-1;
+    for(int rhs=0; rhs<nrhs; ++rhs){
+      double* xr = x + rhs*n;
+      if(transpose){
+        // Solve A*x = b by block forward substitution, the solution overwrites the permuted right hand side block by block
+        for(int i=0; i<n; ++i) w_[i] = xr[rowperm_[i]];
+        for(int b=0; b<nb; ++b){
+          for(int i=block_[b]; i<block_[b+1]; ++i){
+            for(int el=off_rowind_[i]; el<off_rowind_[i+1]; ++el){
+              w_[i] -= a[off_nz_[el]]*w_[off_col_[el]];
+            }
+          }
+          solveBlock(b,getPtr(w_)+block_[b],false);
+        }
+        for(int k=0; k<n; ++k) xr[colperm_[k]] = w_[k];
+      } else {
+        // Solve A^T*x = b, i.e. x*A = b, by block backward substitution
+        for(int k=0; k<n; ++k) w_[k] = xr[colperm_[k]];
+        for(int b=nb-1; b>=0; --b){
+          solveBlock(b,getPtr(w_)+block_[b],true);
+          for(int i=block_[b]; i<block_[b+1]; ++i){
+            for(int el=off_rowind_[i]; el<off_rowind_[i+1]; ++el){
+              w_[off_col_[el]] -= a[off_nz_[el]]*w_[i];
+            }
+          }
+        }
+        for(int i=0; i<n; ++i) xr[rowperm_[i]] = w_[i];
+      }
+    }
+  }
+
+} // namespace CasADi
+
@@ -0,0 +1,95 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef BLOCK_LU_INTERNAL_HPP
+#define BLOCK_LU_INTERNAL_HPP
+
+#include "block_lu.hpp"
+#include "linear_solver_internal.hpp"
+
+namespace CasADi{
+  
+  class BlockLUInternal : public LinearSolverInternal{
+  public:
+    // Constructor
+    BlockLUInternal(const CRSSparsity& sparsity, int nrhs);
+        
+    // Destructor
+    virtual ~BlockLUInternal();
+    
+    /** \brief  Clone */
+    virtual BlockLUInternal* clone() const{ return new BlockLUInternal(*this);}
+
+    // Initialize
+    virtual void init();
+    
+    // Prepare the factorization
+    virtual void prepare();
+
+    // Solve the system of equations
+    virtual void solve(double* x, int nrhs, bool transpose);
+
+    // Factorize the diagonal block with a given index in the factorization order, called from the thread pool
+    void factorizeBlock(int k);
+
+  protected:
+    
+    // Solve with the LU factors of a diagonal block, in-place
+    void solveBlock(int b, double* x, bool transpose);
+
+    // Row and column permutations to block triangular form
+    std::vector<int> rowperm_, colperm_;
+    
+    // Rows and columns of each diagonal block in the permuted matrix
+    std::vector<int> block_;
+
+    // Offset of the dense LU factors of each block in lu_ (column major), no storage for the sparse blocks
+    std::vector<int> lu_ptr_;
+
+    // Linear solvers for the blocks larger than max_dense_block, null for the dense blocks
+    std::vector<LinearSolver> block_solver_;
+    
+    // Nonzeros of A in each diagonal block: a[diag_nz_[k]] goes to lu_[diag_dest_[k]], 
+    // or to nonzero diag_dest_[k] of the sparse solver of the block
+    std::vector<int> diag_ptr_, diag_nz_, diag_dest_;
+    
+    // Nonzeros of A left of the diagonal blocks, by row of the permuted matrix: 
+    // entry k is in column off_col_[k] of the permuted matrix with value a[off_nz_[k]]
+    std::vector<int> off_rowind_, off_col_, off_nz_;
+
+    // Blocks in order of decreasing factorization cost, and the cost
+    std::vector<int> fact_order_;
+    std::vector<double> fact_cost_;
+
+    // Dense LU factors of the diagonal blocks
+    std::vector<double> lu_;
+    
+    // Row interchanges of the partial pivoting, local to each block
+    std::vector<int> ipiv_;
+
+    // Work vector for the solve
+    std::vector<double> w_;
+  };  
+
+} // namespace CasADi
+
+#endif //BLOCK_LU_INTERNAL_HPP
@@ -0,0 +1,307 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "compiler_cache.hpp"
+#include "../casadi_options.hpp"
+#include "../casadi_exception.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#else // _WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#endif // _WIN32
+#ifdef WITH_THREADS
+#include <pthread.h>
+#endif // WITH_THREADS
+
+using namespace std;
+
+namespace CasADi{
+
+  int CompilerCache::num_hits_ = 0;
+  int CompilerCache::num_misses_ = 0;
+  int CompilerCache::num_evictions_ = 0;
+
+  namespace{
+    // Prefix of all files in the cache
+    const string cache_prefix = "casadi_";
+
+#ifdef WITH_THREADS
+    /// Protects the statistics
+    pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif // WITH_THREADS
+
+    /// Scoped lock of the statistics
+    struct StatsLock{
+#ifdef WITH_THREADS
+      StatsLock(){ pthread_mutex_lock(&stats_mutex);}
+      ~StatsLock(){ pthread_mutex_unlock(&stats_mutex);}
+#endif // WITH_THREADS
+    };
+    
+    /// Increase a counter of the statistics
+    void increment(int& counter){
+      StatsLock lock;
+      counter++;
+    }
+
+    /// Create the cache directory if needed and make sure that no other user can place libraries in it
+    void prepareDirectory(const string& dir){
+#ifdef _WIN32
+      _mkdir(dir.c_str());
+#else // _WIN32
+      mkdir(dir.c_str(),0700);
+      
+      // Not a symbolic link, owned by the user and only writable by the user
+      struct stat st;
+      casadi_assert_message(lstat(dir.c_str(),&st)==0, "CompilerCache: cannot access the cache directory " << dir);
+      casadi_assert_message(S_ISDIR(st.st_mode), "CompilerCache: the cache directory " << dir << " is not a directory (symbolic links are not accepted)");
+      casadi_assert_message(st.st_uid==getuid(), "CompilerCache: the cache directory " << dir << " is owned by another user");
+      casadi_assert_message((st.st_mode & (S_IWGRP | S_IWOTH))==0, "CompilerCache: the cache directory " << dir << " is writable by other users");
+#endif // _WIN32
+    }
+  } // namespace
+
+  string CompilerCache::getDirectory(){
+    if(!CasadiOptions::codegen_cache_dir.empty()) return CasadiOptions::codegen_cache_dir;
+#ifdef _WIN32
+    const char* tmpdir = getenv("TEMP");
+    return string(tmpdir==0 ? "." : tmpdir) + "/casadi_jit";
+#else // _WIN32
+    // Per-user directory, in the user's cache directory if defined
+    const char* cachedir = getenv("XDG_CACHE_HOME");
+    if(cachedir!=0 && *cachedir!=0){
+      mkdir(cachedir,0700);
+      return string(cachedir) + "/casadi";
+    }
+    const char* tmpdir = getenv("TMPDIR");
+    stringstream ss;
+    ss << (tmpdir==0 ? "/tmp" : tmpdir) << "/casadi_jit_" << getuid();
+    return ss.str();
+#endif // _WIN32
+  }
+
+  int CompilerCache::getNumHits(){
+    StatsLock lock;
+    return num_hits_;
+  }
+
+  int CompilerCache::getNumMisses(){
+    StatsLock lock;
+    return num_misses_;
+  }
+
+  int CompilerCache::getNumEvictions(){
+    StatsLock lock;
+    return num_evictions_;
+  }
+
+  void CompilerCache::resetStats(){
+    StatsLock lock;
+    num_hits_ = num_misses_ = num_evictions_ = 0;
+  }
+
+  string CompilerCache::compile(const string& code, const string& compiler, bool verbose){
+    // Flag to get a DLL
+#ifdef __APPLE__
+    string dlflag = " -dynamiclib";
+#else // __APPLE__
+    string dlflag = " -shared";
+#endif // __APPLE__
+
+    // Structural hash of the source code and the compiler command (64-bit FNV-1a)
+    unsigned long long h = 14695981039346656037ULL;
+    string key = code + '\n' + compiler + dlflag;
+    for(string::const_iterator it=key.begin(); it!=key.end(); ++it){
+      h ^= static_cast<unsigned char>(*it);
+      h *= 1099511628211ULL;
+    }
+    
+    // Make sure that the cache directory exists and is private
+    string dir = getDirectory();
+    prepareDirectory(dir);
+
+    // File names of the cache entry
+    stringstream ss;
+    ss << hex << setw(16) << setfill('0') << h;
+    string entry = cache_prefix + ss.str();
+    string base = dir + "/" + entry;
+    string cname = base + ".c";
+    string dlname = base + ".so";
+
+    // Look for the entry, the stored source code must match exactly to protect against hash collisions
+    bool hit = false;
+    ifstream dlfile(dlname.c_str());
+    if(dlfile.good()){
+      ifstream cfile(cname.c_str());
+      stringstream stored;
+      stored << cfile.rdbuf();
+      hit = stored.str()==code;
+    }
+    dlfile.close();
+
+    if(hit){
+      increment(num_hits_);
+      if(verbose) cout << "CompilerCache::compile: reusing " << dlname << endl;
+
+#ifndef _WIN32
+      // Mark as recently used
+      utime(dlname.c_str(),0);
+#endif // _WIN32
+      return dlname;
+    }
+    increment(num_misses_);
+    
+    // Temporary file names, unique also between threads and between processes sharing the cache directory
+#ifdef _WIN32
+    static int tmp_counter = 0;
+    ss << "_" << dec << _getpid() << "_" << tmp_counter++;
+    string tmpbase = dir + "/tmp_" + ss.str();
+#else // _WIN32
+    // Reserve a name by creating an empty file, the compiler writes to files with that name as a stem
+    string tmpbase = dir + "/tmp_" + ss.str() + "_XXXXXX";
+    vector<char> tmpbase_buf(tmpbase.begin(),tmpbase.end());
+    tmpbase_buf.push_back(0);
+    int fd = mkstemp(&tmpbase_buf.front());
+    casadi_assert_message(fd!=-1, "CompilerCache::compile: failed to create a temporary file in " << dir);
+    close(fd);
+    tmpbase = &tmpbase_buf.front();
+#endif // _WIN32
+    string tmp_cname = tmpbase + ".c";
+    string tmp_dlname = tmpbase + ".so";
+
+    // Write the source to disk
+    ofstream cfile(tmp_cname.c_str());
+    cfile << code;
+    cfile.close();
+
+    // Compile it
+    string compile_command = compiler + dlflag + " " + tmp_cname + " -o " + tmp_dlname;
+    if(verbose) cout << "CompilerCache::compile: compiling using \"" << compile_command << "\"" << endl;
+    time_t time1 = time(0);
+    int flag = system(compile_command.c_str());
+    time_t time2 = time(0);
+#ifndef _WIN32
+    remove(tmpbase.c_str());
+#endif // _WIN32
+    if(flag!=0){
+      remove(tmp_cname.c_str());
+      remove(tmp_dlname.c_str());
+    }
+    casadi_assert_message(flag==0, "CompilerCache::compile: compilation failed: \"" << compile_command << "\"");
+    if(verbose) cout << "CompilerCache::compile: compiled " << dlname << " in " << difftime(time2,time1) << " s." << endl;
+      
+    // Move into place, other processes never see a partially written library
+    flag = rename(tmp_dlname.c_str(),dlname.c_str());
+    casadi_assert_message(flag==0, "CompilerCache::compile: failed to create " << dlname);
+    flag = rename(tmp_cname.c_str(),cname.c_str());
+    casadi_assert_message(flag==0, "CompilerCache::compile: failed to create " << cname);
+
+    // Enforce the size limit
+    evict(entry);
+    
+    return dlname;
+  }
+
+  void CompilerCache::evict(const string& keep){
+    if(CasadiOptions::codegen_cache_max_size<=0) return;
+#ifndef _WIN32
+    string dir = getDirectory();
+    DIR* d = opendir(dir.c_str());
+    if(d==0) return;
+
+    // Total size and last modification of each entry
+    map<string,pair<time_t,long> > entries;
+    long total_size = 0;
+    for(struct dirent* e = readdir(d); e!=0; e = readdir(d)){
+      string fname = e->d_name;
+      if(fname.compare(0,cache_prefix.size(),cache_prefix)!=0) continue;
+
+      struct stat st;
+      if(stat((dir + "/" + fname).c_str(),&st)!=0) continue;
+
+      // Entry name without the extension
+      string entry = fname.substr(0,fname.rfind('.'));
+      pair<time_t,long>& info = entries[entry];
+      info.first = std::max(info.first,st.st_mtime);
+      info.second += st.st_size;
+      total_size += st.st_size;
+    }
+    closedir(d);
+    
+    // Quick return if within the limits
+    if(total_size <= CasadiOptions::codegen_cache_max_size) return;
+
+    // Sort the entries, least recently used first
+    vector<pair<time_t,string> > lru;
+    for(map<string,pair<time_t,long> >::const_iterator it=entries.begin(); it!=entries.end(); ++it){
+      lru.push_back(make_pair(it->second.first,it->first));
+    }
+    sort(lru.begin(),lru.end());
+    
+    // Remove until within the limit
+    for(vector<pair<time_t,string> >::const_iterator it=lru.begin(); it!=lru.end() && total_size > CasadiOptions::codegen_cache_max_size; ++it){
+      if(it->second==keep) continue;
+      string base = dir + "/" + it->second;
+      remove((base + ".so").c_str());
+      remove((base + ".c").c_str());
+      total_size -= entries[it->second].second;
+      increment(num_evictions_);
+    }
+#endif // _WIN32
+  }
+
+  void CompilerCache::clear(){
+#ifndef _WIN32
+    string dir = getDirectory();
+    DIR* d = opendir(dir.c_str());
+    if(d==0) return;
+    vector<string> fnames;
+    for(struct dirent* e = readdir(d); e!=0; e = readdir(d)){
+      string fname = e->d_name;
+      if(fname.compare(0,cache_prefix.size(),cache_prefix)==0) fnames.push_back(fname);
+    }
+    closedir(d);
+    for(vector<string>::const_iterator it=fnames.begin(); it!=fnames.end(); ++it){
+      remove((dir + "/" + *it).c_str());
+    }
+#else // _WIN32
+    casadi_error("CompilerCache::clear not implemented for Windows");
+#endif // _WIN32
+  }
+
+} // namespace CasADi
@@ -0,0 +1,84 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef COMPILER_CACHE_HPP
+#define COMPILER_CACHE_HPP
+
+#include <string>
+
+namespace CasADi{
+
+  /** \brief On-disk cache of compiled generated code
+  
+      Generated C code is compiled into a dynamically linked library which is stored 
+      in a directory shared between the processes of a user (see CasadiOptions::setCodegenCacheDir).
+      By default, this is $XDG_CACHE_HOME/casadi or $TMPDIR/casadi_jit_<uid>. Since the libraries
+      are loaded into the process, the directory must not be a symbolic link, must be owned by the user
+      and must not be writable by other users, otherwise compile raises an error.
+      The libraries are keyed by a hash of the source code and the compiler command,
+      so that identical functions are only compiled once. The least recently used
+      entries are evicted when the cache grows beyond CasadiOptions::getCodegenCacheMaxSize.
+      
+      This class must never be instantiated. Access its static members directly.
+  */
+  class CompilerCache{
+    private:
+      /// No instances are allowed
+      CompilerCache();
+    public:
+#ifndef SWIG
+      /** \brief Get a dynamically linked library for the source code, compile it if not in the cache
+          Returns the file name of the library. */
+      static std::string compile(const std::string& code, const std::string& compiler, bool verbose=false);
+#endif // SWIG
+
+      /// Directory where the compiled code is stored
+      static std::string getDirectory();
+
+      /// Number of requests that were served from the cache
+      static int getNumHits();
+
+      /// Number of requests that required compilation
+      static int getNumMisses();
+
+      /// Number of entries removed from the cache to enforce the size limit
+      static int getNumEvictions();
+      
+      /// Reset the statistics
+      static void resetStats();
+
+      /// Remove all entries from the cache
+      static void clear();
+
+    private:
+#ifndef SWIG
+      /// Remove the least recently used entries until the cache is within its size limit, never evicting the entry "keep"
+      static void evict(const std::string& keep);
+
+      /// Statistics, protected by a mutex as the cache is used from several threads
+      static int num_hits_, num_misses_, num_evictions_;
+#endif // SWIG
+  };
+
+} // namespace CasADi
+
+#endif // COMPILER_CACHE_HPP
@@ -120,12 +120,43 @@ ExternalFunctionInternal::~ExternalFunctionInternal(){
 }
 
 void ExternalFunctionInternal::evaluate(int nfdir, int nadir){
+  evaluate(getPtr(input_array_),getPtr(output_array_));
+}
+
+void ExternalFunctionInternal::evaluate(const double** x, double** r){
 #ifdef WITH_DL 
-  int flag = evaluate_(getPtr(input_array_),getPtr(output_array_));
+  int flag = evaluate_(x,r);
   if(flag) throw CasadiException("ExternalFunctionInternal: \"evaluate\" failed");
 #endif // WITH_DL 
 }
   
+void ExternalFunctionInternal::evaluate(const double** arg, double** res, int* iw, double* w){
+  // Quick return if all inputs are given
+  int n_in = getNumInputs();
+  if(std::find(arg,arg+n_in,static_cast<const double*>(0))==arg+n_in){
+    evaluate(arg,res);
+    return;
+  }
+  
+  // Inputs that are not given are treated as zero
+  size_t ni, nr;
+  nWork(ni,nr);
+  std::fill(w,w+nr,0.0);
+  std::vector<const double*> argp(arg,arg+n_in);
+  for(int i=0; i<n_in; ++i){
+    if(argp[i]==0) argp[i] = w;
+  }
+  evaluate(getPtr(argp),res);
+}
+
+void ExternalFunctionInternal::nWork(size_t& ni, size_t& nr) const{
+  ni = 0;
+  nr = 0;
+  for(int i=0; i<getNumInputs(); ++i){
+    nr = std::max(nr,size_t(input(i).size()));
+  }
+}
+  
 void ExternalFunctionInternal::init(){
   // Call the init function of the base class
   FXInternal::init();
@@ -51,6 +51,18 @@ class ExternalFunctionInternal : public FXInternal{
 
     /** \brief  Evaluate */
     virtual void evaluate(int nfdir, int nadir);
+
+    /** \brief  Evaluate, reading and writing directly from/to arrays supplied by the caller */
+    void evaluate(const double** x, double** r);
+
+    /** \brief  Evaluate without derivatives, all memory owned by the caller */
+    virtual void evaluate(const double** arg, double** res, int* iw, double* w);
+
+    /** \brief  Get the length of the work vectors needed by evaluate(arg,res,iw,w) */
+    virtual void nWork(size_t& ni, size_t& nr) const;
+
+    /** \brief  Can evaluate(arg,res,iw,w) be called concurrently for the same object */
+    virtual bool isReentrant() const{ return true;}
   
     /** \brief  Initialize */
     virtual void init();
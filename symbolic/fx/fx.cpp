@@ -27,6 +27,7 @@
 #include "../stl_vector_tools.hpp"
 #include "../matrix/matrix_tools.hpp"
 #include "parallelizer.hpp"
+#include "../thread_pool.hpp"
 
 using namespace std;
 
@@ -113,24 +114,136 @@ namespace CasADi{
     return ret;
   }
 
+  namespace{
+    /// Marks an evaluation in progress in the calling thread, see CasadiOptions::debug_option_access
+    struct EvaluationScope{
+      EvaluationScope() : active(CasadiOptions::debug_option_access){ if(active) OptionsFunctionalityNode::evaluation_depth_++;}
+      ~EvaluationScope(){ if(active) OptionsFunctionalityNode::evaluation_depth_--;}
+      bool active;
+    };
+  } // namespace
+
   void FX::evaluate(int nfdir, int nadir){
     assertInit();
     casadi_assert(nfdir<=(*this)->nfdir_);
     casadi_assert(nadir<=(*this)->nadir_);
-    (*this)->evaluate(nfdir,nadir);
+    EvaluationScope scope;
+    if(CasadiOptions::profiling){
+      int id = (*this)->profilingId();
+      Profiler::begin(id,-1,nfdir,nadir);
+      (*this)->evaluate(nfdir,nadir);
+      Profiler::end(id,-1,nfdir,nadir);
+    } else {
+      (*this)->evaluate(nfdir,nadir);
+    }
   }
 
   void FX::evaluateCompressed(int nfdir, int nadir){
     assertInit();
     casadi_assert(nfdir<=(*this)->nfdir_);
     casadi_assert(nadir<=(*this)->nadir_);
-    (*this)->evaluateCompressed(nfdir,nadir);
+    EvaluationScope scope;
+    if(CasadiOptions::profiling){
+      int id = (*this)->profilingId();
+      Profiler::begin(id,-1,nfdir,nadir);
+      (*this)->evaluateCompressed(nfdir,nadir);
+      Profiler::end(id,-1,nfdir,nadir);
+    } else {
+      (*this)->evaluateCompressed(nfdir,nadir);
+    }
   }
 
   void FX::solve(){
     evaluate(0,0);
   }
 
+  void FX::evaluate(const double** arg, double** res, int* iw, double* w){
+    assertInit();
+    EvaluationScope scope;
+    if(CasadiOptions::profiling){
+      int id = (*this)->profilingId();
+      Profiler::begin(id,-1);
+      (*this)->evaluate(arg,res,iw,w);
+      Profiler::end(id,-1);
+    } else {
+      (*this)->evaluate(arg,res,iw,w);
+    }
+  }
+
+  void FX::nWork(size_t& ni, size_t& nr) const{
+    assertInit();
+    (*this)->nWork(ni,nr);
+  }
+
+  namespace{
+    /// Data for evaluating a batch in parallel, each task evaluates a contiguous part of the batch
+    struct BatchData{
+      FXInternal* f;
+      int n, chunk;
+      const double** arg;
+      double** res;
+      std::vector<std::vector<int> > iw;
+      std::vector<std::vector<double> > w;
+    };
+    
+    void batchTask(void* user_data, int task, int thread){
+      BatchData* d = static_cast<BatchData*>(user_data);
+      int j0 = task*d->chunk;
+      int nj = std::min(d->chunk,d->n-j0);
+      std::vector<const double*> arg(d->f->getNumInputs());
+      std::vector<double*> res(d->f->getNumOutputs());
+      for(int ind=0; ind<arg.size(); ++ind){
+        arg[ind] = d->arg[ind]==0 ? 0 : d->arg[ind] + j0*d->f->inputNoCheck(ind).size();
+      }
+      for(int ind=0; ind<res.size(); ++ind){
+        res[ind] = d->res[ind]==0 ? 0 : d->res[ind] + j0*d->f->outputNoCheck(ind).size();
+      }
+      d->f->evaluateBatch(nj,getPtr(arg),getPtr(res),getPtr(d->iw[thread]),getPtr(d->w[thread]));
+    }
+  } // namespace
+
+  void FX::evaluateBatch(int n, const double** arg, double** res, bool parallel){
+    assertInit();
+    EvaluationScope scope;
+    int id = CasadiOptions::profiling ? (*this)->profilingId() : -1;
+    if(id>=0) Profiler::begin(id,-1);
+    
+    // Divide the batch into a few tasks per thread
+    ThreadPool& pool = ThreadPool::getInstance();
+    int nthread = parallel && isReentrant() ? pool.getNumThreads() : 1;
+    int ntask = std::max(1,std::min(n,4*nthread));
+    if(ntask<2 || nthread<2){
+      nthread = 1;
+      ntask = 1;
+    }
+    BatchData d;
+    d.f = static_cast<FXInternal*>(get());
+    d.n = n;
+    d.chunk = std::max(1,(n+ntask-1)/ntask);
+    ntask = std::max(1,(n+d.chunk-1)/d.chunk);
+    d.arg = arg;
+    d.res = res;
+    
+    // Work vectors for each thread
+    size_t ni, nr;
+    (*this)->nWorkBatch(d.chunk,ni,nr);
+    d.iw.resize(nthread,std::vector<int>(ni));
+    d.w.resize(nthread,std::vector<double>(nr));
+
+    // Evaluate
+    if(nthread==1){
+      for(int task=0; task<ntask; ++task) batchTask(&d,task,0);
+    } else {
+      pool.run(batchTask,&d,ntask);
+    }
+    if(id>=0) Profiler::end(id,-1);
+  }
+
+  bool FX::isReentrant() const{
+    assertInit();
+    return (*this)->isReentrant();
+  }
+
   int FX::getNumScalarInputs() const{
     return (*this)->getNumScalarInputs();
   }
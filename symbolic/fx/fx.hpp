@@ -156,6 +156,30 @@ namespace CasADi{
   
     /// the same as evaluate(0,0)
     void solve();
+
+#ifndef SWIG
+    /** \brief  Evaluate without derivatives, all memory owned by the caller
+     * arg[i] points to the nonzeros of input i (a null pointer is treated as zero) and res[i] to the
+     * nonzeros of output i (a null pointer means that the output is not needed). The work vectors iw and w
+     * must have at least the lengths returned by nWork. If isReentrant() returns true, the function
+     * object is only read, so a single initialized instance may be evaluated concurrently from several
+     * threads, each thread supplying its own arguments, results and work vectors.
+     */
+    void evaluate(const double** arg, double** res, int* iw, double* w);
+    
+    /** \brief  Get the length of the integer and real work vectors needed by evaluate(arg,res,iw,w) */
+    void nWork(size_t& ni, size_t& nr) const;
+
+    /** \brief  Evaluate n times without derivatives, all memory owned by the caller
+     * The inputs and outputs of the evaluations are stored one after another: arg[i] + j*input(i).size() points to
+     * the nonzeros of input i of evaluation j, likewise for the outputs. Null pointers are treated as in evaluate(arg,res,iw,w).
+     * If parallel is true and the function is reentrant, the evaluations are split across the threads of the thread pool.
+     */
+    void evaluateBatch(int n, const double** arg, double** res, bool parallel=false);
+#endif // SWIG
+
+    /** \brief  Can evaluate(arg,res,iw,w) be called concurrently for the same function object */
+    bool isReentrant() const;
     
     //@{
     /** \brief Generate a Jacobian function of output oind with respect to input iind
@@ -31,9 +31,10 @@
 #include "../matrix/sparsity_tools.hpp"
 #include "external_function.hpp"
 #include "derivative.hpp"
+#include "numeric_jacobian.hpp"
+#include "compiler_cache.hpp"
 
 #include "../casadi_options.hpp"
-#include "../profiling.hpp"
 
 #ifdef WITH_DL 
 #include <cstdlib>
@@ -56,6 +57,9 @@ namespace CasADi{
     addOption("numeric_jacobian",         OT_BOOLEAN,             false,          "Calculate Jacobians numerically (using directional derivatives) rather than with the built-in method");
     addOption("numeric_hessian",          OT_BOOLEAN,             false,          "Calculate Hessians numerically (using directional derivatives) rather than with the built-in method");
     addOption("ad_mode",                  OT_STRING,              "automatic",    "How to calculate the Jacobians.","forward: only forward mode|reverse: only adjoint mode|automatic: a heuristic decides which is more appropriate");
+    addOption("parallel_coloring",        OT_BOOLEAN,             false,          "Use the thread pool for the graph coloring when compressing Jacobians and Hessians (see CasadiOptions.setNumThreads)");
+    addOption("parallel_jacobian",        OT_BOOLEAN,             false,          "Distribute the directional derivative sweeps of numerically calculated Jacobians (see \"numeric_jacobian\") over the thread pool, with one copy of the function per thread. Only for reentrant functions, otherwise the sweeps are sequential");
+    addOption("sparsity_width",           OT_INTEGER,             8,              "Number of 64-bit words per nonzero used when propagating sparsity patterns, for classes that support it");
     addOption("jacobian_generator",       OT_JACOBIANGENERATOR,   GenericType(),  "Function pointer that returns a Jacobian function given a set of desired Jacobian blocks, overrides internal routines");
     addOption("sparsity_generator",       OT_SPARSITYGENERATOR,   GenericType(),  "Function that provides sparsity for a given input output block, overrides internal routines");
     addOption("user_data",                OT_VOIDPTR,             GenericType(),  "A user-defined field that can be used to identify the function or pass additional information");
@@ -76,6 +80,12 @@ namespace CasADi{
 
 
   FXInternal::~FXInternal(){
+    // No other thread can use the function when it is destroyed
+    if(profiling_.session==Profiler::getSession()) Profiler::unregisterFunction(this);
+  }
+
+  int FXInternal::registerProfiling(){
+    return Profiler::registerFunction(this,getOption("name"),getProfilingNodes(),profiling_.session,profiling_.id);
   }
 
   void FXInternal::deepCopyMembers(std::map<SharedObjectNode*,SharedObject>& already_copied){
@@ -510,6 +520,119 @@ namespace CasADi{
     return ret;
   }
 
+  CRSSparsity FXInternal::getJacSparsityWide(int iind, int oind, int nw){
+    // Number of nonzero inputs
+    int nz_in = input(iind).size();
+
+    // Number of nonzero outputs
+    int nz_out = output(oind).size();
+
+    // Number of directions per sweep
+    int ndir = nw*bvec_size;
+
+    // Number of forward and adjoint sweeps we must make
+    int nsweep_fwd = (nz_in+ndir-1)/ndir;
+    int nsweep_adj = (nz_out+ndir-1)/ndir;
+
+    // Use forward mode?
+    bool use_fwd = spCanEvaluateWide(true) && (!spCanEvaluateWide(false) || nsweep_fwd <= nsweep_adj);
+
+    // Override default behavior?
+    if(getOption("ad_mode") == "forward"){
+      use_fwd = true;
+    } else if(getOption("ad_mode") == "reverse"){
+      use_fwd = false;
+    }
+    casadi_assert(spCanEvaluateWide(use_fwd));
+
+    // Dedicated bit arrays for the inputs and outputs, nw words per nonzero
+    vector<vector<bvec_t> > arg_bits(getNumInputs()), res_bits(getNumOutputs());
+    vector<bvec_t*> arg(getNumInputs()), res(getNumOutputs());
+    for(int ind=0; ind<getNumInputs(); ++ind){
+      arg_bits[ind].resize(nw*input(ind).size(),bvec_t(0));
+      arg[ind] = getPtr(arg_bits[ind]);
+    }
+    for(int ind=0; ind<getNumOutputs(); ++ind){
+      res_bits[ind].resize(nw*output(ind).size(),bvec_t(0));
+      res[ind] = getPtr(res_bits[ind]);
+    }
+
+    // Get seeds and sensitivities
+    bvec_t* seed_v = use_fwd ? arg[iind] : res[oind];
+    bvec_t* sens_v = use_fwd ? res[oind] : arg[iind];
+
+    // Number of sweeps needed
+    int nsweep = use_fwd ? nsweep_fwd : nsweep_adj;
+
+    // The number of zeros in the seed and sensitivity directions
+    int nz_seed = use_fwd ? nz_in  : nz_out;
+    int nz_sens = use_fwd ? nz_out : nz_in;
+
+    // Print
+    if(verbose()){
+      std::cout << "FXInternal::getJacSparsity: using " << (use_fwd ? "forward" : "adjoint") << " mode with " << nw << " words per nonzero: ";
+      std::cout << nsweep << " sweeps needed for " << nz_seed << " directions" << endl;
+    }
+
+    // Temporary vectors
+    std::vector<int> jrow, jcol;
+
+    // Loop over the variables, ndir variables at a time
+    for(int s=0; s<nsweep; ++s){
+
+      // Nonzero offset
+      int offset = s*ndir;
+
+      // Number of local seed directions
+      int ndir_local = std::min(ndir,nz_seed-offset);
+
+      // Direction i is bit i%bvec_size of word i/bvec_size
+      for(int i=0; i<ndir_local; ++i){
+        seed_v[(offset+i)*nw + i/bvec_size] |= bvec_t(1) << (i%bvec_size);
+      }
+
+      // Propagate the dependencies
+      spEvaluateWide(use_fwd,nw,getPtr(arg),getPtr(res));
+
+      // Loop over the nonzeros of the output
+      for(int el=0; el<nz_sens; ++el){
+        bvec_t* spsens = sens_v + el*nw;
+        for(int w=0; w<nw; ++w){
+
+          // If there is a dependency in any of the directions
+          if(spsens[w]!=0){
+
+            // Loop over seed directions
+            for(int i=0; i<bvec_size; ++i){
+
+              // If dependents on the variable
+              if((bvec_t(1) << i) & spsens[w]){
+                // Add to pattern
+                jrow.push_back(el);
+                jcol.push_back(offset + w*bvec_size + i);
+              }
+            }
+
+            // Clear the sensitivities for the next sweep
+            if(!use_fwd) spsens[w] = 0;
+          }
+        }
+      }
+
+      // Remove the seeds
+      fill_n(seed_v+offset*nw, ndir_local*nw, bvec_t(0));
+    }
+
+    // Construct sparsity pattern
+    CRSSparsity ret = sp_triplet(nz_out, nz_in,use_fwd ? jrow : jcol, use_fwd ? jcol : jrow);
+
+    casadi_log("Formed Jacobian sparsity pattern (dimension " << ret.shape() << ", " << ret.size() << " nonzeros, " << 100*double(ret.size())/double(ret.size1())/double(ret.size2()) << " \% nonzeros).");
+    casadi_log("FXInternal::getJacSparsity end ");
+
+    // Return sparsity pattern
+    return ret;
+  }
+
   CRSSparsity FXInternal::getJacSparsityHierarchicalSymm(int iind, int oind){
     casadi_assert(spCanEvaluate(true));
 
@@ -663,6 +786,9 @@ namespace CasADi{
             makeSparse(duplicates);
             SubMatrix<Matrix<int>,CRSSparsity,int> temp(lookup,duplicates.sparsity(),0);
             temp = -bvec_size;
+            const vector<int>& lookup_rowind = lookup.rowind();
+            const vector<int>& lookup_bit = lookup.col();
+            const vector<int>& lookup_offset = lookup.data();
               
             // Propagate the dependencies
             spEvaluate(true);
@@ -677,12 +803,16 @@ namespace CasADi{
               for (int fri=fine_lookup[coarse[cri]];fri<fine_lookup[coarse[cri+1]];++fri) {
                 // Lump individual sensitivities together into fine block
                 bvec_or(sens_v,spsens,fine[fri],fine[fri+1]);
+
+                // Next iteration if no sparsity
+                if (!spsens) continue;
   
-                // Loop over all bvec_bits
-                for (int bvec_i=0;bvec_i<bvec_size;++bvec_i) {
+                // Loop over the bvec_bits that are seeded for the current coarse block row
+                for (int el=lookup_rowind[cri];el<lookup_rowind[cri+1];++el) {
+                  int bvec_i = lookup_bit[el];
                   if (spsens & (bvec_t(1) << bvec_i)) {
                     // if dependency is found, add it to the new sparsity pattern
-                    int lk = lookup.elem(cri,bvec_i);
+                    int lk = lookup_offset[el];
                     if (lk>-bvec_size) {
                       jcol.push_back(bvec_i+lk);
                       jrow.push_back(fri);
@@ -954,6 +1084,9 @@ namespace CasADi{
               
             // Construct lookup table
             IMatrix lookup = IMatrix::sparse(lookup_row,lookup_col,lookup_value,coarse_row.size(),bvec_size);
+            const vector<int>& lookup_rowind = lookup.rowind();
+            const vector<int>& lookup_bit = lookup.col();
+            const vector<int>& lookup_offset = lookup.data();
 
             // Propagate the dependencies
             spEvaluate(use_fwd);
@@ -972,11 +1105,12 @@ namespace CasADi{
                 // Next iteration if no sparsity
                 if (!spsens) continue;
   
-                // Loop over all bvec_bits
-                for (int bvec_i=0;bvec_i<bvec_size;++bvec_i) {
+                // Loop over the bvec_bits that are seeded for the current coarse block row
+                for (int el=lookup_rowind[cri];el<lookup_rowind[cri+1];++el) {
+                  int bvec_i = lookup_bit[el];
                   if (spsens & bvec_lookup[bvec_i]) {
                     // if dependency is found, add it to the new sparsity pattern
-                    jcol.push_back(bvec_i+lookup.elem(cri,bvec_i));
+                    jcol.push_back(bvec_i+lookup_offset[el]);
                     jrow.push_back(fri);
                   }
                 }
@@ -1037,7 +1171,21 @@ namespace CasADi{
     // Check if we are able to propagate dependencies through the function
     if(spCanEvaluate(true) || spCanEvaluate(false)){
 
-      if (input(iind).size()>3*bvec_size && output(oind).size()>3*bvec_size) {
+      // Number of seed directions for the wide propagation, if available
+      int nz_wide = std::numeric_limits<int>::max();
+      if(spCanEvaluateWide(true) && getOption("ad_mode") != "reverse"){
+        nz_wide = input(iind).size();
+      }
+      if(spCanEvaluateWide(false) && getOption("ad_mode") != "forward"){
+        nz_wide = std::min(nz_wide,output(oind).size());
+      }
+
+      // Use the wide propagation unless so many sweeps are needed that the hierarchical approach is likely faster
+      const int max_sweeps_wide = 32;
+      int nw = getOption("sparsity_width");
+      if (nw>1 && nz_wide<=max_sweeps_wide*nw*bvec_size) {
+        return getJacSparsityWide(iind, oind, nw);
+      } else if (input(iind).size()>3*bvec_size && output(oind).size()>3*bvec_size) {
         if (symmetric) {
           return getJacSparsityHierarchicalSymm(iind, oind);
         } else {
@@ -1143,12 +1291,15 @@ namespace CasADi{
       casadi_error("FXInternal::jac: Unknown ad_mode \"" << getOption("ad_mode") << "\". Possible values are \"forward\", \"reverse\" and \"automatic\".");
     }
   
+    // Use parallel colorings?
+    bool parallel_coloring = getOption("parallel_coloring");
+  
     // Get seed matrices by graph coloring
     if(symmetric){
   
       // Star coloring if symmetric
       log("FXInternal::getPartition starColoring");
-      D1 = A.starColoring();
+      D1 = parallel_coloring ? A.starColoringParallel() : A.starColoring();
       casadi_log("Star coloring completed: " << D1.size1() << " directional derivatives needed (" << A.size2() << " without coloring).");
     
     } else {
@@ -1175,7 +1326,7 @@ namespace CasADi{
         // Perform the coloring
         if(fwd){
           log("FXInternal::getPartition unidirectional coloring (forward mode)");
-          D1 = AT.unidirectionalColoring(A,best_coloring);
+          D1 = parallel_coloring ? AT.unidirectionalColoringParallel(A,best_coloring) : AT.unidirectionalColoring(A,best_coloring);
           if(D1.isNull()){
             if(verbose()) cout << "Forward mode coloring interrupted (more than " << best_coloring << " needed)." << endl; 
           } else {
@@ -1186,7 +1337,7 @@ namespace CasADi{
         } else {
           log("FXInternal::getPartition unidirectional coloring (adjoint mode)");
           int max_colorings_to_test = best_coloring/adj_penalty;
-          D2 = A.unidirectionalColoring(AT,max_colorings_to_test);        
+          D2 = parallel_coloring ? A.unidirectionalColoringParallel(AT,max_colorings_to_test) : A.unidirectionalColoring(AT,max_colorings_to_test);        
           if(D2.isNull()){
             if(verbose()) cout << "Adjoint mode coloring interrupted (more than " << max_colorings_to_test << " needed)." << endl; 
           } else {
@@ -1201,6 +1352,41 @@ namespace CasADi{
     log("FXInternal::getPartition end");
   }
 
+  void FXInternal::evaluate(const double** arg, double** res, int* iw, double* w){
+    // Pass the inputs
+    for(int ind=0; ind<getNumInputs(); ++ind){
+      Matrix<double>& v = inputNoCheck(ind);
+      if(arg[ind]==0){
+        v.setZero();
+      } else {
+        copy(arg[ind],arg[ind]+v.size(),v.begin());
+      }
+    }
+    
+    // Evaluate using the function object
+    evaluate(0,0);
+    
+    // Get the outputs
+    for(int ind=0; ind<getNumOutputs(); ++ind){
+      const Matrix<double>& v = outputNoCheck(ind);
+      if(res[ind]!=0) copy(v.begin(),v.end(),res[ind]);
+    }
+  }
+
+  void FXInternal::evaluateBatch(int n, const double** arg, double** res, int* iw, double* w){
+    vector<const double*> argj(getNumInputs());
+    vector<double*> resj(getNumOutputs());
+    for(int j=0; j<n; ++j){
+      for(int ind=0; ind<argj.size(); ++ind){
+        argj[ind] = arg[ind]==0 ? 0 : arg[ind] + j*inputNoCheck(ind).size();
+      }
+      for(int ind=0; ind<resj.size(); ++ind){
+        resj[ind] = res[ind]==0 ? 0 : res[ind] + j*outputNoCheck(ind).size();
+      }
+      evaluate(getPtr(argj),getPtr(resj),iw,w);
+    }
+  }
+
   void FXInternal::evaluateCompressed(int nfdir, int nadir){
     // Counter for compressed forward directions
     int nfdir_compressed=0;
@@ -1492,6 +1678,10 @@ namespace CasADi{
     }
   }
 
+  void FXInternal::spEvaluateWide(bool fwd, int nw, bvec_t** arg, bvec_t** res){
+    casadi_error("FXInternal::spEvaluateWide not defined for class " << typeid(*this).name());
+  }
+
   void FXInternal::spEvaluateViaJacSparsity(bool fwd){
     if(fwd) {
       // Clear the outputs
@@ -1613,6 +1803,8 @@ namespace CasADi{
 
     // Generate if not already cached
     if(ret.isNull()){
+      // Not part of the evaluation, also when the derivative is first needed by one
+      NoEvaluationScope scope;
 
       // Get the number of scalar inputs and outputs
       int num_in_scalar = getNumScalarInputs();
@@ -1788,6 +1980,12 @@ namespace CasADi{
   }
 
   FX FXInternal::getNumericJacobian(int iind, int oind, bool compact, bool symmetric){
+    // Evaluate the directional derivative sweeps in parallel
+    if(!symmetric && bool(getOption("parallel_jacobian"))){
+      return NumericJacobian(shared_from_this<FX>(),iind,oind,compact);
+    }
+
+    // Create the Jacobian from calls to the function
     vector<MX> arg = symbolicInput();
     vector<MX> res = shared_from_this<FX>().call(arg);
     FX f = MXFunction(arg,res);
@@ -1855,11 +2053,20 @@ namespace CasADi{
   }
     
   void FXInternal::generateCode(const string& src_name){
-    assertInit();
-    
     // Create the c source file
     std::ofstream cfile;
     cfile.open (src_name.c_str());
+    
+    // Generate the code
+    generateCode(cfile);
+
+    // Close the results file
+    cfile.close();
+  }
+
+  void FXInternal::generateCode(std::ostream& cfile){
+    assertInit();
+    
     cfile.precision(std::numeric_limits<double>::digits10+2);
     cfile << std::scientific; // This is really only to force a decimal dot, would be better if it can be avoided
 
@@ -1964,10 +2171,6 @@ namespace CasADi{
       cfile << "  return 0;" << std::endl;
       cfile << "}" << std::endl << std::endl;
     }
-
-
-    // Close the results file
-    cfile.close();
   }
 
   void FXInternal::generateFunction(std::ostream &stream, const std::string& fname, const std::string& input_type, const std::string& output_type, const std::string& type, CodeGenerator& gen) const{
@@ -2101,49 +2304,22 @@ namespace CasADi{
   FX FXInternal::dynamicCompilation(FX f, std::string fname, std::string fdescr, std::string compiler){
 #ifdef WITH_DL 
 
-    // Flag to get a DLL
-#ifdef __APPLE__
-    string dlflag = " -dynamiclib";
-#else // __APPLE__
-    string dlflag = " -shared";
-#endif // __APPLE__
-
     // Check if f is initialized
     bool f_is_init = f.isInit();
     if(!f_is_init) f.init();
 
-    // Filenames
-    string cname = fname + ".c";
-    string dlname = fname + ".so";
-  
-    // Remove existing files, if any
-    string rm_command = "rm -rf " + cname + " " + dlname;
-    int flag = system(rm_command.c_str());
-    casadi_assert_message(flag==0, "Failed to remove old source");
-
     // Codegen it
-    f.generateCode(cname);
+    stringstream src;
+    f->generateCode(src);
     if(verbose_){
-      cout << "Generated c-code for " << fdescr << " (" << cname << ")" << endl;
+      cout << "Generated c-code for " << fdescr << endl;
     }
   
-    // Compile it
-    string compile_command = compiler + " " + dlflag + " " + cname + " -o " + dlname;
-    if(verbose_){
-      cout << "Compiling " << fdescr <<  " using \"" << compile_command << "\"" << endl;
-    }
-
-    time_t time1 = time(0);
-    flag = system(compile_command.c_str());
-    time_t time2 = time(0);
-    double comp_time = difftime(time2,time1);
-    casadi_assert_message(flag==0, "Compilation failed");
-    if(verbose_){
-      cout << "Compiled " << fdescr << " (" << dlname << ") in " << comp_time << " s."  << endl;
-    }
+    // Compile it, unless it is available in the cache
+    string dlname = CompilerCache::compile(src.str(),compiler,verbose_);
 
     // Load it
-    ExternalFunction f_gen("./" + dlname);
+    ExternalFunction f_gen(dlname);
     f_gen.setOption("number_of_fwd_dir",0);
     f_gen.setOption("number_of_adj_dir",0);
     f_gen.setOption("name",fname + "_gen");
@@ -2413,6 +2589,43 @@ namespace CasADi{
     }
   }
 
+  void FXInternal::nWork(MXNode* node, size_t& ni, size_t& nr){
+    // Work vectors of the function itself
+    nWork(ni,nr);
+
+    // Add memory for all inputs with nonmatching sparsity
+    for(int i=0; i<getNumInputs(); ++i){
+      if(!node->dep(i).isNull() && node->dep(i).sparsity()!=input(i).sparsity()){
+        nr += input(i).size();
+      }
+    }
+  }
+
+  void FXInternal::evaluateD(MXNode* node, const double** arg, double** res, int* itmp, double* rtmp){
+    // Work vectors of the function itself
+    size_t ni_fcn, nr_fcn;
+    nWork(ni_fcn,nr_fcn);
+    double* rtmp_arg = rtmp + nr_fcn;
+
+    // Project the inputs with nonmatching sparsity
+    int num_in = getNumInputs();
+    std::vector<const double*> argp(arg,arg+num_in);
+    for(int i=0; i<num_in; ++i){
+      if(!node->dep(i).isNull() && node->dep(i).sparsity()!=input(i).sparsity()){
+        const CRSSparsity& sp = input(i).sparsity();
+        if(arg[i]!=0){
+          std::fill(rtmp_arg,rtmp_arg+sp.size(),0.0);
+          sp.set(rtmp_arg,arg[i],node->dep(i).sparsity());
+          argp[i] = rtmp_arg;
+        }
+        rtmp_arg += sp.size();
+      }
+    }
+    
+    // Evaluate
+    evaluate(getPtr(argp),res,itmp,rtmp);
+  }
+
   void FXInternal::evaluateSX(MXNode* node, const SXMatrixPtrV& arg, SXMatrixPtrV& res,
                               const SXMatrixPtrVV& fseed, SXMatrixPtrVV& fsens,
                               const SXMatrixPtrVV& aseed, SXMatrixPtrVV& asens, std::vector<int>& itmp, std::vector<SX>& rtmp) {
@@ -2440,17 +2653,7 @@ namespace CasADi{
   void FXInternal::evaluateD(MXNode* node, const DMatrixPtrV& arg, DMatrixPtrV& res,
                              const DMatrixPtrVV& fseed, DMatrixPtrVV& fsens,
                              const DMatrixPtrVV& aseed, DMatrixPtrVV& asens, std::vector<int>& itmp, std::vector<double>& rtmp) {
-                             
-    // Set up timers for profiling
-    double time_zero;
-    double time_start;
-    double time_stop;
-    double time_offset=0;
-    
-    if (CasadiOptions::profiling) {
-      time_start = getRealTime(); // Start timer
-    }
-  
+
     // Number of inputs and outputs
     int num_in = getNumInputs();
     int num_out = getNumOutputs();
@@ -2510,13 +2713,14 @@ namespace CasADi{
         }
       }
       
-      if (CasadiOptions::profiling) {
-        time_zero = getRealTime();
-      }
       // Evaluate
-      evaluate(nfdir_f_batch, nadir_f_batch);
-      if (CasadiOptions::profiling) {
-        time_offset += getRealTime() - time_zero;
+      if(CasadiOptions::profiling){
+        int id = profilingId();
+        Profiler::begin(id,-1,nfdir_f_batch,nadir_f_batch);
+        evaluate(nfdir_f_batch, nadir_f_batch);
+        Profiler::end(id,-1,nfdir_f_batch,nadir_f_batch);
+      } else {
+        evaluate(nfdir_f_batch, nadir_f_batch);
       }
       
       // Get the outputs if first evaluation
@@ -2554,13 +2758,6 @@ namespace CasADi{
 
     // Clear adjoint seeds
     MXNode::clearVector(aseed);
-    
-    // Write out profiling information
-    if (CasadiOptions::profiling) {
-      time_stop = getRealTime();
-      CasadiOptions::profilingLog  << "overhead " << this << ":" <<getOption("name") << "|" << double(time_stop-time_start-time_offset)*1e6 << " ns" << std::endl; 
-    }
-    
   }
 
   void FXInternal::printPart(const MXNode* node, std::ostream &stream, int part) const {
@@ -27,6 +27,7 @@
 #include "../weak_ref.hpp"
 #include <set>
 #include "code_generator.hpp"
+#include "../profiler.hpp"
 
 // This macro is for documentation purposes
 #define INPUTSCHEME(name)
@@ -61,6 +62,23 @@ namespace CasADi{
     /** \brief  Evaluate with directional derivative compression */
     void evaluateCompressed(int nfdir, int nadir);
 
+    /** \brief  Evaluate numerically without derivatives, all memory owned by the caller
+        The default implementation passes the data via the input and output vectors of the class and is not reentrant. */
+    virtual void evaluate(const double** arg, double** res, int* iw, double* w);
+
+    /** \brief  Get the length of the work vectors needed by evaluate(arg,res,iw,w) */
+    virtual void nWork(size_t& ni, size_t& nr) const{ ni=0; nr=0;}
+
+    /** \brief  Can evaluate(arg,res,iw,w) be called concurrently for the same object */
+    virtual bool isReentrant() const{ return false;}
+
+    /** \brief  Evaluate n times without derivatives, see FX::evaluateBatch
+        The default implementation calls evaluate(arg,res,iw,w) for each evaluation. */
+    virtual void evaluateBatch(int n, const double** arg, double** res, int* iw, double* w);
+
+    /** \brief  Get the length of the work vectors needed by evaluateBatch for n evaluations */
+    virtual void nWorkBatch(int n, size_t& ni, size_t& nr) const{ nWork(ni,nr);}
+
     /** \brief Initialize
         Initialize and make the object ready for setting arguments and evaluation. This method is typically called after setting options but before evaluating. 
         If passed to another class (in the constructor), this class should invoke this function when initialized. */
@@ -84,7 +102,17 @@ namespace CasADi{
 
     /** \brief  Reset the sparsity propagation */
     virtual void spInit(bool fwd){}
-    
+
+    /** \brief  Is the class able to propagate several bit words per nonzero, cf. spEvaluateWide? */
+    virtual bool spCanEvaluateWide(bool fwd){ return false;}
+
+    /** \brief  Propagate the sparsity pattern with nw bit words per nonzero
+        Unlike spEvaluate, the seeds and sensitivities are passed in dedicated bit arrays rather than in the
+        inputs and outputs. The words of nonzero k of input (output) i are arg[i][k*nw] to arg[i][k*nw+nw-1]
+        (res[i][k*nw] to res[i][k*nw+nw-1]). In reverse mode, the seeds in res are left untouched and the
+        sensitivities are added to arg. */
+    virtual void spEvaluateWide(bool fwd, int nw, bvec_t** arg, bvec_t** res);
+
     /** \brief  Evaluate symbolically, SX type, possibly nonmatching sparsity patterns */
     virtual void evalSX(const std::vector<SXMatrix>& arg, std::vector<SXMatrix>& res, 
                         const std::vector<std::vector<SXMatrix> >& fseed, std::vector<std::vector<SXMatrix> >& fsens, 
@@ -170,6 +198,9 @@ namespace CasADi{
     /** \brief  Print to a c file */
     virtual void generateCode(const std::string& filename);
 
+    /** \brief  Print to a stream */
+    void generateCode(std::ostream& cfile);
+
     /** \brief Generate code for function inputs and outputs */
     void generateIO(CodeGenerator& gen);
 
@@ -217,7 +248,10 @@ namespace CasADi{
     
     /// A flavour of getJacSparsity without any magic
     CRSSparsity getJacSparsityPlain(int iind, int oind);
-    
+
+    /// A flavour of getJacSparsityPlain that propagates nw bit words per nonzero using spEvaluateWide
+    CRSSparsity getJacSparsityWide(int iind, int oind, int nw);
+
     /// A flavour of getJacSparsity that does hierachical block structure recognition
     CRSSparsity getJacSparsityHierarchical(int iind, int oind);
     
@@ -273,6 +307,15 @@ namespace CasADi{
     inline Matrix<double>& adjSensNoCheck(int iind=0, int dir=0){ return inputS<false>(iind).dataA[dir];}
     //@}
 
+    /** \brief  Id of the function in the current profiling session, registering it if needed */
+    inline int profilingId(){ int id = Profiler::cachedId(profiling_.session,profiling_.id); return id>=0 ? id : registerProfiling();}
+
+    /** \brief  Register the function in the current profiling session */
+    int registerProfiling();
+
+    /** \brief  Descriptions of the algorithm elements, used to label the events of the profiler */
+    virtual std::vector<std::string> getProfilingNodes() const{ return std::vector<std::string>();}
+
     /** \brief  Log the status of the solver */
     void log(const std::string& msg) const;
 
@@ -289,6 +332,8 @@ namespace CasADi{
     virtual void evaluateMX(MXNode* node, const MXPtrV& arg, MXPtrV& res, const MXPtrVV& fseed, MXPtrVV& fsens, const MXPtrVV& aseed, MXPtrVV& asens, bool output_given);
     virtual void propagateSparsity(MXNode* node, DMatrixPtrV& input, DMatrixPtrV& output, std::vector<int>& itmp, std::vector<double>& rtmp, bool fwd);
     virtual void nTmp(MXNode* node, size_t& ni, size_t& nr);
+    virtual void evaluateD(MXNode* node, const double** arg, double** res, int* itmp, double* rtmp);
+    virtual void nWork(MXNode* node, size_t& ni, size_t& nr);
     virtual void generateOperation(const MXNode* node, std::ostream &stream, const std::vector<std::string>& arg, const std::vector<std::string>& res, CodeGenerator& gen) const;
     virtual void printPart(const MXNode* node, std::ostream &stream, int part) const;
     //@}
@@ -299,6 +344,18 @@ namespace CasADi{
     /** \brief  Output of the function */
     std::vector<FunctionIO> output_;
 
+    /** \brief  Profiling session and id of the function in that session.
+        Copies, made by clone and hence by deepcopy and makeUnique, start out unregistered so that 
+        their events are not attributed to the original function. Only accessed under the registry mutex 
+        of the profiler, since concurrent evaluations of a reentrant function register it lazily */
+    struct ProfilingRegistration{
+      int session, id;
+      ProfilingRegistration() : session(-1), id(-1){}
+      ProfilingRegistration(const ProfilingRegistration&) : session(-1), id(-1){}
+      ProfilingRegistration& operator=(const ProfilingRegistration&){ session = id = -1; return *this;}
+    };
+    ProfilingRegistration profiling_;
+
     /** \brief  Number of forward and adjoint derivatives */
     int nfdir_, nadir_;
 
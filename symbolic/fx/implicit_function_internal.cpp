@@ -26,7 +26,6 @@
 #include <iterator>
 
 #include "../casadi_options.hpp"
-#include "../profiling.hpp"
 
 using namespace std;
 namespace CasADi{
@@ -122,14 +121,6 @@ namespace CasADi{
   }
 
   void ImplicitFunctionInternal::evaluate(int nfdir, int nadir){
-    // Set up timers for profiling
-    double time_zero;
-    double time_start;
-    double time_stop;
-    if (CasadiOptions::profiling) {
-      time_zero = getRealTime();
-    }
-    
     // Mark factorization as out-of-date. TODO: make this conditional
     fact_up_to_date_ = false;
 
@@ -143,9 +134,9 @@ namespace CasADi{
     casadi_assert_message(!linsol_.isNull(),"Sensitivities of an implicit function requires a provided linear solver");
     casadi_assert_message(!jac_.isNull(),"Sensitivities of an implicit function requires an exact Jacobian");
   
-    if (CasadiOptions::profiling) {
-       time_start = getRealTime(); // Start timer
-    }
+    // Profiler id, -1 if not profiling
+    int profiling_id = CasadiOptions::profiling ? profilingId() : -1;
+    if(profiling_id>=0) Profiler::begin(profiling_id,3,nfdir,nadir);
     
     // Evaluate and factorize the Jacobian
     if (!fact_up_to_date_) {
@@ -192,33 +183,47 @@ namespace CasADi{
       }
     }
   
-    // Solve for the adjoint seeds
-    for(int dir=0; dir<nadir; ++dir){
-      // Negate adjoint seed and pass to function
-      Matrix<double>& faseed = f_.adjSeed(0,dir);
-      faseed.set(adjSeed(0,dir));
-      for(vector<double>::iterator it=faseed.begin(); it!=faseed.end(); ++it){
-        *it = -*it;
+    // Solve for the adjoint seeds, all directions in one call to the linear solver
+    if(nadir>0){
+      // Negate adjoint seeds and collect
+      sens_block_.resize(nadir*n_);
+      for(int dir=0; dir<nadir; ++dir){
+        Matrix<double>& faseed = f_.adjSeed(0,dir);
+        faseed.set(adjSeed(0,dir));
+        casadi_assert(faseed.size()==n_);
+        for(int k=0; k<n_; ++k) sens_block_[k+dir*n_] = -faseed.data()[k];
       }
     
       // Solve the transposed linear system
-      linsol_.solve(&faseed.front(),1,false);
+      linsol_.solve(getPtr(sens_block_),nadir,false);
+
+      // Pass to function
+      for(int dir=0; dir<nadir; ++dir){
+        f_.adjSeed(0,dir).set(getPtr(sens_block_)+dir*n_);
+      }
     }
   
     // Evaluate
     f_.evaluate(nfdir,nadir);
   
-    // Get the forward sensitivities
-    for(int dir=0; dir<nfdir; ++dir){
-      // Negate intermediate result and copy to output
-      Matrix<double>& fsens = fwdSens(0,dir);
-      fsens.set(f_.fwdSens(0,dir));
-      for(vector<double>::iterator it=fsens.begin(); it!=fsens.end(); ++it){
-        *it = -*it;
+    // Get the forward sensitivities, all directions in one call to the linear solver
+    if(nfdir>0){
+      // Negate intermediate results and collect
+      sens_block_.resize(nfdir*n_);
+      for(int dir=0; dir<nfdir; ++dir){
+        Matrix<double>& fsens = fwdSens(0,dir);
+        fsens.set(f_.fwdSens(0,dir));
+        casadi_assert(fsens.size()==n_);
+        for(int k=0; k<n_; ++k) sens_block_[k+dir*n_] = -fsens.data()[k];
       }
     
       // Solve the linear system
-      linsol_.solve(&fsens.front(),1,true);
+      linsol_.solve(getPtr(sens_block_),nfdir,true);
+
+      // Copy to output
+      for(int dir=0; dir<nfdir; ++dir){
+        fwdSens(0,dir).set(getPtr(sens_block_)+dir*n_);
+      }
     }
   
     // Get the adjoint sensitivities
@@ -230,10 +235,14 @@ namespace CasADi{
     
 
 
-    if (CasadiOptions::profiling) {
-      time_stop = getRealTime(); // Stop timer
-      CasadiOptions::profilingLog  << double(time_stop-time_start)*1e6 << " ns | " << double(time_stop-time_zero)*1e3 << " ms | " << this << ":" << getOption("name") << ":3||stuff" << std::endl;
-    }
+    if(profiling_id>=0) Profiler::end(profiling_id,3,nfdir,nadir);
+  }
+  
+  std::vector<std::string> ImplicitFunctionInternal::getProfilingNodes() const{
+    // Nodes 0-2 are reserved for the nonlinear solve of derived classes
+    std::vector<std::string> ret(4);
+    ret[3] = "sensitivities";
+    return ret;
   }
 
   void ImplicitFunctionInternal::evaluateMX(MXNode* node, const MXPtrV& arg, MXPtrV& res, const MXPtrVV& fseed, MXPtrVV& fsens, const MXPtrVV& aseed, MXPtrVV& asens, bool output_given){
@@ -65,6 +65,9 @@ namespace CasADi{
     /// Solve the nonlinear system of equations
     virtual void solveNonLinear() = 0;
 
+    /// Descriptions of the profiled sections, nodes 0-2 are reserved for solveNonLinear
+    virtual std::vector<std::string> getProfilingNodes() const;
+
     // The following functions are called internally from EvaluateMX. For documentation, see the MXNode class
     //@{
     virtual void evaluateMX(MXNode* node, const MXPtrV& arg, MXPtrV& res, const MXPtrVV& fseed, MXPtrVV& fsens, const MXPtrVV& aseed, MXPtrVV& asens, bool output_given);
@@ -84,6 +87,9 @@ namespace CasADi{
 
     /// Factorization up-to-date?
     bool fact_up_to_date_;
+
+    /// Sensitivities of all directions, passed to the linear solver as one block of right hand sides
+    std::vector<double> sens_block_;
     
     /// Constraints on decision variables
     std::vector<int> u_c_;
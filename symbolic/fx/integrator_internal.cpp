@@ -154,7 +154,7 @@ void IntegratorInternal::evaluate(int nfdir, int nadir){
   }
   
   // Print statistics
-  if(getOption("print_stats")) printStats(std::cout);
+  if(print_stats_) printStats(std::cout);
   
   //if (!integrator.isNull()) stats_["augmented_stats"] =  integrator.getStats();
 }
@@ -228,6 +228,7 @@ void IntegratorInternal::init(){
   tf_ = getOption("tf");
   fwd_via_sct_ = getOption("fwd_via_sct");
   adj_via_sct_ = getOption("adj_via_sct");
+  print_stats_ = getOption("print_stats");
 }
 
 void IntegratorInternal::deepCopyMembers(std::map<SharedObjectNode*,SharedObject>& already_copied){
@@ -120,6 +120,9 @@ public:
   
   /// Generate new functions for calculating forward/adjoint directional derivatives
   bool fwd_via_sct_, adj_via_sct_;
+
+  /// Print out statistics after integration
+  bool print_stats_;
   
 };
   
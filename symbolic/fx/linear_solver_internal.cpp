@@ -29,6 +29,8 @@ OUTPUTSCHEME(LinsolOutput)
 using namespace std;
 namespace CasADi{
 
+  const int LinearSolverInternal::rhs_panel_;
+
   LinearSolverInternal::LinearSolverInternal(const CRSSparsity& sparsity, int nrhs){
     // No OO derivatives supported/needed
     setOption("number_of_fwd_dir",0);
@@ -61,6 +63,7 @@ namespace CasADi{
     
     // Not prepared
     prepared_ = false;
+    last_matrix_.clear();
   }
 
   LinearSolverInternal::~LinearSolverInternal(){
@@ -69,26 +72,7 @@ namespace CasADi{
   void LinearSolverInternal::evaluate(int nfdir, int nadir){
     casadi_assert_message(nfdir==0 && nadir==0,"Directional derivatives for LinearSolver not supported. Reformulate or wrap in an MXFunction instance.");
 
-    /*  Factorization fact;
-        if(called_once){
-        // Check if any element has changed
-        bool any_change = false;
-        const vector<double>& val = input(0).data();
-        for(int i=0; i<val.size(); ++i){
-        if(val[i] != a[i]){
-        any_change = true;
-        break;
-        }
-        }
-    
-        // Reuse factored matrix if matrix hasn't changed
-        fact = any_change ? SAMEPATTERN : FACTORED;
-        } else {
-        fact = DOFACT;
-        called_once = true;
-        }*/
-  
-    // Call the solve routine
+    // Factorize, solvers may skip this if the linear system has not changed (cf. sameMatrix)
     prepare();
   
     // Make sure preparation successful
@@ -99,12 +83,19 @@ namespace CasADi{
     solve();
   }
  
+  bool LinearSolverInternal::sameMatrix(){
+    const vector<double>& a = input(LINSOL_A).data();
+    if(last_matrix_.size()==a.size() && std::equal(a.begin(),a.end(),last_matrix_.begin())) return true;
+    last_matrix_ = a;
+    return false;
+  }
+ 
   void LinearSolverInternal::solve(){
     // Get input and output vector
     const vector<double>& b = input(LINSOL_B).data();
     vector<double>& x = output(LINSOL_X).data();
     bool transpose = input(LINSOL_T).toScalar()!=0.;
-    int nrhs = x.size()/input(LINSOL_B).size();
+    int nrhs = input(LINSOL_B).size1();
 
     // Copy input to output
     copy(b.begin(),b.end(),x.begin());
@@ -55,9 +55,19 @@ namespace CasADi{
     // Solve the system of equations
     virtual void solve(double* x, int nrhs, bool transpose) = 0;
 
+    // Number of right hand sides processed together by the blocked triangular solves
+    static const int rhs_panel_ = 8;
+
+    // Check if the nonzeros of the linear system compare equal to those at the last call, and store them for the next call.
+    // Since the comparison uses ==, -0 matches 0 (the factorizations could only differ in the signs of zeros) and a not-a-number never matches
+    bool sameMatrix();
+
     // Is prepared
     bool prepared_;
 
+    // Nonzeros of the linear system at the last call to sameMatrix
+    std::vector<double> last_matrix_;
+
     // Get sparsity pattern
     int nrow() const{ return input(LINSOL_A).size1();}
     int ncol() const{ return input(LINSOL_A).size2();}
@@ -30,7 +30,6 @@
 
 #include <stack>
 #include <typeinfo>
-#include "../profiling.hpp"
 #include "../casadi_options.hpp"
 
 using namespace std;
@@ -75,6 +74,107 @@ namespace CasADi{
   }
 
 
+  void MXFunctionInternal::eliminateCommonSubexpressions(std::vector<MXNode*>& nodes, std::vector<MXNode*>& removed, std::vector<MX>& clones){
+    // The nodes before any replacements
+    vector<MXNode*> orig = nodes;
+    
+    // For each node, the position of the equivalent node that is kept
+    vector<int> rep(nodes.size(),-1);
+
+    // Candidates for merging, bucketed by operation, dependencies and dimensions
+    SPARSITY_MAP<size_t,vector<int> > buckets;
+    
+    // Function outputs, identified by the position of the function call and the output index
+    map<pair<int,int>,int> fcn_outputs;
+
+    vector<MX> dep;
+    for(int i=0; i<nodes.size(); ++i){
+      MXNode* n = nodes[i];
+      
+      // Output instructions and symbolic primitives are unique
+      if(n==0 || n->getOp()==OP_PARAMETER){
+        rep[i] = i;
+        continue;
+      }
+      
+      // Function outputs are equivalent if the function calls are
+      if(n->getOp()<0){
+        pair<int,int> key(rep[n->dep(0)->temp],n->getFunctionOutput());
+        map<pair<int,int>,int>::const_iterator it = fcn_outputs.find(key);
+        if(it==fcn_outputs.end()){
+          rep[i] = i;
+          fcn_outputs[key] = i;
+        } else {
+          rep[i] = it->second;
+        }
+        continue;
+      }
+      
+      // Get the equivalent dependencies
+      size_t h = 0;
+      bool replace_deps = false;
+      dep.resize(n->ndep());
+      for(int k=0; k<n->ndep(); ++k){
+        int d = -1;
+        if(n->dep(k).isNull()){
+          dep[k] = MX();
+        } else {
+          d = rep[n->dep(k)->temp];
+          if(nodes[d]==n->dep(k).get()){
+            dep[k] = n->dep(k);
+          } else {
+            dep[k].assignNode(nodes[d]);
+            replace_deps = true;
+          }
+        }
+        h += (size_t(d)+1)*0x9e3779b9; // independent of the order, binary operations may be commutative
+      }
+      h ^= size_t(n->getOp()) + 0x9e3779b9 + (h<<6) + (h>>2);
+      h ^= size_t(n->size1()) + 0x9e3779b9 + (h<<6) + (h>>2);
+      h ^= size_t(n->size2()) + 0x9e3779b9 + (h<<6) + (h>>2);
+      
+      // Replace with a node that refers to the equivalent dependencies
+      if(replace_deps){
+        MX c = MX::create(n->clone());
+        c->setDependencies(dep);
+        clones.push_back(c);
+        nodes[i] = n = static_cast<MXNode*>(c.get());
+      }
+      
+      // Look for an equivalent node
+      vector<int>& bucket = buckets[h];
+      for(vector<int>::const_iterator it=bucket.begin(); it!=bucket.end(); ++it){
+        if(n->isEqual(nodes[*it],1)){
+          rep[i] = *it;
+          break;
+        }
+      }
+      
+      // New unique node
+      if(rep[i]<0){
+        rep[i] = i;
+        bucket.push_back(i);
+      }
+    }
+    
+    // New position of each node in the list
+    vector<int> pos(nodes.size());
+    int n_kept = 0;
+    for(int i=0; i<nodes.size(); ++i){
+      pos[i] = rep[i]==i ? n_kept++ : pos[rep[i]];
+    }
+
+    // Update the temporary variables and remove the merged nodes
+    int k = 0;
+    for(int i=0; i<nodes.size(); ++i){
+      if(orig[i]) orig[i]->temp = pos[i];
+      if(nodes[i]) nodes[i]->temp = pos[i];
+      if(orig[i]!=nodes[i] || rep[i]!=i) removed.push_back(orig[i]);
+      if(rep[i]==i) nodes[k++] = nodes[i];
+    }
+    nodes.resize(k);
+  }
+
   void MXFunctionInternal::init(){
     log("MXFunctionInternal::init begin");
       
@@ -112,6 +212,17 @@ namespace CasADi{
       }
     }
 
+    // Merge common subexpressions
+    vector<MXNode*> cse_removed;
+    vector<MX> cse_clones;
+    if(getOption("cse")){
+      int nodes_before = nodes.size();
+      eliminateCommonSubexpressions(nodes,cse_removed,cse_clones);
+      if(verbose()){
+        cout << "Common subexpression elimination: " << nodes.size() << " nodes instead of " << nodes_before << endl;
+      }
+    }
+
     // Place in the algorithm for each node
     vector<int> place_in_alg;
     place_in_alg.reserve(nodes.size());
@@ -305,6 +416,24 @@ namespace CasADi{
     }
     itmp_.resize(nitmp);
     rtmp_.resize(nrtmp);
+
+    // Memory for evaluation with caller-owned work vectors
+    work_offset_.resize(work_.size()+1);
+    work_offset_[0] = 0;
+    for(int k=0; k<work_.size(); ++k){
+      work_offset_[k+1] = work_offset_[k] + work_[k].data.size();
+    }
+    nitmp_work_ = nrtmp_work_ = 0;
+    reentrant_ = true;
+    for(vector<AlgEl>::iterator it=algorithm_.begin(); it!=algorithm_.end(); ++it){
+      if(it->op!=OP_INPUT && it->op!=OP_OUTPUT){
+        size_t ni=0, nr=0;
+        it->data->nWork(ni,nr);
+        nitmp_work_ = std::max(nitmp_work_,ni);
+        nrtmp_work_ = std::max(nrtmp_work_,nr);
+        reentrant_ = reentrant_ && it->data->isReentrant();
+      }
+    }
   
     // Reset the temporary variables
     for(int i=0; i<nodes.size(); ++i){
@@ -312,6 +441,9 @@ namespace CasADi{
         nodes[i]->temp = 0;
       }
     }
+    for(vector<MXNode*>::iterator it=cse_removed.begin(); it!=cse_removed.end(); ++it){
+      (*it)->temp = 0;
+    }
   
     // Now mark each input's place in the algorithm
     for(vector<pair<int,MXNode*> >::const_iterator it=symb_loc.begin(); it!=symb_loc.end(); ++it){
@@ -346,6 +478,30 @@ namespace CasADi{
       }
     }
 
+    // Pre-decode the algorithm for evaluation with caller-owned work vectors
+    alg_io_.clear();
+    alg_io_ptr_.resize(algorithm_.size()+1);
+    max_arg_ = max_res_ = 0;
+    for(int k=0; k<algorithm_.size(); ++k){
+      const AlgEl& e = algorithm_[k];
+      alg_io_ptr_[k] = alg_io_.size();
+      if(e.op==OP_INPUT || e.op==OP_OUTPUT){
+        int i = e.op==OP_INPUT ? e.res.front() : e.arg.front();
+        alg_io_.push_back(work_offset_[i]);
+        alg_io_.push_back(work_offset_[i+1]-work_offset_[i]);
+      } else {
+        for(vector<int>::const_iterator i=e.arg.begin(); i!=e.arg.end(); ++i){
+          alg_io_.push_back(*i>=0 ? work_offset_[*i] : -1);
+        }
+        for(vector<int>::const_iterator i=e.res.begin(); i!=e.res.end(); ++i){
+          alg_io_.push_back(*i>=0 ? work_offset_[*i] : -1);
+        }
+        max_arg_ = std::max(max_arg_,int(e.arg.size()));
+        max_res_ = std::max(max_res_,int(e.res.size()));
+      }
+    }
+    alg_io_ptr_.back() = alg_io_.size();
+
     // Clear any existing tape
     tape_.clear();
   
@@ -431,17 +587,146 @@ namespace CasADi{
     }
   }
 
+  void MXFunctionInternal::evaluate(const double** arg, double** res, int* iw, double* w){
+    // Make sure that there are no free variables
+    if (!free_vars_.empty()) {
+      std::stringstream ss;
+      repr(ss);
+      casadi_error("Cannot evaluate \"" << ss.str() << "\" since variables " << free_vars_ << " are free.");
+    }
+
+    // Temporary variables of the nodes are stored after the work vector elements
+    double* rtmp = w + work_offset_.back();
+
+    // Pointers to the arguments and results of each node
+    vector<const double*> argp(max_arg_);
+    vector<double*> resp(max_res_);
+
+    // Id of the function for the profiler
+    bool profiling = CasadiOptions::profiling;
+    int profiling_id = profiling ? profilingId() : -1;
+    
+    // Evaluate all of the nodes of the pre-decoded algorithm
+    const int* io = getPtr(alg_io_);
+    for(int k=0; k<algorithm_.size(); ++k){
+      AlgEl& e = algorithm_[k];
+      const int* io_k = io + alg_io_ptr_[k];
+      if(e.op==OP_INPUT){
+        // Pass the input
+        const double* a = arg[e.arg.front()];
+        if(a==0){
+          std::fill(w+io_k[0],w+io_k[0]+io_k[1],0.0);
+        } else {
+          copy(a,a+io_k[1],w+io_k[0]);
+        }
+      } else if(e.op==OP_OUTPUT){
+        // Get the output
+        double* r = res[e.res.front()];
+        if(r!=0) copy(w+io_k[0],w+io_k[0]+io_k[1],r);
+      } else {
+        // Point to the data corresponding to the element
+        int narg = e.arg.size(), nres = e.res.size();
+        for(int i=0; i<narg; ++i){
+          argp[i] = io_k[i]>=0 ? w+io_k[i] : 0;
+        }
+        io_k += narg;
+        for(int i=0; i<nres; ++i){
+          resp[i] = io_k[i]>=0 ? w+io_k[i] : 0;
+        }
+        
+        // Evaluate
+        if(profiling){
+          Profiler::begin(profiling_id,k);
+          e.data->evaluateD(getPtr(argp),getPtr(resp),iw,rtmp);
+          Profiler::end(profiling_id,k);
+        } else {
+          e.data->evaluateD(getPtr(argp),getPtr(resp),iw,rtmp);
+        }
+      }
+    }
+  }
+
+  void MXFunctionInternal::nWorkBatch(int n, size_t& ni, size_t& nr) const{
+    ni = nitmp_work_;
+    nr = work_offset_.back()*batchGroupSize(n) + nrtmp_work_;
+  }
+
+  void MXFunctionInternal::evaluateBatch(int n, const double** arg, double** res, int* iw, double* w){
+    // Make sure that there are no free variables
+    if (!free_vars_.empty()) {
+      std::stringstream ss;
+      repr(ss);
+      casadi_error("Cannot evaluate \"" << ss.str() << "\" since variables " << free_vars_ << " are free.");
+    }
+
+    // The work vectors of the evaluations of a group are stored one after another, followed by the temporary variables of the nodes
+    const int ng = batchGroupSize(n);
+    const int nw = work_offset_.back();
+    double* rtmp = w + nw*ng;
+
+    // Pointers to the arguments and results of each node
+    vector<const double*> argp(max_arg_);
+    vector<double*> resp(max_res_);
+    
+    // Number of nonzeros of the inputs and outputs
+    vector<int> nnz_in(getNumInputs()), nnz_out(getNumOutputs());
+    for(int ind=0; ind<nnz_in.size(); ++ind) nnz_in[ind] = inputNoCheck(ind).size();
+    for(int ind=0; ind<nnz_out.size(); ++ind) nnz_out[ind] = outputNoCheck(ind).size();
+
+    // Evaluate all of the nodes of the pre-decoded algorithm for a group of evaluations at a time
+    const int* io = getPtr(alg_io_);
+    for(int j0=0; j0<n; j0+=ng){
+      const int nj = std::min(ng,n-j0);
+      for(int k=0; k<algorithm_.size(); ++k){
+        AlgEl& e = algorithm_[k];
+        const int* io_k = io + alg_io_ptr_[k];
+        if(e.op==OP_INPUT){
+          // Pass the input
+          int ind = e.arg.front();
+          for(int l=0; l<nj; ++l){
+            double* wl = w + l*nw + io_k[0];
+            if(arg[ind]==0){
+              std::fill(wl,wl+io_k[1],0.0);
+            } else {
+              const double* a = arg[ind] + (j0+l)*nnz_in[ind];
+              copy(a,a+io_k[1],wl);
+            }
+          }
+        } else if(e.op==OP_OUTPUT){
+          // Get the output
+          int ind = e.res.front();
+          if(res[ind]!=0){
+            for(int l=0; l<nj; ++l){
+              const double* wl = w + l*nw + io_k[0];
+              copy(wl,wl+io_k[1],res[ind] + (j0+l)*nnz_out[ind]);
+            }
+          }
+        } else {
+          int narg = e.arg.size(), nres = e.res.size();
+          for(int l=0; l<nj; ++l){
+            // Point to the data corresponding to the element
+            double* wl = w + l*nw;
+            for(int i=0; i<narg; ++i){
+              argp[i] = io_k[i]>=0 ? wl+io_k[i] : 0;
+            }
+            for(int i=0; i<nres; ++i){
+              resp[i] = io_k[narg+i]>=0 ? wl+io_k[narg+i] : 0;
+            }
+            
+            // Evaluate
+            e.data->evaluateD(getPtr(argp),getPtr(resp),iw,rtmp);
+          }
+        }
+      }
+    }
+  }
+
   void MXFunctionInternal::evaluate(int nfdir, int nadir){
     casadi_log("MXFunctionInternal::evaluate(" << nfdir << ", " << nadir<< "):begin "  << getOption("name"));
 
-    // Set up timers for profiling
-    double time_zero;
-    double time_start;
-    double time_stop;
-    if (CasadiOptions::profiling) {
-      time_zero = getRealTime();
-      CasadiOptions::profilingLog  << "start " << this << ":" <<getOption("name") << std::endl; 
-    }
+    // Id of the function for the profiler
+    bool profiling = CasadiOptions::profiling;
+    int profiling_id = profiling ? profilingId() : -1;
     
     // Make sure that there are no free variables
     if (!free_vars_.empty()) {
@@ -457,10 +742,7 @@ namespace CasADi{
     int alg_counter = 0;
     for(vector<AlgEl>::iterator it=algorithm_.begin(); it!=algorithm_.end(); ++it, ++alg_counter){
 
-
-      if (CasadiOptions::profiling) {
-        time_start = getRealTime(); // Start timer
-      }
+      if(profiling) Profiler::begin(profiling_id,alg_counter,nfdir,0);
         
       // Spill existing work elements if needed
       if(nadir>0 && it->op!=OP_OUTPUT){
@@ -495,19 +777,7 @@ namespace CasADi{
         
       }
       
-      // Write out profiling information
-      if (CasadiOptions::profiling) {
-        time_stop = getRealTime(); // Stop timer
-        CasadiOptions::profilingLog  << double(time_stop-time_start)*1e6 << " ns | " << double(time_stop-time_zero)*1e3 << " ms | " << this << ":" <<getOption("name") << ":" << alg_counter <<"|"; 
-        if (it->op == OP_CALL) {
-          FX f = it->data->getFunction();
-          CasadiOptions::profilingLog << f.get() << ":" << f.getOption("name");
-        }
-        CasadiOptions::profilingLog << "|";
-        print(CasadiOptions::profilingLog,*it);
-        
-      }
-      
+      if(profiling) Profiler::end(profiling_id,alg_counter,nfdir,0);
     }
 
     casadi_log("MXFunctionInternal::evaluate(" << nfdir << ", " << nadir<< "):evaluated forward "  << getOption("name"));
@@ -526,10 +796,7 @@ namespace CasADi{
       int alg_counter = algorithm_.size()-1;
       tt--;
       for(vector<AlgEl>::reverse_iterator it=algorithm_.rbegin(); it!=algorithm_.rend(); ++it, --alg_counter){
-        // Evaluate
-        if (CasadiOptions::profiling) {
-          time_start = getRealTime(); // Start timer
-        }
+        if(profiling) Profiler::begin(profiling_id,alg_counter,0,nadir);
       
         // Mark spilled work vector elements to be recovered to allow the operator input to be updated but not the operator output 
         // (important for inplace operations)
@@ -572,33 +839,26 @@ namespace CasADi{
             }
           }
         }
-        // Write out profiling information
-        if (CasadiOptions::profiling) {
-          time_stop = getRealTime(); // Stop timer
-          CasadiOptions::profilingLog  << double(time_stop-time_start)*1e6 << " ns | " << double(time_stop-time_zero)*1e3 << " ms | " << this << ":" <<getOption("name") << ":" << alg_counter <<"|"; 
-          if (it->op == OP_CALL) {
-            FX f = it->data->getFunction();
-            CasadiOptions::profilingLog << f.get() << ":" << f.getOption("name");
-            CasadiOptions::profilingLog << "|>" << typeid(it->data).name();
-            print(CasadiOptions::profilingLog,*it);
-          } else {
-            CasadiOptions::profilingLog << "|";
-            print(CasadiOptions::profilingLog,*it);
-          }
-        }
+        if(profiling) Profiler::end(profiling_id,alg_counter,0,nadir);
       }
   
       casadi_log("MXFunctionInternal::evaluate(" << nfdir << ", " << nadir<< "):adjoints:end"  << getOption("name"));
     }
-    
-    if (CasadiOptions::profiling) {
-      time_stop = getRealTime();
-      CasadiOptions::profilingLog  << "stop " << this << ":" <<getOption("name") << double(time_stop-time_zero)*1e3 << " ms" << std::endl; 
-    }
-   
+
     casadi_log("MXFunctionInternal::evaluate(" << nfdir << ", " << nadir<< "):end "  << getOption("name"));
   }
 
+  std::vector<std::string> MXFunctionInternal::getProfilingNodes() const{
+    vector<string> ret(algorithm_.size());
+    for(int k=0; k<algorithm_.size(); ++k){
+      stringstream ss;
+      print(ss,algorithm_[k]);
+      ret[k] = ss.str();
+      ret[k].erase(ret[k].find_last_not_of('\n')+1); // drop the line break
+    }
+    return ret;
+  }
+
   void MXFunctionInternal::print(ostream &stream, const AlgEl& el) const {
     if(el.op==OP_OUTPUT){
       stream << "output[" << el.res.front() << "] = @" << el.arg.at(0);
@@ -735,6 +995,11 @@ namespace CasADi{
   }
 
   FX MXFunctionInternal::getNumericJacobian(int iind, int oind, bool compact, bool symmetric){
+    // Evaluate the directional derivative sweeps in parallel
+    if(!symmetric && bool(getOption("parallel_jacobian"))){
+      return FXInternal::getNumericJacobian(iind,oind,compact,symmetric);
+    }
+
     // Create expressions for the Jacobian
     vector<MX> ret_out;
     ret_out.reserve(1+outputv_.size());
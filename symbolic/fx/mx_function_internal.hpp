@@ -58,6 +58,24 @@ namespace CasADi{
     /** \brief  Evaluate the algorithm */
     virtual void evaluate(int nfdir, int nadir);
 
+    /** \brief  Evaluate the algorithm without derivatives, all memory owned by the caller */
+    virtual void evaluate(const double** arg, double** res, int* iw, double* w);
+
+    /** \brief  Get the length of the work vectors needed by evaluate(arg,res,iw,w) */
+    virtual void nWork(size_t& ni, size_t& nr) const{ ni=nitmp_work_; nr=work_offset_.back()+nrtmp_work_;}
+
+    /** \brief  Can evaluate(arg,res,iw,w) be called concurrently for the same object */
+    virtual bool isReentrant() const{ return reentrant_;}
+
+    /** \brief  Evaluate n times without derivatives, evaluating each node for a group of evaluations at a time */
+    virtual void evaluateBatch(int n, const double** arg, double** res, int* iw, double* w);
+
+    /** \brief  Get the length of the work vectors needed by evaluateBatch for n evaluations */
+    virtual void nWorkBatch(int n, size_t& ni, size_t& nr) const;
+
+    /// Number of evaluations in a group in evaluateBatch, at most 16 and such that their work vectors take up at most 256 kB
+    int batchGroupSize(int n) const{ return std::max(1,std::min(n,std::min(16,32768/std::max(1,work_offset_.back()))));}
+
     /** \brief  Print description */
     virtual void print(std::ostream &stream) const;
 
@@ -67,6 +85,15 @@ namespace CasADi{
     /** \brief  Update the number of sensitivity directions during or after initialization */
     virtual void updateNumSens(bool recursive);
 
+    /** \brief  Merge equivalent nodes in a topologically sorted list of nodes
+     * The temporary variable of each node must hold its position in the list. Nodes with the same operation, 
+     * equivalent dependencies and equal parameters (as determined by MXNode::isEqual) are merged. Nodes whose 
+     * dependencies have been merged are replaced by copies referring to the remaining nodes, which are stored 
+     * in "clones". On return, the nodes no longer in the list are in "removed" and all temporary variables point 
+     * to the new position of the equivalent node.
+     */
+    static void eliminateCommonSubexpressions(std::vector<MXNode*>& nodes, std::vector<MXNode*>& removed, std::vector<MX>& clones);
+
     /** \brief Generate code for the declarations of the C function */
     virtual void generateDeclarations(std::ostream &stream, const std::string& type, CodeGenerator& gen) const;
     
@@ -94,6 +121,23 @@ namespace CasADi{
     /** \brief  Temporary vectors needed for the evaluation (real) */
     std::vector<double> rtmp_;
 
+    /** \brief  Offset of each work vector element in the real work vector of evaluate(arg,res,iw,w) */
+    std::vector<int> work_offset_;
+
+    /** \brief  Pre-decoded algorithm for evaluate(arg,res,iw,w)
+        For each element k, the offsets in the real work vector of the arguments followed by the results (-1 if null), 
+        starting at alg_io_[alg_io_ptr_[k]]. For OP_INPUT and OP_OUTPUT, the offset and size of the work vector element. */
+    std::vector<int> alg_io_, alg_io_ptr_;
+
+    /** \brief  Maximum number of arguments and results of a node */
+    int max_arg_, max_res_;
+
+    /** \brief  Temporary variables needed by the nodes in evaluate(arg,res,iw,w) */
+    size_t nitmp_work_, nrtmp_work_;
+
+    /** \brief  Are all nodes reentrant */
+    bool reentrant_;
+
     /** \brief  "Tape" with spilled variables */
     std::vector<std::pair<std::pair<int,int>,DMatrix> > tape_;
     
@@ -147,6 +191,9 @@ namespace CasADi{
     
     // print an element of an algorithm
     void print(std::ostream &stream, const AlgEl& el) const;
+
+    // Descriptions of the algorithm elements, used to label the events of the profiler
+    virtual std::vector<std::string> getProfilingNodes() const;
     
   };
 
@@ -62,6 +62,9 @@ namespace CasADi{
     // Enable string notation for IO
     inputScheme_ = SCHEME_NLPSolverInput;
     outputScheme_ = SCHEME_NLPSolverOutput;
+
+    // The fused objective gradient and constraint Jacobian is generated when first needed
+    gradFJacG_attempted_ = false;
   }
 
   NLPSolverInternal::~NLPSolverInternal(){
@@ -151,6 +154,10 @@ namespace CasADi{
     }
   
     callback_step_ = getOption("iteration_callback_step");
+    callback_ignore_errors_ = getOption("iteration_callback_ignore_errors");
+
+    // Nothing evaluated yet
+    clearEvalCache();
   }
 
   void NLPSolverInternal::checkInitialBounds() { 
@@ -306,6 +313,135 @@ namespace CasADi{
     }
     return spHessLag;
   }
+
+  FX& NLPSolverInternal::gradFJacG(){
+    // Only try once, the result is null if the functions cannot be fused
+    if(!gradFJacG_attempted_){
+      gradFJacG_attempted_ = true;
+      gradFJacG_ = getGradFJacG();
+    }
+    return gradFJacG_;
+  }
+
+  FX NLPSolverInternal::getGradFJacG(){
+    FX gradFJacG;
+
+    // Only when both derivatives are generated from the expressions of the NLP
+    if(ng_==0 || hasSetOption("grad_f") || hasSetOption("jac_g")) return gradFJacG;
+    if(bool(nlp_.getOption("numeric_jacobian")) || nlp_.hasSetOption("jacobian_generator")) return gradFJacG;
+
+    // Generate the gradient and Jacobian expressions, sharing the evaluation of the NLP
+    SXFunction nlp_sx = shared_cast<SXFunction>(nlp_);
+    MXFunction nlp_mx = shared_cast<MXFunction>(nlp_);
+    if(!nlp_sx.isNull()){
+      log("Generating objective gradient and constraint Jacobian");
+      vector<SXMatrix> ret_out(4);
+      ret_out[0] = nlp_sx.grad(NL_X,NL_F);
+      ret_out[1] = nlp_sx.jac(NL_X,NL_G);
+      ret_out[2] = nlp_sx.outputExpr(NL_F);
+      ret_out[3] = nlp_sx.outputExpr(NL_G);
+      gradFJacG = SXFunction(nlp_sx.inputExpr(),ret_out);
+    } else if(!nlp_mx.isNull()){
+      log("Generating objective gradient and constraint Jacobian");
+      vector<MX> ret_out(4);
+      ret_out[0] = nlp_mx.grad(NL_X,NL_F);
+      ret_out[1] = nlp_mx.jac(NL_X,NL_G);
+      ret_out[2] = nlp_mx.outputExpr(NL_F);
+      ret_out[3] = nlp_mx.outputExpr(NL_G);
+      gradFJacG = MXFunction(nlp_mx.inputExpr(),ret_out);
+    } else {
+      return gradFJacG;
+    }
+    gradFJacG.setOption("name","grad_f_jac_g");
+    gradFJacG.setOption("number_of_fwd_dir",0);
+    gradFJacG.setOption("number_of_adj_dir",0);
+    gradFJacG.init(false);
+    log("Objective gradient and constraint Jacobian function initialized");
+
+    // The results must be interchangeable with those of the separate functions, without generating the gradient function
+    if(gradFJacG.output(0).numel()!=nx_ || gradFJacG.output(1).sparsity()!=jacG().output(JACG_JAC).sparsity()){
+      return FX();
+    }
+    return gradFJacG;
+  }
+
+  void NLPSolverInternal::clearEvalCache(){
+    cache_x_.resize(nx_);
+    cache_x_set_ = false;
+    cached_fg_ = cached_grad_f_ = cached_jac_g_ = false;
+    n_eval_fg_ = n_eval_grad_f_ = n_eval_jac_g_ = n_eval_grad_f_jac_g_ = 0;
+  }
+
+  void NLPSolverInternal::setCachePoint(const double* x){
+    if(cache_x_set_ && std::equal(cache_x_.begin(),cache_x_.end(),x)) return;
+    std::copy(x,x+nx_,cache_x_.begin());
+    cache_x_set_ = true;
+    cached_fg_ = cached_grad_f_ = cached_jac_g_ = false;
+  }
+
+  void NLPSolverInternal::evalFG(const double* x){
+    setCachePoint(x);
+    if(cached_fg_) return;
+
+    // Evaluate the NLP
+    nlp_.setInput(x,NL_X);
+    nlp_.setInput(input(NLP_SOLVER_P),NL_P);
+    nlp_.evaluate();
+    cache_f_ = nlp_.output(NL_F);
+    cache_g_ = nlp_.output(NL_G);
+    cached_fg_ = true;
+    n_eval_fg_++;
+  }
+
+  void NLPSolverInternal::evalGradF(const double* x){
+    setCachePoint(x);
+    if(cached_grad_f_) return;
+    
+    // Calculate the Jacobian at the same time if possible, it is needed at the same points
+    FX& gradFJacG = this->gradFJacG();
+    if(!gradFJacG.isNull()){
+      evalJacG(x);
+      return;
+    }
+
+    // Evaluate the gradient function
+    FX& gradF = this->gradF();
+    gradF.setInput(x,NL_X);
+    gradF.setInput(input(NLP_SOLVER_P),NL_P);
+    gradF.evaluate();
+    cache_grad_f_ = gradF.output(GRADF_GRAD);
+    cached_grad_f_ = true;
+    n_eval_grad_f_++;
+  }
+
+  void NLPSolverInternal::evalJacG(const double* x){
+    setCachePoint(x);
+    if(cached_jac_g_) return;
+
+    // Calculate the gradient at the same time if possible
+    FX& gradFJacG = this->gradFJacG();
+    if(!gradFJacG.isNull()){
+      gradFJacG.setInput(x,NL_X);
+      gradFJacG.setInput(input(NLP_SOLVER_P),NL_P);
+      gradFJacG.evaluate();
+      cache_grad_f_ = gradFJacG.output(0);
+      cache_jac_g_ = gradFJacG.output(1);
+      cache_f_ = gradFJacG.output(2);
+      cache_g_ = gradFJacG.output(3);
+      cached_grad_f_ = cached_jac_g_ = cached_fg_ = true;
+      n_eval_grad_f_jac_g_++;
+      return;
+    }
+
+    // Evaluate the Jacobian function
+    FX& jacG = this->jacG();
+    jacG.setInput(x,NL_X);
+    jacG.setInput(input(NLP_SOLVER_P),NL_P);
+    jacG.evaluate();
+    cache_jac_g_ = jacG.output(JACG_JAC);
+    cached_jac_g_ = true;
+    n_eval_jac_g_++;
+  }
   
   void NLPSolverInternal::checkInputs() const {
     for (int i=0;i<input(NLP_SOLVER_LBX).size();++i) {
@@ -72,6 +72,9 @@ namespace CasADi{
 
     /// Get or generate the sparsity pattern of the Hessian of the Lagrangian
     virtual CRSSparsity getSpHessLag();
+
+    /// Get or generate a function calculating the objective gradient and the constraint Jacobian in one call (null if not possible)
+    virtual FX getGradFJacG();
     
     // Access the objective gradient function
     FX& gradF();
@@ -88,6 +91,24 @@ namespace CasADi{
     /// Get the sparsity pattern of the Hessian of the Lagrangian
     CRSSparsity& spHessLag();
 
+    /// Access the function calculating the objective gradient and the constraint Jacobian in one call, null if not available
+    FX& gradFJacG();
+
+    /// Forget all cached evaluations, e.g. at the start of a solve as the parameters may have changed
+    void clearEvalCache();
+
+    /// Move the cache to the point x, invalidating the cached evaluations if x differs from the last point
+    void setCachePoint(const double* x);
+
+    /// Evaluate the objective and constraints at x, results in cache_f_ and cache_g_
+    void evalFG(const double* x);
+
+    /// Evaluate the objective gradient at x, result in cache_grad_f_ (together with the constraint Jacobian if possible)
+    void evalGradF(const double* x);
+
+    /// Evaluate the constraint Jacobian at x, result in cache_jac_g_ (together with the objective gradient if possible)
+    void evalJacG(const double* x);
+
     /// Number of variables
     int nx_;
   
@@ -102,6 +123,9 @@ namespace CasADi{
   
     /// Execute the callback function only after this amount of iterations
     int callback_step_;
+
+    /// Ignore errors thrown by the callback function
+    bool callback_ignore_errors_;
   
     /// The NLP
     FX nlp_;
@@ -120,6 +144,21 @@ namespace CasADi{
 
     // Sparsity pattern of the Hessian of the Lagrangian
     CRSSparsity spHessLag_;
+
+    // Objective gradient and constraint Jacobian in one call, has the generation been attempted?
+    FX gradFJacG_;
+    bool gradFJacG_attempted_;
+
+    // Point of the cached evaluations, is there any?
+    std::vector<double> cache_x_;
+    bool cache_x_set_;
+
+    // Cached objective, constraints, objective gradient and constraint Jacobian and their validity at cache_x_
+    DMatrix cache_f_, cache_g_, cache_grad_f_, cache_jac_g_;
+    bool cached_fg_, cached_grad_f_, cached_jac_g_;
+
+    // Number of evaluations of the NLP, the objective gradient, the constraint Jacobian and the fused function since the cache was cleared
+    int n_eval_fg_, n_eval_grad_f_, n_eval_jac_g_, n_eval_grad_f_jac_g_;
   };
 
 } // namespace CasADi
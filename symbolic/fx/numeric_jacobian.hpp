@@ -0,0 +1,65 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef NUMERIC_JACOBIAN_HPP
+#define NUMERIC_JACOBIAN_HPP
+
+#include "fx.hpp"
+
+namespace CasADi{
+
+// Forward declaration of internal class
+class NumericJacobianInternal;
+
+/** \brief NumericJacobian class
+        
+  Calculates a Jacobian block of a function numerically from compressed directional derivatives.
+  The directional derivative sweeps are distributed over the threads of the thread pool, each 
+  thread working with its own copy of the function. Functions that are not reentrant, for which
+  the copies might share state, are evaluated sequentially.
+  
+  This is an internal class. Users should set the options "numeric_jacobian" and "parallel_jacobian"
+  and use the syntax f.jacobian()
+*/ 
+class NumericJacobian : public FX{
+  friend class FXInternal;
+public:
+  
+  /// Default constructor
+  NumericJacobian();
+
+  /// Create a NumericJacobian
+  explicit NumericJacobian(const FX& fcn, int iind, int oind, bool compact);
+  
+  /// Access functions of the node
+  NumericJacobianInternal* operator->();
+
+  /// Const access functions of the node
+  const NumericJacobianInternal* operator->() const;
+  
+};
+
+} // namespace CasADi
+
+
+#endif // NUMERIC_JACOBIAN_HPP
@@ -0,0 +1,262 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "numeric_jacobian_internal.hpp"
+#include "mx_function.hpp"
+#include "../stl_vector_tools.hpp"
+#include "../thread_pool.hpp"
+
+using namespace std;
+
+namespace CasADi{
+  
+NumericJacobianInternal::NumericJacobianInternal(const FX& fcn, int iind, int oind, bool compact) : fcn_(fcn), iind_(iind), oind_(oind), compact_(compact){
+}
+  
+NumericJacobianInternal::~NumericJacobianInternal(){
+}
+
+NumericJacobianInternal* NumericJacobianInternal::clone() const{
+  return new NumericJacobianInternal(*this);
+}
+
+void NumericJacobianInternal::deepCopyMembers(std::map<SharedObjectNode*,SharedObject>& already_copied){
+  FXInternal::deepCopyMembers(already_copied);
+  fcn_ = deepcopy(fcn_,already_copied);
+  for(int t=0; t<fcn_copy_.size(); ++t){
+    fcn_copy_[t] = t==0 ? fcn_ : deepcopy(fcn_copy_[t],already_copied);
+  }
+  graph_ = deepcopy(graph_,already_copied);
+}
+
+void NumericJacobianInternal::init(){
+  // Initialize the function if not already initialized
+  if(!fcn_.isInit()) fcn_.init();
+
+  // Number inputs and outputs of the function
+  int num_in = fcn_.getNumInputs();
+  int num_out = fcn_.getNumOutputs();
+
+  // Same inputs as the function
+  setNumInputs(num_in);
+  for(int i=0; i<num_in; ++i){
+    input(i) = fcn_.input(i);
+  }
+
+  // The Jacobian block followed by the outputs of the function
+  setNumOutputs(1+num_out);
+  output(0) = DMatrix(fcn_->jacSparsity(iind_,oind_,compact_,false),0);
+  for(int i=0; i<num_out; ++i){
+    output(1+i) = fcn_.output(i);
+  }
+  
+  // Call the base class init routine
+  FXInternal::init();
+
+  // Get a unidirectional partition of the Jacobian block
+  CRSSparsity D1, D2;
+  fcn_->getPartition(iind_,oind_,D1,D2,true,false);
+  fwd_ = D2.isNull();
+  const CRSSparsity& D = fwd_ ? D1 : D2;
+  ndir_ = D.isNull() ? 0 : D.size1();
+
+  // Sparsity pattern of the Jacobian block, the nonzeros are ordered as in the Jacobian output
+  const CRSSparsity& jsp = fcn_->jacSparsity(iind_,oind_,true,false);
+  vector<int> mapping;
+  CRSSparsity jsp_trans;
+  if(fwd_) jsp_trans = jsp.transpose(mapping);
+
+  // Seeds and scatter lists for each direction
+  seed_ind_.resize(ndir_+1);
+  sens_ind_.resize(ndir_+1);
+  seed_.clear();
+  sens_.clear();
+  jac_nz_.clear();
+  seed_ind_[0] = sens_ind_[0] = 0;
+  for(int d=0; d<ndir_; ++d){
+    for(int el=D.rowind(d); el<D.rowind(d+1); ++el){
+      // Input (forward mode) or output (adjoint mode) nonzero seeded
+      int c = D.col(el);
+      seed_.push_back(c);
+
+      if(fwd_){
+        // The output nonzeros depending on the input nonzero
+        for(int el_out=jsp_trans.rowind(c); el_out<jsp_trans.rowind(c+1); ++el_out){
+          sens_.push_back(jsp_trans.col(el_out));
+          jac_nz_.push_back(mapping[el_out]);
+        }
+      } else {
+        // The input nonzeros influencing the output nonzero
+        for(int elJ=jsp.rowind(c); elJ<jsp.rowind(c+1); ++elJ){
+          sens_.push_back(jsp.col(elJ));
+          jac_nz_.push_back(elJ);
+        }
+      }
+    }
+    seed_ind_[d+1] = seed_.size();
+    sens_ind_[d+1] = sens_.size();
+  }
+
+  // Spread the directions over the threads, at most optimized_num_dir directions per sweep. The copies of the function
+  // must not share any state, which deepcopy only guarantees for reentrant functions, otherwise the sweeps are sequential
+  int nthread = fcn_.isReentrant() ? ThreadPool::getInstance().getNumThreads() : 1;
+  sweep_size_ = std::max(1,std::min(int(optimized_num_dir),(ndir_+nthread-1)/nthread));
+  if(fwd_){
+    fcn_.requestNumSens(sweep_size_,0);
+    sweep_size_ = std::min(sweep_size_,fcn_->nfdir_);
+  } else {
+    fcn_.requestNumSens(0,sweep_size_);
+    sweep_size_ = std::min(sweep_size_,fcn_->nadir_);
+  }
+  casadi_assert_message(sweep_size_>0, "NumericJacobianInternal::init: the function does not allow any directional derivatives");
+  int nsweep = (ndir_+sweep_size_-1)/sweep_size_;
+  
+  // The calling thread works with the function itself, the other threads with copies
+  fcn_copy_.resize(nsweep>1 ? nthread : 1);
+  fcn_copy_[0] = fcn_;
+  for(int t=1; t<fcn_copy_.size(); ++t){
+    fcn_copy_[t] = deepcopy(fcn_);
+    if(!fcn_copy_[t].isInit()) fcn_copy_[t].init();
+    fcn_copy_[t].requestNumSens(fwd_ ? sweep_size_ : 0, fwd_ ? 0 : sweep_size_);
+  }
+}
+
+FX& NumericJacobianInternal::getGraph(){
+  if(graph_.isNull()){
+    // Wrap the function in an MXFunction and let it create the Jacobian from calls to the function
+    vector<MX> arg = fcn_->symbolicInput();
+    vector<MX> res = fcn_.call(arg);
+    FX f = MXFunction(arg,res);
+    f.setOption("numeric_jacobian", false);
+    f.setInputScheme(fcn_.getInputScheme());
+    f.init();
+    graph_ = f->getNumericJacobian(iind_,oind_,compact_,false);
+    graph_.init();
+  }
+  return graph_;
+}
+
+CRSSparsity NumericJacobianInternal::getJacSparsity(int iind, int oind, bool symmetric){
+  return getGraph()->jacSparsity(iind,oind,true,symmetric);
+}
+
+FX NumericJacobianInternal::getDerivative(int nfwd, int nadj){
+  return getGraph().derivative(nfwd,nadj);
+}
+
+FX NumericJacobianInternal::getJacobian(int iind, int oind, bool compact, bool symmetric){
+  return getGraph().jacobian(iind,oind,compact,symmetric);
+}
+
+namespace{
+  // Evaluate one sweep of directional derivatives
+  void numericJacobianTask(void* user_data, int task, int thread){
+    static_cast<NumericJacobianInternal*>(user_data)->evaluateSweep(task,thread);
+  }
+} // namespace
+
+void NumericJacobianInternal::evaluate(int nfdir, int nadir){
+  casadi_log("NumericJacobianInternal::evaluate(" << nfdir << ", " << nadir<< "):begin  " << getOption("name"));
+
+  // Directional derivatives of the Jacobian are calculated with the symbolic representation
+  if(nfdir>0 || nadir>0){
+    FX& g = getGraph();
+    g.requestNumSens(nfdir,nadir);
+    for(int i=0; i<getNumInputs(); ++i){
+      g.input(i).set(input(i));
+      for(int d=0; d<nfdir; ++d) g.fwdSeed(i,d).set(fwdSeed(i,d));
+    }
+    for(int i=0; i<getNumOutputs(); ++i){
+      for(int d=0; d<nadir; ++d) g.adjSeed(i,d).set(adjSeed(i,d));
+    }
+    g.evaluate(nfdir,nadir);
+    for(int i=0; i<getNumOutputs(); ++i){
+      g.output(i).get(output(i));
+      for(int d=0; d<nfdir; ++d) g.fwdSens(i,d).get(fwdSens(i,d));
+    }
+    for(int i=0; i<getNumInputs(); ++i){
+      for(int d=0; d<nadir; ++d) g.adjSens(i,d).get(adjSens(i,d));
+    }
+    return;
+  }
+
+  // Evaluate the sweeps, the first one also gives the nondifferentiated outputs
+  int nsweep = std::max(1,(ndir_+sweep_size_-1)/sweep_size_);
+  if(fcn_copy_.size()==1){
+    for(int sweep=0; sweep<nsweep; ++sweep){
+      evaluateSweep(sweep,0);
+    }
+  } else {
+    ThreadPool::getInstance().run(numericJacobianTask,this,nsweep);
+  }
+  casadi_log("NumericJacobianInternal::evaluate(" << nfdir << ", " << nadir<< "):end  " << getOption("name"));
+}
+
+void NumericJacobianInternal::evaluateSweep(int sweep, int thread){
+  // The copy of the function used by the thread
+  FX& f = fcn_copy_.at(thread);
+
+  // Directions treated in the sweep
+  int offset = sweep*sweep_size_;
+  int ndir = std::max(0,std::min(ndir_-offset,sweep_size_));
+
+  // Pass the arguments
+  for(int i=0; i<getNumInputs(); ++i){
+    f.input(i).set(input(i));
+  }
+
+  // Pass the seeds
+  for(int d=0; d<ndir; ++d){
+    if(fwd_){
+      for(int i=0; i<f.getNumInputs(); ++i) f.fwdSeed(i,d).setZero();
+    } else {
+      for(int i=0; i<f.getNumOutputs(); ++i) f.adjSeed(i,d).setZero();
+    }
+    vector<double>& seed = fwd_ ? f.fwdSeed(iind_,d).data() : f.adjSeed(oind_,d).data();
+    for(int k=seed_ind_[offset+d]; k<seed_ind_[offset+d+1]; ++k){
+      seed[seed_[k]] = 1;
+    }
+  }
+  
+  // Evaluate
+  f.evaluate(fwd_ ? ndir : 0, fwd_ ? 0 : ndir);
+
+  // Get the outputs if first sweep
+  if(sweep==0){
+    for(int i=0; i<f.getNumOutputs(); ++i){
+      f.output(i).get(output(1+i));
+    }
+  }
+
+  // Scatter the sensitivities into the Jacobian, the sweeps write to different nonzeros
+  vector<double>& jac = output(0).data();
+  for(int d=0; d<ndir; ++d){
+    const vector<double>& sens = fwd_ ? f.fwdSens(oind_,d).data() : f.adjSens(iind_,d).data();
+    for(int k=sens_ind_[offset+d]; k<sens_ind_[offset+d+1]; ++k){
+      jac[jac_nz_[k]] = sens[sens_[k]];
+    }
+  }
+}
+
+} // namespace CasADi
+
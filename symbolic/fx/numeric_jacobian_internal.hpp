@@ -0,0 +1,103 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef NUMERIC_JACOBIAN_INTERNAL_HPP
+#define NUMERIC_JACOBIAN_INTERNAL_HPP
+
+#include <vector>
+#include "numeric_jacobian.hpp"
+#include "fx_internal.hpp"
+
+namespace CasADi{
+ 
+  /** \brief  Internal node class for NumericJacobian
+*/
+class NumericJacobianInternal : public FXInternal{
+  friend class NumericJacobian;
+  public:
+    
+    /// New constructor
+    NumericJacobianInternal(const FX& fcn, int iind, int oind, bool compact);
+
+    /// Clone
+    virtual NumericJacobianInternal* clone() const;
+
+    /// Deep copy data members
+    virtual void deepCopyMembers(std::map<SharedObjectNode*,SharedObject>& already_copied);
+    
+    /// Destructor
+    virtual ~NumericJacobianInternal();
+      
+    /// Evaluate the jacobian
+    virtual void evaluate(int nfdir, int nadir);
+
+    /// Initialize
+    virtual void init();
+
+    /// Evaluate one sweep of directional derivatives using the copy of the function of a thread
+    void evaluateSweep(int sweep, int thread);
+
+    /// Jacobian sparsity, taken from the symbolic representation
+    virtual CRSSparsity getJacSparsity(int iind, int oind, bool symmetric);
+
+    /// Derivatives are calculated using the symbolic representation
+    virtual FX getDerivative(int nfwd, int nadj);
+
+    /// Jacobians are calculated using the symbolic representation
+    virtual FX getJacobian(int iind, int oind, bool compact, bool symmetric);
+
+    /// Get an equivalent function made up of calls to the function, created on first use
+    FX& getGraph();
+  
+    // Function to be differentiated
+    FX fcn_;
+
+    // Jacobian block
+    int iind_, oind_;
+    bool compact_;
+
+    // Copy of the function for each thread, the first one is fcn_ itself
+    std::vector<FX> fcn_copy_;
+
+    // Equivalent function made up of calls to the function, used for derivatives
+    FX graph_;
+
+    // Use forward mode directional derivatives?
+    bool fwd_;
+    
+    // Number of directions and number of directions per sweep
+    int ndir_, sweep_size_;
+    
+    // For each direction, the seeded nonzeros in seed_[seed_ind_[d]] to seed_[seed_ind_[d+1]-1]
+    std::vector<int> seed_ind_, seed_;
+
+    // For each direction, the sensitivity nonzeros sens_[k] going to the Jacobian nonzeros jac_nz_[k], 
+    // for k in sens_ind_[d] to sens_ind_[d+1]-1. No two directions write to the same Jacobian nonzero.
+    std::vector<int> sens_ind_, sens_, jac_nz_;
+};
+
+} // namespace CasADi
+
+
+#endif // NUMERIC_JACOBIAN_INTERNAL_HPP
+
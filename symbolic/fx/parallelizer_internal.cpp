@@ -22,23 +22,42 @@
 
 #include "parallelizer_internal.hpp"
 #include "mx_function.hpp"
+#include "../thread_pool.hpp"
 #include <algorithm>
+#include <cstdio>
+#include <cerrno>
 #ifdef WITH_OPENMP
 #include <omp.h>
 #endif //WITH_OPENMP
+#ifndef _WIN32
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif // MSG_NOSIGNAL
+#endif // _WIN32
 
 using namespace std;
 
 namespace CasADi{
   
   ParallelizerInternal::ParallelizerInternal(const std::vector<FX>& funcs) : funcs_(funcs){
-    addOption("parallelization", OT_STRING, "serial","","serial|openmp|mpi"); 
+    addOption("parallelization", OT_STRING, "serial","Parallelization mode. With \"mpi\", the tasks are evaluated in local worker processes","serial|openmp|mpi|threads"); 
+    addOption("num_workers",     OT_INTEGER, 0, "Number of worker processes when parallelization is \"mpi\". 0 means one per processor, at most one per task");
+    workers_owner_ = 0;
   }
 
   ParallelizerInternal::~ParallelizerInternal(){
+    stopWorkers();
   }
 
   void ParallelizerInternal::init(){
+    // Worker processes hold copies of the functions, which are about to be reinitialized
+    stopWorkers();
+
     // Get mode
     if(getOption("parallelization")=="serial"){
       mode_ = SERIAL;
@@ -46,6 +65,8 @@ namespace CasADi{
       mode_ = OPENMP;
     } else if(getOption("parallelization")=="mpi") {
       mode_ = MPI;
+    } else if(getOption("parallelization")=="threads") {
+      mode_ = THREADS;
     } else {
       casadi_error("Parallelization mode " << getOption("parallelization") << " unknown.");
     }
@@ -57,6 +78,14 @@ namespace CasADi{
       mode_ = SERIAL;
     }
 #endif // WITH_OPENMP
+
+    // Worker processes are only available on POSIX systems
+#ifdef _WIN32
+    if(mode_ == MPI){
+      casadi_warning("Parallelization with worker processes is not available on Windows, switching to serial mode.");
+      mode_ = SERIAL;
+    }
+#endif // _WIN32
     
     // Check if a node is a copy of another
     copy_of_.resize(funcs_.size(),-1);
@@ -76,8 +105,8 @@ namespace CasADi{
       // Initialize
       it->init(false);
     
-      // Make sure that the functions are unique if we are using OpenMP
-      if(mode_==OPENMP && it!=funcs_.begin())
+      // Make sure that the functions are unique if we are using OpenMP or threads
+      if((mode_==OPENMP || mode_==THREADS) && it!=funcs_.begin())
         it->makeUnique();
     
     }
@@ -107,6 +136,24 @@ namespace CasADi{
 
     // Allocate memory for directional derivatives
     ParallelizerInternal::updateNumSens(false);
+
+    // No timings available yet
+    task_cputime_.clear();
+    
+    // Allocate memory for evaluating the tasks directly on the inputs and outputs
+    int ntask = funcs_.size();
+    task_arg_.resize(ntask);
+    task_res_.resize(ntask);
+    task_iw_.resize(ntask);
+    task_w_.resize(ntask);
+    for(int task=0; task<ntask; ++task){
+      task_arg_[task].resize(funcs_[task].getNumInputs());
+      task_res_[task].resize(funcs_[task].getNumOutputs());
+      size_t ni, nr;
+      funcs_[task].nWork(ni,nr);
+      task_iw_[task].resize(ni);
+      task_w_[task].resize(nr);
+    }
   }
 
   void ParallelizerInternal::evaluate(int nfdir, int nadir){
@@ -162,14 +209,406 @@ namespace CasADi{
       casadi_error("ParallelizerInternal::evaluate: OPENMP support was not available during CasADi compilation");
 #endif //WITH_OPENMP
     } else if(mode_ == MPI){
-      casadi_error("ParallelizerInternal::evaluate: MPI not implemented");
+      evaluateProcesses(nfdir,nadir);
+    } else if(mode_ == THREADS){
+      evaluateThreads(nfdir,nadir);
+    }
+  }
+
+  namespace{
+    // Data passed to the tasks executed by the thread pool
+    struct ParallelizerTaskData{
+      ParallelizerInternal* self;
+      int nfdir, nadir;
+      std::vector<double> starttime, endtime;
+    };
+
+    // Evaluate one task and time it
+    void parallelizerTask(void* user_data, int task, int thread){
+      ParallelizerTaskData* d = static_cast<ParallelizerTaskData*>(user_data);
+      d->starttime[task] = ThreadPool::getWallTime();
+      d->self->evaluateTask(task,d->nfdir,d->nadir);
+      d->endtime[task] = ThreadPool::getWallTime();
+    }
+  } // namespace
+
+  void ParallelizerInternal::evaluateThreads(int nfdir, int nadir){
+    int ntask = funcs_.size();
+    ParallelizerTaskData d;
+    d.self = this;
+    d.nfdir = nfdir;
+    d.nadir = nadir;
+    d.starttime.resize(ntask);
+    d.endtime.resize(ntask);
+    
+    // Expensive tasks are started first, using the timings of the last evaluation
+    const double* cost = task_cputime_.size()==ntask ? getPtr(task_cputime_) : 0;
+
+    // Evaluate all tasks
+    ThreadPool& pool = ThreadPool::getInstance();
+    std::vector<int> task_allocation;
+    pool.run(parallelizerTask,&d,ntask,cost,&task_allocation);
+
+    // Save the timings for the next evaluation
+    task_cputime_.resize(ntask);
+    for(int task=0; task<ntask; ++task){
+      task_cputime_[task] = d.endtime[task] - d.starttime[task];
+    }
+
+    if (gather_stats_) {
+      // Order in which the tasks were started
+      std::vector<std::pair<double,int> > start_task(ntask);
+      for(int task=0; task<ntask; ++task) start_task[task] = make_pair(d.starttime[task],task);
+      std::sort(start_task.begin(),start_task.end());
+      std::vector<int> task_order(ntask);
+      for(int i=0; i<ntask; ++i) task_order[start_task[i].second] = i;
+
+      // Measure all times relative to the earliest start time
+      double start = ntask>0 ? start_task.front().first : 0;
+      for(int task=0; task<ntask; ++task){
+        d.starttime[task] -= start;
+        d.endtime[task] -= start;
+      }
+      
+      stats_["num_threads"] = pool.getNumThreads();
+      stats_["task_allocation"] = task_allocation;
+      stats_["task_order"] = task_order;
+      stats_["task_cputime"] = task_cputime_;
+      stats_["task_starttime"] = d.starttime;
+      stats_["task_endtime"] = d.endtime;
+    }
+  }
+
+  namespace{
+    // Collect the data exchanged with a worker process for a task: either the arguments 
+    // (inputs and seeds) or the results (outputs, sensitivities)
+    void getTaskData(ParallelizerInternal& p, int task, int nfdir, int nadir, bool arguments, std::vector<Matrix<double>*>& v){
+      v.clear();
+      for(int j=p.inind_[task]; j<p.inind_[task+1]; ++j){
+        v.push_back(arguments ? &p.input(j) : 0);
+        for(int dir=0; dir<nfdir; ++dir) v.push_back(arguments ? &p.fwdSeed(j,dir) : 0);
+        for(int dir=0; dir<nadir; ++dir) v.push_back(arguments ? 0 : &p.adjSens(j,dir));
+      }
+      for(int j=p.outind_[task]; j<p.outind_[task+1]; ++j){
+        v.push_back(arguments ? 0 : &p.output(j));
+        for(int dir=0; dir<nfdir; ++dir) v.push_back(arguments ? 0 : &p.fwdSens(j,dir));
+        for(int dir=0; dir<nadir; ++dir) v.push_back(arguments ? &p.adjSeed(j,dir) : 0);
+      }
+      v.erase(std::remove(v.begin(),v.end(),static_cast<Matrix<double>*>(0)),v.end());
+    }
+    
+    // Append the nonzeros of a set of matrices to a buffer
+    void packTaskData(const std::vector<Matrix<double>*>& v, std::vector<double>& buf){
+      for(std::vector<Matrix<double>*>::const_iterator it=v.begin(); it!=v.end(); ++it){
+        buf.insert(buf.end(),(*it)->begin(),(*it)->end());
+      }
+    }
+
+    // Read the nonzeros of a set of matrices from a buffer, returns the position after the data
+    const double* unpackTaskData(const std::vector<Matrix<double>*>& v, const double* buf){
+      for(std::vector<Matrix<double>*>::const_iterator it=v.begin(); it!=v.end(); ++it){
+        std::copy(buf,buf+(*it)->size(),(*it)->begin());
+        buf += (*it)->size();
+      }
+      return buf;
+    }
+    
+    // Number of nonzeros in a set of matrices
+    int sizeTaskData(const std::vector<Matrix<double>*>& v){
+      int ret = 0;
+      for(std::vector<Matrix<double>*>::const_iterator it=v.begin(); it!=v.end(); ++it){
+        ret += (*it)->size();
+      }
+      return ret;
+    }
+
+#ifndef _WIN32
+    // Send a block of data, returns false if the connection is broken
+    bool sendAll(int fd, const void* data, size_t n){
+      const char* p = static_cast<const char*>(data);
+      while(n>0){
+        ssize_t r = send(fd,p,n,MSG_NOSIGNAL);
+        if(r<0){
+          if(errno==EINTR) continue;
+          return false;
+        }
+        p += r;
+        n -= r;
+      }
+      return true;
+    }
+
+    // Receive a block of data, returns false if the connection is broken
+    bool recvAll(int fd, void* data, size_t n){
+      char* p = static_cast<char*>(data);
+      while(n>0){
+        ssize_t r = recv(fd,p,n,0);
+        if(r<0){
+          if(errno==EINTR) continue;
+          return false;
+        }
+        if(r==0) return false;
+        p += r;
+        n -= r;
+      }
+      return true;
+    }
+#endif // _WIN32
+  } // namespace
+
+  void ParallelizerInternal::startWorkers(){
+#ifndef _WIN32
+    // Number of worker processes
+    int ntask = funcs_.size();
+    int nw = getOption("num_workers");
+    if(nw<=0) nw = ThreadPool::getNumProcessors();
+    nw = std::max(1,std::min(nw,ntask));
+    
+    // Make sure that buffered output is not duplicated in the workers
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(0);
+    
+    // Start the workers, each getting a copy of the initialized functions. Only the forking thread
+    // exists in a worker, so the thread pool executes all batches serially there (see ThreadPool::run).
+    // The workers must not be started from within a task of the thread pool, where other threads
+    // may hold locks that would never be released in the worker.
+    workers_owner_ = getpid();
+    for(int w=0; w<nw; ++w){
+      int sv[2];
+      casadi_assert_message(socketpair(AF_UNIX,SOCK_STREAM,0,sv)==0, "Parallelizer: Could not create socket pair, error code " << errno);
+      pid_t pid = fork();
+      if(pid<0){
+        close(sv[0]);
+        close(sv[1]);
+        stopWorkers(true);
+        casadi_error("Parallelizer: Could not start worker process, error code " << errno);
+      }
+      if(pid==0){
+        // Worker process: only keep the connection to the parent
+        close(sv[0]);
+        for(int k=0; k<workers_.size(); ++k) close(workers_[k].fd);
+        try{
+          workerLoop(sv[1]);
+        } catch(...){}
+        _exit(0);
+      }
+      close(sv[1]);
+      Worker wk;
+      wk.pid = pid;
+      wk.fd = sv[0];
+      workers_.push_back(wk);
+    }
+#endif // _WIN32
+  }
+
+  void ParallelizerInternal::stopWorkers(bool force){
+#ifndef _WIN32
+    // Only the process that started the workers may stop them
+    if(!workers_.empty() && workers_owner_==getpid()){
+      // Closing the connection makes the workers exit
+      for(int w=0; w<workers_.size(); ++w){
+        close(workers_[w].fd);
+        if(force && workers_[w].pid>0) kill(workers_[w].pid,SIGKILL);
+      }
+      
+      // Workers that have already been reaped have pid -1, which must not be passed on
+      for(int w=0; w<workers_.size(); ++w){
+        if(workers_[w].pid>0) waitpid(workers_[w].pid,0,0);
+      }
+    }
+#endif // _WIN32
+    workers_.clear();
+  }
+
+  void ParallelizerInternal::workerLoop(int fd){
+#ifndef _WIN32
+    std::vector<int> tasks;
+    std::vector<double> buf, times;
+    std::vector<Matrix<double>*> v;
+    while(true){
+      // Get the number of directions and the tasks to evaluate
+      int header[3];
+      if(!recvAll(fd,header,sizeof(header))) return;
+      int nfdir = header[0], nadir = header[1], ntask = header[2];
+      tasks.resize(ntask);
+      if(ntask>0 && !recvAll(fd,getPtr(tasks),ntask*sizeof(int))) return;
+      
+      // Make sure that enough directions are allocated
+      if(nfdir>nfdir_ || nadir>nadir_) requestNumSens(nfdir,nadir);
+      
+      // Get the arguments
+      int sz = 0;
+      for(int k=0; k<ntask; ++k){
+        getTaskData(*this,tasks[k],nfdir,nadir,true,v);
+        sz += sizeTaskData(v);
+      }
+      buf.resize(sz);
+      if(sz>0 && !recvAll(fd,getPtr(buf),sz*sizeof(double))) return;
+      const double* buf_ptr = getPtr(buf);
+      for(int k=0; k<ntask; ++k){
+        getTaskData(*this,tasks[k],nfdir,nadir,true,v);
+        buf_ptr = unpackTaskData(v,buf_ptr);
+      }
+      
+      // Evaluate
+      int status = 0;
+      std::string msg;
+      times.resize(ntask);
+      try{
+        for(int k=0; k<ntask; ++k){
+          double t0 = ThreadPool::getWallTime();
+          evaluateTask(tasks[k],nfdir,nadir);
+          times[k] = ThreadPool::getWallTime()-t0;
+        }
+      } catch(std::exception& ex){
+        status = 1;
+        msg = ex.what();
+      }
+      if(!sendAll(fd,&status,sizeof(status))) return;
+      
+      // Pass on the error message
+      if(status!=0){
+        int len = msg.size();
+        if(!sendAll(fd,&len,sizeof(len)) || !sendAll(fd,msg.c_str(),len)) return;
+        continue;
+      }
+      
+      // Return the results, followed by the time spent on each task
+      buf.clear();
+      for(int k=0; k<ntask; ++k){
+        getTaskData(*this,tasks[k],nfdir,nadir,false,v);
+        packTaskData(v,buf);
+      }
+      buf.insert(buf.end(),times.begin(),times.end());
+      if(!buf.empty() && !sendAll(fd,getPtr(buf),buf.size()*sizeof(double))) return;
+    }
+#endif // _WIN32
+  }
+
+  void ParallelizerInternal::evaluateProcesses(int nfdir, int nadir){
+#ifndef _WIN32
+    // Start the workers if needed
+    if(workers_.empty()) startWorkers();
+    int nw = workers_.size();
+    int ntask = funcs_.size();
+
+    // Assign the tasks, most expensive first, to the worker with the least work so far
+    std::vector<std::pair<double,int> > cost_task(ntask);
+    for(int task=0; task<ntask; ++task){
+      cost_task[task] = make_pair(task_cputime_.size()==ntask ? -task_cputime_[task] : 0.0, task);
+    }
+    std::stable_sort(cost_task.begin(),cost_task.end());
+    std::vector<std::vector<int> > tasks(nw);
+    std::vector<double> load(nw,0);
+    for(int i=0; i<ntask; ++i){
+      int w = std::min_element(load.begin(),load.end()) - load.begin();
+      tasks[w].push_back(cost_task[i].second);
+      load[w] += 1e-9 - cost_task[i].first;
+    }
+    
+    // Send the arguments to the workers
+    std::vector<double> buf;
+    std::vector<Matrix<double>*> v;
+    for(int w=0; w<nw; ++w){
+      int header[3] = {nfdir, nadir, int(tasks[w].size())};
+      buf.clear();
+      for(int k=0; k<tasks[w].size(); ++k){
+        getTaskData(*this,tasks[w][k],nfdir,nadir,true,v);
+        packTaskData(v,buf);
+      }
+      bool ok = sendAll(workers_[w].fd,header,sizeof(header));
+      ok = ok && (tasks[w].empty() || sendAll(workers_[w].fd,getPtr(tasks[w]),tasks[w].size()*sizeof(int)));
+      ok = ok && (buf.empty() || sendAll(workers_[w].fd,getPtr(buf),buf.size()*sizeof(double)));
+      if(!ok){
+        stopWorkers(true);
+        casadi_error("Parallelizer: Lost connection to worker process " << w << ".");
+      }
+    }
+    
+    // Collect the results
+    std::string error;
+    task_cputime_.resize(ntask);
+    std::vector<int> task_allocation(ntask);
+    for(int w=0; w<nw; ++w){
+      int fd = workers_[w].fd;
+      int status;
+      bool ok = recvAll(fd,&status,sizeof(status));
+      if(ok && status!=0){
+        // The evaluation failed in the worker
+        int len;
+        ok = recvAll(fd,&len,sizeof(len));
+        std::string msg(std::max(len,0),' ');
+        ok = ok && (len<=0 || recvAll(fd,&msg[0],len));
+        if(ok && error.empty()) error = msg;
+      } else if(ok){
+        // Get the results
+        int sz = tasks[w].size();
+        for(int k=0; k<tasks[w].size(); ++k){
+          getTaskData(*this,tasks[w][k],nfdir,nadir,false,v);
+          sz += sizeTaskData(v);
+        }
+        buf.resize(sz);
+        ok = sz==0 || recvAll(fd,getPtr(buf),sz*sizeof(double));
+        if(ok){
+          const double* buf_ptr = getPtr(buf);
+          for(int k=0; k<tasks[w].size(); ++k){
+            getTaskData(*this,tasks[w][k],nfdir,nadir,false,v);
+            buf_ptr = unpackTaskData(v,buf_ptr);
+          }
+          for(int k=0; k<tasks[w].size(); ++k){
+            task_cputime_[tasks[w][k]] = *buf_ptr++;
+            task_allocation[tasks[w][k]] = w;
+          }
+        }
+      }
+      
+      // The worker died
+      if(!ok){
+        int wstatus = 0;
+        waitpid(workers_[w].pid,&wstatus,0);
+        workers_[w].pid = -1;
+        stopWorkers(true);
+        task_cputime_.clear();
+        if(WIFSIGNALED(wstatus)){
+          casadi_error("Parallelizer: Worker process " << w << " was terminated by signal " << WTERMSIG(wstatus) << ".");
+        } else {
+          casadi_error("Parallelizer: Worker process " << w << " terminated unexpectedly.");
+        }
+      }
+    }
+    
+    // Pass on errors
+    if(!error.empty()){
+      casadi_error("Parallelizer: Evaluation failed in worker process: " << error);
+    }
+    
+    if (gather_stats_) {
+      stats_["num_workers"] = nw;
+      stats_["task_allocation"] = task_allocation;
+      stats_["task_cputime"] = task_cputime_;
     }
+#endif // _WIN32
   }
 
   void ParallelizerInternal::evaluateTask(int task, int nfdir, int nadir){
   
     // Get a reference to the function
     FX& fcn = funcs_[task];
+    
+    // Without derivatives, the function reads and writes the data of the parallelizer directly
+    if(nfdir==0 && nadir==0){
+      std::vector<const double*>& arg = task_arg_[task];
+      std::vector<double*>& res = task_res_[task];
+      for(int j=inind_[task]; j<inind_[task+1]; ++j){
+        arg[j-inind_[task]] = getPtr(input(j).data());
+      }
+      for(int j=outind_[task]; j<outind_[task+1]; ++j){
+        res[j-outind_[task]] = getPtr(output(j).data());
+      }
+      fcn.evaluate(getPtr(arg),getPtr(res),getPtr(task_iw_[task]),getPtr(task_w_[task]));
+      return;
+    }
   
     // Copy inputs to functions
     for(int j=inind_[task]; j<inind_[task+1]; ++j){
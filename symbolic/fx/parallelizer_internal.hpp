@@ -47,6 +47,7 @@ class ParallelizerInternal : public FXInternal{
       for(std::vector<FX>::iterator it=ret->funcs_.begin(); it!=ret->funcs_.end(); ++it){
         it->makeUnique();
       }
+      ret->workers_.clear();
       return ret;
     }
     
@@ -102,10 +103,50 @@ class ParallelizerInternal : public FXInternal{
     std::vector<int> copy_of_;
     
     /// Parallelization modes
-    enum Mode{SERIAL,OPENMP,MPI};
+    enum Mode{SERIAL,OPENMP,MPI,THREADS};
     
     /// Mode
     Mode mode_;
+
+    /// Evaluate all tasks using the thread pool
+    void evaluateThreads(int nfdir, int nadir);
+
+    /// Wall time of each task in the last evaluation, used to order the tasks
+    std::vector<double> task_cputime_;
+
+    /// Pointers to the inputs and outputs of each task, bound directly when no derivatives are requested
+    std::vector<std::vector<const double*> > task_arg_;
+    std::vector<std::vector<double*> > task_res_;
+    
+    /// Work vectors for each task
+    std::vector<std::vector<int> > task_iw_;
+    std::vector<std::vector<double> > task_w_;
+
+    /// Evaluate all tasks in worker processes
+    void evaluateProcesses(int nfdir, int nadir);
+    
+    /// Start the worker processes
+    void startWorkers();
+    
+    /// Stop the worker processes, killing them if force is true
+    void stopWorkers(bool force=false);
+    
+    /// Main loop of a worker process
+    void workerLoop(int fd);
+
+    /// A worker process
+    struct Worker{
+      /// Process id
+      int pid;
+      /// Socket connected to the worker
+      int fd;
+    };
+    
+    /// Worker processes, only valid in the process that started them
+    std::vector<Worker> workers_;
+    
+    /// Process that started the workers
+    int workers_owner_;
 };
 
 
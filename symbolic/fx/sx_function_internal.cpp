@@ -22,6 +22,7 @@
 
 #include "sx_function_internal.hpp"
 #include <cassert>
+#include <cstring>
 #include <limits>
 #include <stack>
 #include <deque>
@@ -31,10 +32,12 @@
 #include "../stl_vector_tools.hpp"
 #include "../sx/sx_tools.hpp"
 #include "../sx/sx_node.hpp"
+#include "../sx/constant_sx.hpp"
 #include "../casadi_types.hpp"
 #include "../matrix/crs_sparsity_internal.hpp"
-#include "../profiling.hpp"
 #include "../casadi_options.hpp"
+#include "external_function_internal.hpp"
+#include "compiler_cache.hpp"
 
 #ifdef WITH_LLVM
 #include "llvm/DerivedTypes.h"
@@ -63,6 +66,10 @@ namespace CasADi{
     addOption("just_in_time", OT_BOOLEAN,false,"Just-in-time compilation for numeric evaluation (experimental)");
     addOption("just_in_time_sparsity", OT_BOOLEAN,false,"Propagate sparsity patterns using just-in-time compilation to a CPU or GPU using OpenCL");
     addOption("just_in_time_opencl", OT_BOOLEAN,false,"Just-in-time compilation for numeric evaluation using OpenCL (experimental)");
+    addOption("just_in_time_native", OT_BOOLEAN,false,"Just-in-time compilation for numeric evaluation by compiling the generated C code with the system compiler (requires WITH_DL)");
+    addOption("just_in_time_compiler", OT_STRING,"gcc -fPIC -O2","Compiler command used for \"just_in_time_native\"");
+    addOption("compact_algorithm", OT_BOOLEAN,true,"Evaluate numerically using a compact representation of the algorithm with fused operations");
+    addOption("threaded_interpreter", OT_BOOLEAN,true,"Evaluate the compact algorithm with a direct-threaded interpreter, if supported by the compiler");
 
     // Check for duplicate entries among the input expressions
     bool has_duplicates = false;
@@ -112,15 +119,115 @@ namespace CasADi{
 #endif // WITH_OPENCL
   }
 
-  void SXFunctionInternal::evaluate(int nfdir, int nadir){
-  
-    double time_start;
-    double time_stop;
-    if (CasadiOptions::profiling) {
-      time_start = getRealTime();
-      CasadiOptions::profilingLog  << "start " << this << ":" <<getOption("name") << std::endl; 
+  void SXFunctionInternal::evaluate(const double** arg, double** res, int* iw, double* w){
+    if (!free_vars_.empty()) {
+      std::stringstream ss;
+      repr(ss);
+      casadi_error("Cannot evaluate \"" << ss.str() << "\" since variables " << free_vars_ << " are free.");
+    }
+
+    if(just_in_time_native_){
+      // Evaluate the natively compiled function
+      jit_native_fcn_[0][0]->evaluate(arg,res,iw,w);
+      return;
+    }
+
+    // Evaluate the compact algorithm, using w as the work vector
+    if(compact_algorithm_){
+      evaluateCompact(arg,res,w);
+      return;
+    }
+
+    // Evaluate the algorithm, using w as the work vector
+    for(vector<AlgEl>::const_iterator it=algorithm_.begin(); it!=algorithm_.end(); ++it){
+      switch(it->op){
+        // Start by adding all of the built operations
+        CASADI_MATH_FUN_BUILTIN(w[it->i1],w[it->i2],w[it->i0])
+        
+        // Constant
+      case OP_CONST: w[it->i0] = it->d; break;
+        
+        // Load function input to work vector
+      case OP_INPUT: w[it->i0] = arg[it->i1]==0 ? 0 : arg[it->i1][it->i2]; break;
+        
+        // Get function output from work vector
+      case OP_OUTPUT: if(res[it->i0]!=0) res[it->i0][it->i2] = w[it->i1]; break;
+      }
+    }
+  }
+
+  void SXFunctionInternal::nWork(size_t& ni, size_t& nr) const{
+    if(just_in_time_native_){
+      jit_native_fcn_.front().front()->nWork(ni,nr);
+    } else {
+      ni = 0;
+      nr = work_.size();
+    }
+  }
+
+  void SXFunctionInternal::nWorkBatch(int n, size_t& ni, size_t& nr) const{
+    if(just_in_time_native_){
+      nWork(ni,nr);
+    } else {
+      ni = 0;
+      nr = work_.size()*std::max(1,std::min(n,int(batch_group_size)));
+    }
+  }
+
+  void SXFunctionInternal::evaluateBatch(int n, const double** arg, double** res, int* iw, double* w){
+    if(just_in_time_native_){
+      FXInternal::evaluateBatch(n,arg,res,iw,w);
+      return;
+    }
+    
+    if (!free_vars_.empty()) {
+      std::stringstream ss;
+      repr(ss);
+      casadi_error("Cannot evaluate \"" << ss.str() << "\" since variables " << free_vars_ << " are free.");
     }
     
+    // Number of nonzeros of the inputs and outputs
+    vector<int> nnz_in(getNumInputs()), nnz_out(getNumOutputs());
+    for(int ind=0; ind<nnz_in.size(); ++ind) nnz_in[ind] = inputNoCheck(ind).size();
+    for(int ind=0; ind<nnz_out.size(); ++ind) nnz_out[ind] = outputNoCheck(ind).size();
+
+    // Evaluate the algorithm for groups of evaluations, element i of the work vector for evaluation l of the group is w[i*ng+l]
+    const int ng = std::max(1,std::min(n,int(batch_group_size)));
+    for(int j0=0; j0<n; j0+=ng){
+      const int nj = std::min(ng,n-j0);
+      for(vector<AlgEl>::const_iterator it=algorithm_.begin(); it!=algorithm_.end(); ++it){
+        double* w0 = w + it->i0*ng;
+        switch(it->op){
+          // Start by adding all of the built operations
+          CASADI_MATH_FUN_BUILTIN_GEN(BinaryOperationVV,w + it->i1*ng,w + it->i2*ng,w0,nj)
+        
+          // Constant
+        case OP_CONST: std::fill(w0,w0+nj,it->d); break;
+        
+          // Load function input to work vector
+        case OP_INPUT:
+          if(arg[it->i1]==0){
+            std::fill(w0,w0+nj,0.0);
+          } else {
+            const double* a = arg[it->i1] + j0*nnz_in[it->i1] + it->i2;
+            for(int l=0; l<nj; ++l) w0[l] = a[l*nnz_in[it->i1]];
+          }
+          break;
+        
+          // Get function output from work vector
+        case OP_OUTPUT:
+          if(res[it->i0]!=0){
+            double* r = res[it->i0] + j0*nnz_out[it->i0] + it->i2;
+            const double* w1 = w + it->i1*ng;
+            for(int l=0; l<nj; ++l) r[l*nnz_out[it->i0]] = w1[l];
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  void SXFunctionInternal::evaluate(int nfdir, int nadir){
     casadi_log("SXFunctionInternal::evaluate(" << nfdir << ", " << nadir<< "):begin  " << getOption("name"));
     // Compiletime optimization for certain common cases
     switch(nfdir){
@@ -134,11 +241,6 @@ namespace CasADi{
       evaluateGen1(int_runtime(nfdir),nadir); break;
     }
     casadi_log("SXFunctionInternal::evaluate(" << nfdir << ", " << nadir<< "):end " << getOption("name"));
-    
-    if (CasadiOptions::profiling) {
-      time_stop = getRealTime();
-      CasadiOptions::profilingLog  << double(time_stop-time_start)*1e6 << " ns | " << double(time_stop-time_start)*1e3 << " ms | " << this << ":" <<getOption("name") << ":0||SX algorithm size: " << algorithm_.size() << std::endl; 
-    }
   }
 
   template<typename T1>
@@ -178,6 +280,12 @@ namespace CasADi{
     }
 #endif // WITH_LLVM
   
+    if(just_in_time_native_){
+      // Evaluate the natively compiled function
+      evaluateNativeJIT(nfdir,nadir);
+      return;
+    }
+  
 #ifdef WITH_OPENCL
     if(just_in_time_opencl_ && nfdir==0 && nadir==0){
       // Evaluate with OpenCL
@@ -190,7 +298,11 @@ namespace CasADi{
     const bool taping = nfdir>0 || nadir>0;
 
     // Evaluate the algorithm
-    if(!taping){
+    if(!taping && compact_algorithm_){
+      for(int ind=0; ind<compact_arg_.size(); ++ind) compact_arg_[ind] = inputNoCheck(ind).ptr();
+      for(int ind=0; ind<compact_res_.size(); ++ind) compact_res_[ind] = outputNoCheck(ind).ptr();
+      evaluateCompact(getPtr(compact_arg_),getPtr(compact_res_),getPtr(work_));
+    } else if(!taping){
       for(vector<AlgEl>::iterator it=algorithm_.begin(); it!=algorithm_.end(); ++it){
         switch(it->op){
           // Start by adding all of the built operations
@@ -228,49 +340,459 @@ namespace CasADi{
     // Quick return if no sensitivities
     if(!taping) return;
 
-    // Calculate forward sensitivities
-    for(int dir=0; dir<nfdir; ++dir){
+    // Make sure that the work vector for the directional derivatives is large enough
+    const int nlanes = std::max(nfdir,nadir);
+    if(dwork_.size() < work_.size()*nlanes) dwork_.resize(work_.size()*nlanes);
+
+    // Calculate all forward sensitivities in a single sweep, nfdir lanes per element of the work vector
+    if(nfdir>0){
       vector<TapeEl<double> >::const_iterator it2 = pdwork_.begin();
       for(vector<AlgEl>::const_iterator it = algorithm_.begin(); it!=algorithm_.end(); ++it){
+        double* w0 = getPtr(dwork_) + it->i0*nfdir;
         switch(it->op){
         case OP_CONST:
-          work_[it->i0] = 0; break;
+          for(int dir=0; dir<nfdir; ++dir) w0[dir] = 0;
+          break;
         case OP_INPUT: 
-          work_[it->i0] = fwdSeedNoCheck(it->i1,dir).data()[it->i2]; break;
+          for(int dir=0; dir<nfdir; ++dir) w0[dir] = fwdSeedNoCheck(it->i1,dir).data()[it->i2];
+          break;
         case OP_OUTPUT: 
-          fwdSensNoCheck(it->i0,dir).data()[it->i2] = work_[it->i1]; break;
+          {
+            const double* w1 = getPtr(dwork_) + it->i1*nfdir;
+            for(int dir=0; dir<nfdir; ++dir) fwdSensNoCheck(it->i0,dir).data()[it->i2] = w1[dir];
+          }
+          break;
         default: // Unary or binary operation
-          work_[it->i0] = it2->d[0] * work_[it->i1] + it2->d[1] * work_[it->i2]; ++it2; break;
+          {
+            const double* w1 = getPtr(dwork_) + it->i1*nfdir;
+            const double* w2 = getPtr(dwork_) + it->i2*nfdir;
+            const double d0 = it2->d[0], d1 = it2->d[1];
+            for(int dir=0; dir<nfdir; ++dir) w0[dir] = d0 * w1[dir] + d1 * w2[dir];
+            ++it2;
+          }
         }
       }
     }
     
-    // Calculate adjoint sensitivities
-    if(nadir>0) fill(work_.begin(),work_.end(),0);
-    for(int dir=0; dir<nadir; ++dir){
+    // Calculate all adjoint sensitivities in a single sweep, nadir lanes per element of the work vector
+    if(nadir>0){
+      fill_n(dwork_.begin(),work_.size()*nadir,0);
       vector<TapeEl<double> >::const_reverse_iterator it2 = pdwork_.rbegin();
       for(vector<AlgEl>::const_reverse_iterator it = algorithm_.rbegin(); it!=algorithm_.rend(); ++it){
-        double seed;
+        double* w0 = getPtr(dwork_) + it->i0*nadir;
         switch(it->op){
         case OP_CONST:
-          work_[it->i0] = 0;
+          for(int dir=0; dir<nadir; ++dir) w0[dir] = 0;
           break;
         case OP_INPUT:
-          adjSensNoCheck(it->i1,dir).data()[it->i2] = work_[it->i0];
-          work_[it->i0] = 0;
+          for(int dir=0; dir<nadir; ++dir){
+            adjSensNoCheck(it->i1,dir).data()[it->i2] = w0[dir];
+            w0[dir] = 0;
+          }
           break;
         case OP_OUTPUT:
-          work_[it->i1] += adjSeedNoCheck(it->i0,dir).data()[it->i2];
+          {
+            double* w1 = getPtr(dwork_) + it->i1*nadir;
+            for(int dir=0; dir<nadir; ++dir) w1[dir] += adjSeedNoCheck(it->i0,dir).data()[it->i2];
+          }
           break;
         default: // Unary or binary operation
-          seed = work_[it->i0];
-          work_[it->i0] = 0;
-          work_[it->i1] += it2->d[0] * seed;
-          work_[it->i2] += it2->d[1] * seed;
-          ++it2;
+          {
+            double* w1 = getPtr(dwork_) + it->i1*nadir;
+            double* w2 = getPtr(dwork_) + it->i2*nadir;
+            const double d0 = it2->d[0], d1 = it2->d[1];
+            for(int dir=0; dir<nadir; ++dir){
+              double seed = w0[dir];
+              w0[dir] = 0;
+              w1[dir] += d0 * seed;
+              w2[dir] += d1 * seed;
+            }
+            ++it2;
+          }
+        }
+      }
+    }
+  }
+
+  namespace{
+    /// Linear combination of work vector elements, summed in the same order as the original algorithm
+    template<typename I>
+    inline double dotIndexed(int n, const double* c, const I* x, const double* w){
+      double r = c[0]*w[x[0]];
+      for(int j=1; j<n; ++j) r += c[j]*w[x[j]];
+      return r;
+    }
+  } // namespace
+
+  template<typename I>
+  void SXFunctionInternal::evaluateCompact(const CompactAlgorithm<I>& alg, const double** arg, double** res, double* w){
+    // Use the direct-threaded interpreter, if available
+    if(!alg.handler.empty()){
+      evaluateThreaded(alg,arg,res,w);
+      return;
+    }
+    
+    const unsigned char* op = getPtr(alg.op);
+    const I *i0 = getPtr(alg.i0), *i1 = getPtr(alg.i1), *i2 = getPtr(alg.i2);
+    const double* d = getPtr(alg.d);
+    const I* dot_x = getPtr(alg.dot_x);
+    const double* dot_c = getPtr(alg.dot_c);
+    const int n = alg.op.size();
+    for(int k=0; k<n; ++k){
+      switch(op[k]){
+        // Start by adding all of the built operations
+        CASADI_MATH_FUN_BUILTIN(w[i1[k]],w[i2[k]],w[i0[k]])
+        
+        // Constant from the pool
+      case OP_CONST: w[i0[k]] = d[i1[k]]; break;
+        
+        // Load function input to work vector
+      case OP_INPUT: w[i0[k]] = arg[i1[k]]==0 ? 0 : arg[i1[k]][i2[k]]; break;
+        
+        // Get function output from work vector
+      case OP_OUTPUT: if(res[i0[k]]!=0) res[i0[k]][i2[k]] = w[i1[k]]; break;
+
+        // Fused multiply-add, skip the element holding the addend
+      case OP_MULADD: w[i0[k]] = w[i1[k]]*w[i2[k]] + w[i1[k+1]]; ++k; break;
+
+        // Operations with a constant operand
+      case OP_ADD_CONST: w[i0[k]] = w[i1[k]] + d[i2[k]]; break;
+      case OP_SUB_CONST: w[i0[k]] = w[i1[k]] - d[i2[k]]; break;
+      case OP_CONST_SUB: w[i0[k]] = d[i2[k]] - w[i1[k]]; break;
+      case OP_MUL_CONST: w[i0[k]] = w[i1[k]] * d[i2[k]]; break;
+      case OP_DIV_CONST: w[i0[k]] = w[i1[k]] / d[i2[k]]; break;
+      case OP_CONST_DIV: w[i0[k]] = d[i2[k]] / w[i1[k]]; break;
+
+        // Linear combination with constant coefficients
+      case OP_DOT: w[i0[k]] = dotIndexed(i2[k],dot_c+i1[k],dot_x+i1[k],w); break;
+      }
+    }
+  }
+
+  // Operations with a handler of their own in the direct-threaded interpreter, in the order of its table of handlers.
+  // The less common built-in operations share a generic handler, which is followed by the exit handler in the table
+#define CASADI_THREADED_OPS(X) X(OP_ASSIGN) X(OP_ADD) X(OP_SUB) X(OP_MUL) X(OP_DIV) X(OP_NEG) X(OP_EXP) X(OP_LOG) \
+  X(OP_POW) X(OP_CONSTPOW) X(OP_SQRT) X(OP_SQ) X(OP_TWICE) X(OP_SIN) X(OP_COS) X(OP_TAN) X(OP_INV) X(OP_CONST) \
+  X(OP_INPUT) X(OP_OUTPUT) X(OP_PARAMETER) X(OP_MULADD) X(OP_ADD_CONST) X(OP_SUB_CONST) X(OP_CONST_SUB) \
+  X(OP_MUL_CONST) X(OP_DIV_CONST) X(OP_CONST_DIV) X(OP_DOT)
+
+  // The handler addresses are only valid in the copy of evaluateThreaded that returned them, so it must not be inlined or cloned
+#if defined(__GNUC__) && !defined(__clang__)
+#define CASADI_THREADED_ATTRIBUTES __attribute__((noinline,noclone))
+#elif defined(__GNUC__)
+#define CASADI_THREADED_ATTRIBUTES __attribute__((noinline))
+#else
+#define CASADI_THREADED_ATTRIBUTES
+#endif
+
+  template<typename I>
+  CASADI_THREADED_ATTRIBUTES void SXFunctionInternal::evaluateThreaded(const CompactAlgorithm<I>& alg, const double** arg, double** res, double* w, 
+                                                                       const void* const** handlers){
+#ifdef __GNUC__
+    // Handlers of the operations, the labels are only stored in this table
+#define CASADI_THREADED_LABEL(OP) &&l_##OP,
+    static const void* const table[] = {CASADI_THREADED_OPS(CASADI_THREADED_LABEL) &&l_generic, &&l_exit};
+#undef CASADI_THREADED_LABEL
+
+    // Return the table of handlers
+    if(handlers!=0){
+      *handlers = table;
+      return;
+    }
+
+    const void* const* h = getPtr(alg.handler);
+    const unsigned char* op = getPtr(alg.op);
+    const I *i0 = getPtr(alg.i0), *i1 = getPtr(alg.i1), *i2 = getPtr(alg.i2);
+    const double* d = getPtr(alg.d);
+    const I* dot_x = getPtr(alg.dot_x);
+    const double* dot_c = getPtr(alg.dot_c);
+    int k = 0;
+    goto *h[0];
+
+    // Built-in operations, dispatching directly to the handler of the next element
+#define CASADI_THREADED_BUILTIN(OP) l_##OP: BinaryOperation<OP>::fcn(w[i1[k]],w[i2[k]],w[i0[k]]); goto *h[++k];
+    CASADI_THREADED_BUILTIN(OP_ASSIGN)
+    CASADI_THREADED_BUILTIN(OP_ADD)
+    CASADI_THREADED_BUILTIN(OP_SUB)
+    CASADI_THREADED_BUILTIN(OP_MUL)
+    CASADI_THREADED_BUILTIN(OP_DIV)
+    CASADI_THREADED_BUILTIN(OP_NEG)
+    CASADI_THREADED_BUILTIN(OP_EXP)
+    CASADI_THREADED_BUILTIN(OP_LOG)
+    CASADI_THREADED_BUILTIN(OP_POW)
+    CASADI_THREADED_BUILTIN(OP_CONSTPOW)
+    CASADI_THREADED_BUILTIN(OP_SQRT)
+    CASADI_THREADED_BUILTIN(OP_SQ)
+    CASADI_THREADED_BUILTIN(OP_TWICE)
+    CASADI_THREADED_BUILTIN(OP_SIN)
+    CASADI_THREADED_BUILTIN(OP_COS)
+    CASADI_THREADED_BUILTIN(OP_TAN)
+    CASADI_THREADED_BUILTIN(OP_INV)
+#undef CASADI_THREADED_BUILTIN
+  l_generic: casadi_math<double>::fun(op[k],w[i1[k]],w[i2[k]],w[i0[k]]); goto *h[++k];
+  l_OP_CONST: w[i0[k]] = d[i1[k]]; goto *h[++k];
+  l_OP_INPUT: w[i0[k]] = arg[i1[k]]==0 ? 0 : arg[i1[k]][i2[k]]; goto *h[++k];
+  l_OP_OUTPUT: if(res[i0[k]]!=0) res[i0[k]][i2[k]] = w[i1[k]]; goto *h[++k];
+  l_OP_PARAMETER: goto *h[++k];
+  l_OP_MULADD: w[i0[k]] = w[i1[k]]*w[i2[k]] + w[i1[k+1]]; k+=2; goto *h[k];
+  l_OP_ADD_CONST: w[i0[k]] = w[i1[k]] + d[i2[k]]; goto *h[++k];
+  l_OP_SUB_CONST: w[i0[k]] = w[i1[k]] - d[i2[k]]; goto *h[++k];
+  l_OP_CONST_SUB: w[i0[k]] = d[i2[k]] - w[i1[k]]; goto *h[++k];
+  l_OP_MUL_CONST: w[i0[k]] = w[i1[k]] * d[i2[k]]; goto *h[++k];
+  l_OP_DIV_CONST: w[i0[k]] = w[i1[k]] / d[i2[k]]; goto *h[++k];
+  l_OP_CONST_DIV: w[i0[k]] = d[i2[k]] / w[i1[k]]; goto *h[++k];
+  l_OP_DOT: w[i0[k]] = dotIndexed(i2[k],dot_c+i1[k],dot_x+i1[k],w); goto *h[++k];
+  l_exit: return;
+#else // __GNUC__
+    // Computed goto not supported
+    if(handlers!=0){
+      *handlers = 0;
+    } else {
+      evaluateCompact(alg,arg,res,w);
+    }
+#endif // __GNUC__
+  }
+#undef CASADI_THREADED_ATTRIBUTES
+
+  template<typename I>
+  void SXFunctionInternal::initCompact(CompactAlgorithm<I>& alg, bool threaded) const{
+    int n = algorithm_.size();
+    
+    // Find the elements that computed the values read by each element, and the number of times each value is read
+    vector<int> src1(n,-1), src2(n,-1), nread(n,0), reader(n,-1);
+    vector<int> writer(work_.size(),-1); // Element that wrote the current value of each element of the work vector
+    for(int k=0; k<n; ++k){
+      const AlgEl& e = algorithm_[k];
+      int ndeps = casadi_math<double>::ndeps(e.op);
+      if(ndeps>=1){
+        src1[k] = writer[e.i1];
+        nread[src1[k]]++;
+        reader[src1[k]] = k;
+      }
+      if(ndeps==2){
+        src2[k] = writer[e.i2];
+        nread[src2[k]]++;
+        reader[src2[k]] = k;
+      }
+      if(e.op!=OP_OUTPUT) writer[e.i0] = k;
+    }
+    
+    // Generate the compact algorithm
+    alg = CompactAlgorithm<I>();
+    vector<int> stamp(n+work_.size(),-1), before, after, dot_x;
+    vector<double> dot_c;
+    for(int k=0; k<n; ++k){
+      const AlgEl& e = algorithm_[k];
+      int op = e.op, i0 = e.i0, i1 = e.i1, i2 = e.i2;
+      
+      // Linear combination with constant coefficients
+      if(e.op==OP_CONST || e.op==OP_MUL){
+        int end = findLinearCombination(k,4,src1,src2,nread,reader,stamp,before,after,dot_x,dot_c);
+        if(end>=0){
+          // The elements in between that are not part of the combination
+          for(vector<int>::const_iterator it=before.begin(); it!=before.end(); ++it){
+            const AlgEl& e_b = algorithm_[*it];
+            alg.op.push_back(e_b.op);
+            alg.i0.push_back(e_b.i0);
+            if(e_b.op==OP_CONST){
+              alg.i1.push_back(alg.d.size());
+              alg.i2.push_back(0);
+              alg.d.push_back(e_b.d);
+            } else {
+              alg.i1.push_back(e_b.i1);
+              alg.i2.push_back(e_b.i2);
+            }
+          }
+          alg.op.push_back(OP_DOT);
+          alg.i0.push_back(algorithm_[end].i0);
+          alg.i1.push_back(alg.dot_x.size());
+          alg.i2.push_back(dot_x.size());
+          alg.dot_x.insert(alg.dot_x.end(),dot_x.begin(),dot_x.end());
+          alg.dot_c.insert(alg.dot_c.end(),dot_c.begin(),dot_c.end());
+
+          // Constants that are only used after the combination
+          for(vector<int>::const_iterator it=after.begin(); it!=after.end(); ++it){
+            alg.op.push_back(OP_CONST);
+            alg.i0.push_back(algorithm_[*it].i0);
+            alg.i1.push_back(alg.d.size());
+            alg.i2.push_back(0);
+            alg.d.push_back(algorithm_[*it].d);
+          }
+          k = end;
+          continue;
+        }
+      }
+      
+      if(e.op==OP_CONST && nread[k]==1 && reader[k]==k+1 && 
+         (algorithm_[k+1].op==OP_ADD || algorithm_[k+1].op==OP_SUB || algorithm_[k+1].op==OP_MUL || algorithm_[k+1].op==OP_DIV)){
+        // Fuse with the arithmetic operation, which is the next element and the only one using the constant
+        const AlgEl& e_op = algorithm_[++k];
+        bool const_first = src1[k]==k-1;
+        switch(e_op.op){
+        case OP_ADD: op = OP_ADD_CONST; break;
+        case OP_SUB: op = const_first ? OP_CONST_SUB : OP_SUB_CONST; break;
+        case OP_MUL: op = OP_MUL_CONST; break;
+        case OP_DIV: op = const_first ? OP_CONST_DIV : OP_DIV_CONST; break;
+        }
+        i0 = e_op.i0;
+        i1 = const_first ? e_op.i2 : e_op.i1;
+        i2 = alg.d.size();
+        alg.d.push_back(e.d);
+      } else if(e.op==OP_CONST){
+        i1 = alg.d.size();
+        i2 = 0;
+        alg.d.push_back(e.d);
+      } else if(e.op==OP_PARAMETER){
+        i1 = i2 = 0;
+      } else if(e.op==OP_MUL && nread[k]==1 && reader[k]==k+1 && algorithm_[k+1].op==OP_ADD){
+        // Fuse with the addition, which is the next element and the only one using the product, the addend is stored in the next element
+        const AlgEl& e_add = algorithm_[++k];
+        alg.op.push_back(OP_MULADD);
+        alg.i0.push_back(e_add.i0);
+        alg.i1.push_back(i1);
+        alg.i2.push_back(i2);
+        op = OP_MULADD;
+        i0 = 0;
+        i1 = src1[k]==k-1 ? e_add.i2 : e_add.i1;
+        i2 = 0;
+      } else if(e.op==OP_MUL && i1==i2){
+        op = OP_SQ;
+      }
+      alg.op.push_back(op);
+      alg.i0.push_back(i0);
+      alg.i1.push_back(i1);
+      alg.i2.push_back(i2);
+    }
+    
+    // Pre-decode the handlers for the direct-threaded interpreter
+    if(threaded){
+      const void* const* table;
+      evaluateThreaded(alg,0,0,0,&table);
+      if(table!=0){
+#define CASADI_THREADED_OP(OP) OP,
+        static const int threaded_op[] = {CASADI_THREADED_OPS(CASADI_THREADED_OP)};
+#undef CASADI_THREADED_OP
+        const int num_threaded_op = sizeof(threaded_op)/sizeof(threaded_op[0]);
+        vector<const void*> handlers(NUM_COMPACT_OPS,table[num_threaded_op]);
+        for(int i=0; i<num_threaded_op; ++i) handlers[threaded_op[i]] = table[i];
+        alg.handler.resize(alg.op.size()+1);
+        for(int k=0; k<alg.op.size(); ++k) alg.handler[k] = handlers[alg.op[k]];
+        alg.handler.back() = table[num_threaded_op+1];
+      }
+    }
+  }
+
+#undef CASADI_THREADED_OPS
+
+  int SXFunctionInternal::findLinearCombination(int k, int min_terms, const vector<int>& src1, const vector<int>& src2, 
+                                                const vector<int>& nread, const vector<int>& reader, vector<int>& stamp,
+                                                vector<int>& before, vector<int>& after, vector<int>& x, vector<double>& c) const{
+    // Maximum number of consecutive elements in between that are not part of the combination
+    const int max_gap = 16;
+    
+    // The combination is a sequence of terms, each a multiplication of a work vector element with a constant,
+    // added to the sum of the previous terms: MUL, MUL, ADD, MUL, ADD, ... The other elements in between are evaluated before,
+    // except constants that are only used as coefficients, which are dropped, and constants that are only used after.
+    // stamp[j]==k marks element j as part of the combination or as a constant that is only used later,
+    // stamp[n+i]==k marks work vector element i as read by a term
+    const int n = algorithm_.size();
+    before.clear();
+    x.clear();
+    c.clear();
+    int end = -1, end_before = 0, end_terms = 0; // Last element of the longest complete combination
+    int sum = -1, term = -1; // Elements that computed the sum of the previous terms and the current term
+    int gap = 0;
+    for(int j=k; j<n && gap<=max_gap; ++j){
+      const AlgEl& e = algorithm_[j];
+      
+      // Is the element the next term, a product with a constant that is only used in the sum?
+      if(e.op==OP_MUL && (sum<0 || term<0) && nread[j]==1){
+        // If both factors are constants, use one that is not used elsewhere as the coefficient
+        bool c1 = algorithm_[src1[j]].op==OP_CONST;
+        bool c2 = algorithm_[src2[j]].op==OP_CONST;
+        if(c1 && c2 && stamp[src2[j]]==k) c1 = false;
+        int s_c = c1 ? src1[j] : src2[j], s_x = c1 ? src2[j] : src1[j];
+        
+        // The other factor must be available when the combination is evaluated
+        bool x_later = stamp[s_x]==k && algorithm_[s_x].op==OP_CONST;
+        if((c1 || c2) && (stamp[s_x]!=k || (x_later && stamp[n+algorithm_[s_x].i0]!=k))){
+          if(x_later){
+            before.push_back(s_x);
+            stamp[s_x] = -1;
+          }
+          if(stamp[s_c]==k) stamp[s_c] = -1; // Only used as a coefficient
+          int x_j = c1 ? e.i2 : e.i1;
+          stamp[n+x_j] = k;
+          stamp[j] = k;
+          x.push_back(x_j);
+          c.push_back(algorithm_[s_c].d);
+          if(sum<0){
+            sum = j;
+          } else {
+            term = j;
+          }
+          gap = 0;
+          continue;
+        }
+      }
+      
+      // Is the element the addition of the term to the sum?
+      if(e.op==OP_ADD && term>=0 && ((src1[j]==sum && src2[j]==term) || (src1[j]==term && src2[j]==sum))){
+        stamp[j] = k;
+        sum = j;
+        term = -1;
+        end = j;
+        end_before = before.size();
+        end_terms = x.size();
+        gap = 0;
+
+        // Unless this is the last addition, the sum must only be used in the next one
+        if(nread[j]!=1) break;
+        continue;
+      }
+      
+      // Constant that might only be used as a coefficient or after the combination
+      if(e.op==OP_CONST && nread[j]==1 && reader[j]>j){
+        stamp[j] = k;
+        ++gap;
+        continue;
+      }
+      
+      // Otherwise, the element is evaluated before the combination. It must not overwrite an element read by a term
+      if(e.op!=OP_OUTPUT && stamp[n+e.i0]==k) break;
+
+      // ... nor use a value computed by the combination
+      int ndeps = casadi_math<double>::ndeps(e.op);
+      int s[2] = {src1[j], src2[j]};
+      bool valid = true;
+      for(int d=0; d<ndeps; ++d){
+        if(stamp[s[d]]==k && (algorithm_[s[d]].op!=OP_CONST || stamp[n+algorithm_[s[d]].i0]==k)) valid = false;
+      }
+      if(!valid) break;
+      
+      // Constants that it uses must be evaluated before it
+      for(int d=0; d<ndeps; ++d){
+        if(stamp[s[d]]==k){
+          before.push_back(s[d]);
+          stamp[s[d]] = -1;
         }
       }
+      before.push_back(j);
+      ++gap;
+    }
+    
+    // Return the longest complete combination
+    if(end_terms<min_terms) return -1;
+    before.resize(end_before);
+    x.resize(end_terms);
+    c.resize(end_terms);
+    
+    // Constants that are only used after the combination
+    after.clear();
+    for(int j=k; j<end; ++j){
+      if(algorithm_[j].op==OP_CONST && nread[j]==1 && reader[j]>end) after.push_back(j);
     }
+    return end;
   }
 
   SXMatrix SXFunctionInternal::hess(int iind, int oind){
@@ -419,6 +941,85 @@ namespace CasADi{
     }
   }
 
+  void SXFunctionInternal::eliminateCommonSubexpressions(std::vector<SXNode*>& nodes, std::vector<SXNode*>& removed){
+    // For each node, the position of the equivalent node that is kept
+    vector<int> rep(nodes.size(),-1);
+    
+    // Structural key of each node: the operation and, depending on the operation, the value or the equivalent dependencies
+    vector<int> key_op(nodes.size());
+    vector<unsigned long long> key_a(nodes.size()), key_b(nodes.size());
+    
+    // Hash table with the position of the nodes, bucketed by hash value
+    CACHING_MAP<size_t,vector<int> > buckets;
+    
+    for(int i=0; i<nodes.size(); ++i){
+      SXNode* n = nodes[i];
+      
+      // Output instructions and symbolic primitives are unique
+      if(n==0 || n->isSymbolic()){
+        rep[i] = i;
+        continue;
+      }
+      
+      // Get the key
+      int op = n->getOp();
+      unsigned long long a = 0, b = 0;
+      if(op==OP_CONST){
+        // Compare constants bitwise so that e.g. 0 and -0 are not merged
+        double v = n->getValue();
+        casadi_assert(sizeof(v)==sizeof(a));
+        memcpy(&a,&v,sizeof(v));
+      } else {
+        int ndeps = casadi_math<double>::ndeps(op);
+        a = rep[n->dep(0).get()->temp];
+        if(ndeps==2){
+          b = rep[n->dep(1).get()->temp];
+          if(operation_checker<CommChecker>(op) && b<a) std::swap(a,b);
+        }
+      }
+      key_op[i] = op;
+      key_a[i] = a;
+      key_b[i] = b;
+      
+      // Look for an equivalent node
+      size_t h = size_t(op);
+      h ^= size_t(a) + 0x9e3779b9 + (h<<6) + (h>>2);
+      h ^= size_t(b) + 0x9e3779b9 + (h<<6) + (h>>2);
+      vector<int>& bucket = buckets[h];
+      for(vector<int>::const_iterator it=bucket.begin(); it!=bucket.end(); ++it){
+        if(key_op[*it]==op && key_a[*it]==a && key_b[*it]==b){
+          rep[i] = *it;
+          break;
+        }
+      }
+      
+      // New unique node
+      if(rep[i]<0){
+        rep[i] = i;
+        bucket.push_back(i);
+      }
+    }
+    
+    // New position of each node in the list
+    vector<int> pos(nodes.size());
+    int n_kept = 0;
+    for(int i=0; i<nodes.size(); ++i){
+      pos[i] = rep[i]==i ? n_kept++ : pos[rep[i]];
+    }
+
+    // Update the temporary variables and remove the duplicates
+    int k = 0;
+    for(int i=0; i<nodes.size(); ++i){
+      if(nodes[i]) nodes[i]->temp = pos[i];
+      if(rep[i]==i){
+        nodes[k++] = nodes[i];
+      } else {
+        removed.push_back(nodes[i]);
+      }
+    }
+    nodes.resize(k);
+  }
+
   void SXFunctionInternal::init(){
   
     // Call the init function of the base class
@@ -459,6 +1060,16 @@ namespace CasADi{
         nodes[i]->temp = i;
       }
     }
+
+    // Merge common subexpressions
+    vector<SXNode*> cse_removed;
+    if(getOption("cse")){
+      int nodes_before = nodes.size();
+      eliminateCommonSubexpressions(nodes,cse_removed);
+      if(verbose()){
+        cout << "Common subexpression elimination: " << nodes.size() << " nodes instead of " << nodes_before << endl;
+      }
+    }
     
     // Sort the nodes by type
     constants_.clear();
@@ -617,6 +1228,9 @@ namespace CasADi{
         nodes[i]->temp = 0;
       }
     }
+    for(vector<SXNode*>::iterator it=cse_removed.begin(); it!=cse_removed.end(); ++it){
+      (*it)->temp = 0;
+    }
   
     // Now mark each input's place in the algorithm
     for(vector<pair<int,SXNode*> >::const_iterator it=symb_loc.begin(); it!=symb_loc.end(); ++it){
@@ -656,6 +1270,28 @@ namespace CasADi{
   
     // Allocate memory for directional derivatives
     SXFunctionInternal::updateNumSens(false);
+
+    // Generate the compact algorithm, with 16 bit indices if possible
+    compact_algorithm_ = getOption("compact_algorithm");
+    compact16_ = CompactAlgorithm<unsigned short>();
+    compact32_ = CompactAlgorithm<int>();
+    if(compact_algorithm_){
+      int max_ind = std::max(work_.size(),algorithm_.size());
+      for(int ind=0; ind<getNumInputs(); ++ind) max_ind = std::max(max_ind,input(ind).size());
+      for(int ind=0; ind<getNumOutputs(); ++ind) max_ind = std::max(max_ind,output(ind).size());
+      bool threaded = getOption("threaded_interpreter");
+      if(max_ind <= numeric_limits<unsigned short>::max()){
+        initCompact(compact16_,threaded);
+      } else {
+        initCompact(compact32_,threaded);
+      }
+      compact_arg_.resize(getNumInputs());
+      compact_res_.resize(getNumOutputs());
+      if(verbose()){
+        cout << "Compact algorithm: " << std::max(compact16_.op.size(),compact32_.op.size()) << " elements with " 
+             << (compact16_.op.empty() ? 32 : 16) << " bit indices" << endl;
+      }
+    }
   
     // Initialize just-in-time compilation
     just_in_time_ = getOption("just_in_time");
@@ -852,6 +1488,25 @@ namespace CasADi{
 #endif //WITH_LLVM
     }
 
+    // Initialize just-in-time compilation using the system compiler
+    just_in_time_native_ = getOption("just_in_time_native");
+    just_in_time_compiler_ = getOption("just_in_time_compiler").toString();
+    jit_native_fcn_.clear();
+    if(just_in_time_native_){
+      // Make sure that there are no parameters
+      if (!free_vars_.empty()) {
+        std::stringstream ss;
+        repr(ss);
+        casadi_error("Cannot just-in-time compile \"" << ss.str() << "\" since variables " << free_vars_ << " are free.");
+      }
+#ifdef WITH_DL
+      // Compile the nominal function right away, directional derivatives when first needed
+      getNativeJIT(0,0);
+#else // WITH_DL
+      casadi_error("Option \"just_in_time_native\" true requires CasADi to have been compiled with WITH_DL=ON");
+#endif // WITH_DL
+    }
+
     // Initialize just-in-time compilation for numeric evaluation using OpenCL
     just_in_time_opencl_ = getOption("just_in_time_opencl");
     if(just_in_time_opencl_){
@@ -883,6 +1538,9 @@ namespace CasADi{
   void SXFunctionInternal::updateNumSens(bool recursive){
     // Call the base class if needed
     if(recursive) XFunctionInternal<SXFunction,SXFunctionInternal,SXMatrix,SXNode>::updateNumSens(recursive);
+    
+    // Work vector for the directional derivatives, one lane per direction
+    dwork_.resize(work_.size()*std::max(nfdir_,nadir_));
   }
 
   void SXFunctionInternal::evalSXsparse(const vector<SXMatrix>& arg1, vector<SXMatrix>& res1, 
@@ -1043,6 +1701,85 @@ namespace CasADi{
     if(verbose()) cout << "SXFunctionInternal::evalSXsparse end" << endl;
   }
 
+  ExternalFunction& SXFunctionInternal::getNativeJIT(int nfdir, int nadir){
+    // Make room in the cache
+    if(nfdir>=jit_native_fcn_.size()) jit_native_fcn_.resize(nfdir+1);
+    if(nadir>=jit_native_fcn_[nfdir].size()) jit_native_fcn_[nfdir].resize(nadir+1);
+
+    // Compile if not already available
+    ExternalFunction& ret = jit_native_fcn_[nfdir][nadir];
+    if(ret.isNull()){
+      if(nfdir==0 && nadir==0){
+        ret = compileNative(shared_from_this<FX>());
+      } else {
+        // Generate a function for the directional derivatives and compile it
+        FX dfcn = derivative(nfdir,nadir);
+        ret = compileNative(dfcn);
+
+        // The nonzeros are passed by reference, so the sparsity patterns must match
+        for(int i=0; i<ret.getNumInputs(); ++i){
+          casadi_assert(ret.input(i).sparsity()==dfcn.input(i).sparsity());
+        }
+        for(int i=0; i<ret.getNumOutputs(); ++i){
+          casadi_assert(ret.output(i).sparsity()==dfcn.output(i).sparsity());
+        }
+      }
+    }
+    return ret;
+  }
+
+  void SXFunctionInternal::evaluateNativeJIT(int nfdir, int nadir){
+    ExternalFunction& f = getNativeJIT(nfdir,nadir);
+    
+    // Number of inputs and outputs
+    int n_in = getNumInputs(), n_out = getNumOutputs();
+
+    // Pass nonzeros of the inputs, forward seeds and adjoint seeds
+    jit_native_arg_.clear();
+    for(int ind=0; ind<n_in; ++ind) jit_native_arg_.push_back(inputNoCheck(ind).ptr());
+    for(int dir=0; dir<nfdir; ++dir){
+      for(int ind=0; ind<n_in; ++ind) jit_native_arg_.push_back(fwdSeedNoCheck(ind,dir).ptr());
+    }
+    for(int dir=0; dir<nadir; ++dir){
+      for(int ind=0; ind<n_out; ++ind) jit_native_arg_.push_back(adjSeedNoCheck(ind,dir).ptr());
+    }
+
+    // Pass nonzeros of the outputs, forward sensitivities and adjoint sensitivities
+    jit_native_res_.clear();
+    for(int ind=0; ind<n_out; ++ind) jit_native_res_.push_back(outputNoCheck(ind).ptr());
+    for(int dir=0; dir<nfdir; ++dir){
+      for(int ind=0; ind<n_out; ++ind) jit_native_res_.push_back(fwdSensNoCheck(ind,dir).ptr());
+    }
+    for(int dir=0; dir<nadir; ++dir){
+      for(int ind=0; ind<n_in; ++ind) jit_native_res_.push_back(adjSensNoCheck(ind,dir).ptr());
+    }
+
+    // Evaluate
+    f->evaluate(getPtr(jit_native_arg_),getPtr(jit_native_res_));
+  }
+
+  ExternalFunction SXFunctionInternal::compileNative(FX f){
+#ifdef WITH_DL
+    // Generate the source code
+    stringstream src;
+    f->generateCode(src);
+
+    // Compile, unless available in the cache
+    string dlname = CompilerCache::compile(src.str(),just_in_time_compiler_,verbose());
+
+    // Load it
+    ExternalFunction ret(dlname);
+    ret.setOption("number_of_fwd_dir",0);
+    ret.setOption("number_of_adj_dir",0);
+    ret.setOption("name",f.getOption("name").toString() + "_jit");
+    ret.init();
+    return ret;
+#else // WITH_DL
+    casadi_error("SXFunctionInternal::compileNative requires CasADi to be compiled with option \"WITH_DL\" enabled");
+    return ExternalFunction();
+#endif // WITH_DL
+  }
+
   SXFunctionInternal* SXFunctionInternal::clone() const{
     return new SXFunctionInternal(*this);
   }
@@ -1126,6 +1863,102 @@ namespace CasADi{
     }
   }
 
+  namespace{
+    /** \brief Sparsity propagation with nw bit words per element
+        NW is the number of words if known at compile time (allowing the compiler to unroll and vectorize the
+        word loops), or 0 if only known at runtime */
+    template<int NW>
+    void spPropagateWide(const vector<SXFunctionInternal::AlgEl>& algorithm, bool fwd, int nw_runtime, bvec_t* w, bvec_t** arg, bvec_t** res){
+      const int nw = NW>0 ? NW : nw_runtime;
+      if(fwd){
+        for(vector<SXFunctionInternal::AlgEl>::const_iterator it=algorithm.begin(); it!=algorithm.end(); ++it){
+          bvec_t* w0 = w + it->i0*nw;
+          switch(it->op){
+          case OP_CONST:
+          case OP_PARAMETER:
+            for(int k=0; k<nw; ++k) w0[k] = 0;
+            break;
+          case OP_INPUT:
+            {
+              const bvec_t* a = arg[it->i1] + it->i2*nw;
+              for(int k=0; k<nw; ++k) w0[k] = a[k];
+            }
+            break;
+          case OP_OUTPUT:
+            {
+              bvec_t* r = res[it->i0] + it->i2*nw;
+              const bvec_t* w1 = w + it->i1*nw;
+              for(int k=0; k<nw; ++k) r[k] = w1[k];
+            }
+            break;
+          default: // Unary or binary operation
+            {
+              const bvec_t* w1 = w + it->i1*nw;
+              const bvec_t* w2 = w + it->i2*nw;
+              for(int k=0; k<nw; ++k) w0[k] = w1[k] | w2[k];
+            }
+          }
+        }
+      } else {
+        for(vector<SXFunctionInternal::AlgEl>::const_reverse_iterator it=algorithm.rbegin(); it!=algorithm.rend(); ++it){
+          switch(it->op){
+          case OP_CONST:
+          case OP_PARAMETER:
+            {
+              bvec_t* w0 = w + it->i0*nw;
+              for(int k=0; k<nw; ++k) w0[k] = 0;
+            }
+            break;
+          case OP_INPUT:
+            {
+              bvec_t* w0 = w + it->i0*nw;
+              bvec_t* a = arg[it->i1] + it->i2*nw;
+              for(int k=0; k<nw; ++k) a[k] |= w0[k];
+              for(int k=0; k<nw; ++k) w0[k] = 0;
+            }
+            break;
+          case OP_OUTPUT:
+            {
+              bvec_t* w1 = w + it->i1*nw;
+              const bvec_t* r = res[it->i0] + it->i2*nw;
+              for(int k=0; k<nw; ++k) w1[k] |= r[k];
+            }
+            break;
+          default: // Unary or binary operation
+            {
+              bvec_t* w0 = w + it->i0*nw;
+              bvec_t* w1 = w + it->i1*nw;
+              bvec_t* w2 = w + it->i2*nw;
+              for(int k=0; k<nw; ++k){
+                bvec_t seed = w0[k];
+                w0[k] = 0;
+                w1[k] |= seed;
+                w2[k] |= seed;
+              }
+            }
+          }
+        }
+      }
+    }
+  } // namespace
+
+  void SXFunctionInternal::spEvaluateWide(bool fwd, int nw, bvec_t** arg, bvec_t** res){
+    // Dedicated bit work array, cleared since the reverse mode accumulates into it
+    sp_work_.resize(nw*work_.size());
+    if(!fwd) fill(sp_work_.begin(),sp_work_.end(),bvec_t(0));
+    bvec_t* w = getPtr(sp_work_);
+
+    // Use a fixed width when possible
+    switch(nw){
+      case 1: spPropagateWide<1>(algorithm_,fwd,nw,w,arg,res); break;
+      case 2: spPropagateWide<2>(algorithm_,fwd,nw,w,arg,res); break;
+      case 4: spPropagateWide<4>(algorithm_,fwd,nw,w,arg,res); break;
+      case 8: spPropagateWide<8>(algorithm_,fwd,nw,w,arg,res); break;
+      case 16: spPropagateWide<16>(algorithm_,fwd,nw,w,arg,res); break;
+      default: spPropagateWide<0>(algorithm_,fwd,nw,w,arg,res);
+    }
+  }
+
   FX SXFunctionInternal::getFullJacobian(){
     // Get the nonzeros of each input
     vector<SXMatrix> argv = inputv_;
@@ -25,6 +25,7 @@
 
 #include "sx_function.hpp"
 #include "x_function_internal.hpp"
+#include "external_function.hpp"
 
 #ifdef WITH_LLVM
 // Some forward declarations
@@ -94,6 +95,24 @@ class SXFunctionInternal : public XFunctionInternal<SXFunction,SXFunctionInterna
   /** \brief  Evaluate the function numerically */
   virtual void evaluate(int nfdir, int nadir);
 
+  /** \brief  Evaluate the function numerically without derivatives, all memory owned by the caller */
+  virtual void evaluate(const double** arg, double** res, int* iw, double* w);
+
+  /** \brief  Get the length of the work vectors needed by evaluate(arg,res,iw,w) */
+  virtual void nWork(size_t& ni, size_t& nr) const;
+
+  /** \brief  Can evaluate(arg,res,iw,w) be called concurrently for the same object */
+  virtual bool isReentrant() const{ return true;}
+
+  /** \brief  Evaluate n times without derivatives, with groups of evaluations as the innermost loop */
+  virtual void evaluateBatch(int n, const double** arg, double** res, int* iw, double* w);
+
+  /** \brief  Get the length of the work vectors needed by evaluateBatch for n evaluations */
+  virtual void nWorkBatch(int n, size_t& ni, size_t& nr) const;
+
+  /// Maximum number of evaluations in a group in evaluateBatch
+  static const int batch_group_size = 16;
+
   /** \brief  Helper class to be plugged into evaluateGen when working with a value known only at runtime */
   struct int_runtime{
     const int value;
@@ -142,10 +161,103 @@ class SXFunctionInternal : public XFunctionInternal<SXFunction,SXFunctionInterna
   /** \brief  all binary nodes of the tree in the order of execution */
   std::vector<AlgEl> algorithm_;
 
+  /** \brief  Compact representation of the algorithm, used for numerical evaluation without derivatives
+      Struct-of-arrays layout with the operations stored as bytes and the indices as integers of type I.
+      Constants are stored in a separate pool, indexed by i1. A multiplication followed by an addition
+      of the product is fused into OP_MULADD, the addend of which is stored in i1 of the next element.
+      Loading a constant followed by an arithmetic operation with it is fused into one operation with the constant
+      pool index in i2. Linear combinations with constant coefficients, typically rows of an expanded product
+      with a dense constant matrix, are evaluated with a single operation, the coefficients and work vector 
+      indices of which are stored in dot_c and dot_x. If handler is not empty, it holds the address of the handler of each element of the
+      direct-threaded interpreter, followed by the address of the exit handler. */
+  template<typename I>
+  struct CompactAlgorithm{
+    std::vector<unsigned char> op;
+    std::vector<I> i0, i1, i2;
+    std::vector<double> d;
+    std::vector<I> dot_x;
+    std::vector<double> dot_c;
+    std::vector<const void*> handler;
+  };
+
+  /** \brief  Operations that only appear in the compact algorithm */
+  enum CompactOperation{
+    /// w[i0] = w[i1]*w[i2] + w[next i1], takes up two elements
+    OP_MULADD = NUM_BUILT_IN_OPS,
+    /// w[i0] = w[i1] + d[i2]
+    OP_ADD_CONST,
+    /// w[i0] = w[i1] - d[i2]
+    OP_SUB_CONST,
+    /// w[i0] = d[i2] - w[i1]
+    OP_CONST_SUB,
+    /// w[i0] = w[i1] * d[i2]
+    OP_MUL_CONST,
+    /// w[i0] = w[i1] / d[i2]
+    OP_DIV_CONST,
+    /// w[i0] = d[i2] / w[i1]
+    OP_CONST_DIV,
+    /// w[i0] = sum_j dot_c[i1+j]*w[dot_x[i1+j]] for j<i2
+    OP_DOT,
+    /// Number of operations in the compact algorithm
+    NUM_COMPACT_OPS
+  };
+
+  /// Evaluate numerically with the compact algorithm
+  bool compact_algorithm_;
+  
+  /// Compact algorithm with 16 bit indices, used if all indices fit
+  CompactAlgorithm<unsigned short> compact16_;
+
+  /// Compact algorithm with 32 bit indices, used otherwise
+  CompactAlgorithm<int> compact32_;
+
+  /// Generate the compact algorithm from algorithm_
+  template<typename I>
+  void initCompact(CompactAlgorithm<I>& alg, bool threaded) const;
+
+  /** \brief  Find a linear combination with constant coefficients starting at element k of the algorithm
+      Returns the index of the last element, or -1 if there is no such combination with at least min_terms terms.
+      src1, src2, nread and reader give the elements that computed the arguments of each element, and the number of 
+      times and the last element by which its result is read. The elements in between that must be evaluated before
+      and after the combination are returned in before and after. stamp is a marker of the size of the algorithm
+      plus the size of the work vector. */
+  int findLinearCombination(int k, int min_terms, const std::vector<int>& src1, const std::vector<int>& src2,
+                            const std::vector<int>& nread, const std::vector<int>& reader, std::vector<int>& stamp,
+                            std::vector<int>& before, std::vector<int>& after, std::vector<int>& x, std::vector<double>& c) const;
+
+  /// Evaluate the compact algorithm
+  template<typename I>
+  static void evaluateCompact(const CompactAlgorithm<I>& alg, const double** arg, double** res, double* w);
+
+  /** \brief  Evaluate the compact algorithm with a direct-threaded interpreter
+      Requires computed goto (a GCC extension). If handlers is not null, the table with the addresses of the handlers
+      is returned instead, null if unsupported. The addresses are only valid in evaluateThreaded itself. */
+  template<typename I>
+  static void evaluateThreaded(const CompactAlgorithm<I>& alg, const double** arg, double** res, double* w, 
+                               const void* const** handlers=0);
+
+  /// Evaluate the compact algorithm with 16 or 32 bit indices, whichever is available
+  inline void evaluateCompact(const double** arg, double** res, double* w) const{
+    if(compact16_.op.empty()){
+      evaluateCompact(compact32_,arg,res,w);
+    } else {
+      evaluateCompact(compact16_,arg,res,w);
+    }
+  }
+
+  /// Pointers to the input and output nonzeros for the evaluation of the compact algorithm
+  std::vector<const double*> compact_arg_;
+  std::vector<double*> compact_res_;
+
   /** \brief  Working vector for numeric calculation */
   std::vector<double> work_;
   std::vector<TapeEl<double> > pdwork_;
 
+  /** \brief  Working vector for the directional derivatives
+      Holds a contiguous block of nfdir (or nadir) lanes for each element of the work vector, 
+      so that all directions are propagated in a single sweep through the algorithm */
+  std::vector<double> dwork_;
+
   /// work vector for symbolic calculations (allocated first time)
   std::vector<SX> s_work_;
   std::vector<SX> free_vars_;
@@ -162,6 +274,13 @@ class SXFunctionInternal : public XFunctionInternal<SXFunction,SXFunctionInterna
   /** \brief  Update the number of sensitivity directions during or after initialization */
   virtual void updateNumSens(bool recursive);
 
+  /** \brief  Merge structurally identical nodes in a topologically sorted list of nodes
+   * The temporary variable of each node must hold its position in the list. On return, the duplicates
+   * have been removed from the list and moved to "removed", and all temporary variables point to the new
+   * position of the (remaining) equivalent node.
+   */
+  static void eliminateCommonSubexpressions(std::vector<SXNode*>& nodes, std::vector<SXNode*>& removed);
+
   /** \brief Generate code for the declarations of the C function */
   virtual void generateDeclarations(std::ostream &stream, const std::string& type, CodeGenerator& gen) const;
 
@@ -179,7 +298,16 @@ class SXFunctionInternal : public XFunctionInternal<SXFunction,SXFunctionInterna
 
   /// Reset the sparsity propagation
   virtual void spInit(bool fwd);
-  
+
+  /// Is the class able to propagate several bit words per nonzero?
+  virtual bool spCanEvaluateWide(bool fwd){ return true;}
+
+  /// Propagate a sparsity pattern through the algorithm with nw bit words per nonzero
+  virtual void spEvaluateWide(bool fwd, int nw, bvec_t** arg, bvec_t** res);
+
+  /// Work array for spEvaluateWide, nw words per element of work_
+  std::vector<bvec_t> sp_work_;
+
   /// Get jacobian of all nonzero outputs with respect to all nonzero inputs
   virtual FX getFullJacobian();
 
@@ -191,6 +319,28 @@ class SXFunctionInternal : public XFunctionInternal<SXFunction,SXFunctionInterna
 
   /// With just-in-time compilation for the sparsity propagation
   bool just_in_time_sparsity_;
+
+  /// With just-in-time compilation using the system C compiler
+  bool just_in_time_native_;
+
+  /// Compiler command used for the native just-in-time compilation
+  std::string just_in_time_compiler_;
+
+  /// Natively compiled functions, indexed by the number of forward and adjoint directions
+  std::vector<std::vector<ExternalFunction> > jit_native_fcn_;
+
+  /// Pointers to the arguments and results of a natively compiled function
+  std::vector<const double*> jit_native_arg_;
+  std::vector<double*> jit_native_res_;
+
+  /// Get the natively compiled function for a number of directions, compile if not already available
+  ExternalFunction& getNativeJIT(int nfdir, int nadir);
+
+  /// Evaluate with the natively compiled function
+  void evaluateNativeJIT(int nfdir, int nadir);
+
+  /// Generate code for a function, compile it with the system compiler and load it, reusing compiled code from the CompilerCache
+  ExternalFunction compileNative(FX f);
   
 #ifdef WITH_LLVM
   llvm::Module *jit_module_;
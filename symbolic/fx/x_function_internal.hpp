@@ -116,6 +116,7 @@ namespace CasADi{
                                                                                 const std::vector<MatType>& inputv, const std::vector<MatType>& outputv) : inputv_(inputv),  outputv_(outputv){
     addOption("topological_sorting",OT_STRING,"depth-first","Topological sorting algorithm","depth-first|breadth-first");
     addOption("live_variables",OT_BOOLEAN,true,"Reuse variables in the work vector");
+    addOption("cse",OT_BOOLEAN,false,"Merge structurally identical subexpressions before building the algorithm");
   
     // Make sure that inputs are symbolic
     for(int i=0; i<inputv.size(); ++i){
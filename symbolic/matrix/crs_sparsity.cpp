@@ -462,6 +462,18 @@ namespace CasADi{
     return (*this)->starColoring2(ordering,cutoff);
   }
 
+  CRSSparsity CRSSparsity::unidirectionalColoringParallel(const CRSSparsity& AT, int cutoff) const{
+    if(AT.isNull()){
+      return (*this)->unidirectionalColoringParallel(transpose(),cutoff);
+    } else {
+      return (*this)->unidirectionalColoringParallel(AT,cutoff);
+    }
+  }
+
+  CRSSparsity CRSSparsity::starColoringParallel(int ordering, int cutoff) const{
+    return (*this)->starColoringParallel(ordering,cutoff);
+  }
+
   std::vector<int> CRSSparsity::largestFirstOrdering() const{
     return (*this)->largestFirstOrdering();
   }
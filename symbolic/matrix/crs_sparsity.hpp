@@ -446,6 +446,19 @@ namespace CasADi{
         Ordering options: None (0), largest first (1)
     */
     CRSSparsity starColoring2(int ordering = 1, int cutoff = std::numeric_limits<int>::max()) const;
+
+    /** \brief Perform a unidirectional coloring in parallel
+        The rows are divided into blocks that are colored concurrently by the thread pool, after which the conflicts 
+        between blocks are detected and the affected rows recolored. The number of colors is typically close to 
+        that of unidirectionalColoring, but the result depends on the number of threads.
+    */
+    CRSSparsity unidirectionalColoringParallel(const CRSSparsity& AT=CRSSparsity(), int cutoff = std::numeric_limits<int>::max()) const;
+
+    /** \brief Perform a star coloring of a symmetric matrix in parallel
+        Speculative version of starColoring, see unidirectionalColoringParallel.
+        Ordering options: None (0), largest first (1)
+    */
+    CRSSparsity starColoringParallel(int ordering = 1, int cutoff = std::numeric_limits<int>::max()) const;
     
     /** \brief Order the rows by decreasing degree */
     std::vector<int> largestFirstOrdering() const;
@@ -27,6 +27,7 @@
 #include <cstdlib>
 #include <cmath>
 #include "matrix.hpp"
+#include "../thread_pool.hpp"
 
 //#include "../external_packages/ColPack/ReducedHeader.h"
 
@@ -3230,6 +3231,251 @@ namespace CasADi{
     return sp_triplet(num_colors,nrow_,color,range(color.size()));
   }
 
+  namespace{
+    // Data shared between the tasks of a parallel coloring
+    struct ColoringData{
+      // Rows to be colored and the transpose, giving the rows sharing each column
+      const int *rowind, *col, *AT_rowind, *AT_col;
+      
+      // Star coloring (symmetric matrix) or unidirectional coloring
+      bool star;
+      
+      // Rows are divided into contiguous blocks, one per task
+      int block_size;
+      
+      // Current coloring and the coloring at the beginning of the round
+      std::vector<int> color, color_old;
+      
+      // Round in which each row was last colored, and the current round
+      std::vector<int> round;
+      int current_round;
+      
+      // For each block: rows to be colored, rows in conflict and the forbidden colors
+      std::vector<std::vector<int> > worklist, conflicts, forbidden;
+      
+      // For each block: the last value used to mark forbidden colors, incremented for each row colored
+      std::vector<int> stamp;
+    };
+    
+    // Color of a row as seen by the task coloring block b
+    inline int seenColor(const ColoringData& d, int b, int i){
+      return i/d.block_size==b ? d.color[i] : d.color_old[i];
+    }
+    
+    // Mark a color as forbidden for the row being colored
+    inline void forbid(std::vector<int>& forbidden, int c, int stamp){
+      if(c>=forbidden.size()) forbidden.resize(c+1,-1);
+      forbidden[c] = stamp;
+    }
+    
+    // Is row j colored in the current round in a block other than the one of i and with a lower index
+    inline bool isPrecedingConflict(const ColoringData& d, int i, int j){
+      return j<i && d.round[j]==d.current_round && j/d.block_size!=i/d.block_size;
+    }
+    
+    // Speculative coloring of the rows in a block, the colors of the other blocks are taken from the previous round
+    void coloringTask(void* user_data, int b, int thread){
+      ColoringData& d = *static_cast<ColoringData*>(user_data);
+      std::vector<int>& forbidden = d.forbidden[b];
+      const std::vector<int>& worklist = d.worklist[b];
+      for(std::vector<int>::const_iterator it=worklist.begin(); it!=worklist.end(); ++it){
+        int i = *it;
+        
+        // Value marking the colors forbidden for this row, a row that is recolored in a later round must not see its old marks
+        int stamp = ++d.stamp[b];
+        if(d.star){
+          // Same rules as CRSSparsityInternal::starColoring
+          for(int w_el=d.rowind[i]; w_el<d.rowind[i+1]; ++w_el){
+            int w = d.col[w_el];
+            int color_w = seenColor(d,b,w);
+            if(color_w!=-1) forbid(forbidden,color_w,stamp);
+            for(int x_el=d.rowind[w]; x_el<d.rowind[w+1]; ++x_el){
+              int x = d.col[x_el];
+              int color_x = seenColor(d,b,x);
+              if(color_x==-1) continue;
+              if(color_w==-1){
+                forbid(forbidden,color_x,stamp);
+              } else {
+                for(int y_el=d.rowind[x]; y_el<d.rowind[x+1]; ++y_el){
+                  int y = d.col[y_el];
+                  if(y==w) continue;
+                  if(seenColor(d,b,y)==color_w){
+                    forbid(forbidden,color_x,stamp);
+                    break;
+                  }
+                }
+              }
+            }
+          }
+        } else {
+          // Rows sharing a column must have different colors
+          for(int el=d.rowind[i]; el<d.rowind[i+1]; ++el){
+            int c = d.col[el];
+            for(int el_j=d.AT_rowind[c]; el_j<d.AT_rowind[c+1]; ++el_j){
+              int j = d.AT_col[el_j];
+              if(j==i) continue;
+              int color_j = seenColor(d,b,j);
+              if(color_j!=-1) forbid(forbidden,color_j,stamp);
+            }
+          }
+        }
+
+        // Get the first nonforbidden color
+        int color_i;
+        for(color_i=0; color_i<forbidden.size(); ++color_i){
+          if(forbidden[color_i]!=stamp) break;
+        }
+        d.color[i] = color_i;
+        d.round[i] = d.current_round;
+      }
+    }
+    
+    // Find the rows in a block that need to be recolored
+    void conflictTask(void* user_data, int b, int thread){
+      ColoringData& d = *static_cast<ColoringData*>(user_data);
+      std::vector<int>& conflicts = d.conflicts[b];
+      const std::vector<int>& worklist = d.worklist[b];
+      const std::vector<int>& color = d.color;
+      for(std::vector<int>::const_iterator it=worklist.begin(); it!=worklist.end(); ++it){
+        int i = *it;
+        bool conflict = false;
+        if(d.star){
+          // Look for an adjacent row with the same color or a path on four rows using only two colors,
+          // containing a row with lower index that was colored concurrently
+          for(int w_el=d.rowind[i]; !conflict && w_el<d.rowind[i+1]; ++w_el){
+            int w = d.col[w_el];
+            if(w==i) continue;
+            if(color[w]==color[i]){
+              conflict = isPrecedingConflict(d,i,w);
+              continue;
+            }
+            for(int x_el=d.rowind[w]; !conflict && x_el<d.rowind[w+1]; ++x_el){
+              int x = d.col[x_el];
+              if(x==i || x==w || color[x]!=color[i]) continue;
+              
+              // Path i-w-x-y with color[y]==color[w]
+              for(int y_el=d.rowind[x]; !conflict && y_el<d.rowind[x+1]; ++y_el){
+                int y = d.col[y_el];
+                if(y==w || y==x || y==i || color[y]!=color[w]) continue;
+                conflict = isPrecedingConflict(d,i,w) || isPrecedingConflict(d,i,x) || isPrecedingConflict(d,i,y);
+              }
+              
+              // Path u-i-w-x with color[u]==color[w]
+              for(int u_el=d.rowind[i]; !conflict && u_el<d.rowind[i+1]; ++u_el){
+                int u = d.col[u_el];
+                if(u==w || u==i || color[u]!=color[w]) continue;
+                conflict = isPrecedingConflict(d,i,u) || isPrecedingConflict(d,i,w) || isPrecedingConflict(d,i,x);
+              }
+            }
+          }
+        } else {
+          // Look for a row sharing a column with the same color
+          for(int el=d.rowind[i]; !conflict && el<d.rowind[i+1]; ++el){
+            int c = d.col[el];
+            for(int el_j=d.AT_rowind[c]; el_j<d.AT_rowind[c+1]; ++el_j){
+              int j = d.AT_col[el_j];
+              if(color[j]==color[i] && isPrecedingConflict(d,i,j)){
+                conflict = true;
+                break;
+              }
+            }
+          }
+        }
+        if(conflict) conflicts.push_back(i);
+      }
+    }
+    
+    // Parallel coloring, returns the number of colors or -1 if more than cutoff colors are needed
+    int parallelColoring(int nrow, const std::vector<int>& rowind, const std::vector<int>& col, const std::vector<int>& AT_rowind, const std::vector<int>& AT_col, bool star, int cutoff, std::vector<int>& color){
+      ThreadPool& pool = ThreadPool::getInstance();
+      
+      // Divide the rows into blocks
+      int nblock = std::max(1,std::min(pool.getNumThreads(),nrow));
+      ColoringData d;
+      d.rowind = getPtr(rowind);
+      d.col = getPtr(col);
+      d.AT_rowind = getPtr(AT_rowind);
+      d.AT_col = getPtr(AT_col);
+      d.star = star;
+      d.block_size = std::max(1,(nrow+nblock-1)/nblock);
+      d.color.resize(nrow,-1);
+      d.round.resize(nrow,-1);
+      d.worklist.resize(nblock);
+      d.conflicts.resize(nblock);
+      d.forbidden.resize(nblock);
+      d.stamp.resize(nblock,-1);
+      for(int i=0; i<nrow; ++i){
+        d.worklist[i/d.block_size].push_back(i);
+      }
+      
+      // Color and resolve conflicts until no conflicts remain
+      int num_colors = 0;
+      for(d.current_round=0; ; ++d.current_round){
+        d.color_old = d.color;
+        pool.run(coloringTask,&d,nblock);
+        pool.run(conflictTask,&d,nblock);
+        
+        // Uncolor the rows in conflict
+        bool done = true;
+        for(int b=0; b<nblock; ++b){
+          d.worklist[b].swap(d.conflicts[b]);
+          d.conflicts[b].clear();
+          for(std::vector<int>::const_iterator it=d.worklist[b].begin(); it!=d.worklist[b].end(); ++it){
+            d.color[*it] = -1;
+          }
+          done = done && d.worklist[b].empty();
+        }
+        
+        // Cutoff if too many colors
+        num_colors = 0;
+        for(std::vector<int>::const_iterator it=d.color.begin(); it!=d.color.end(); ++it){
+          num_colors = std::max(num_colors,*it+1);
+        }
+        if(num_colors>cutoff) return -1;
+        if(done) break;
+      }
+      
+      color.swap(d.color);
+      return num_colors;
+    }
+  } // namespace
+
+  CRSSparsity CRSSparsityInternal::unidirectionalColoringParallel(const CRSSparsity& AT, int cutoff) const{
+    vector<int> color;
+    int num_colors = parallelColoring(nrow_,rowind_,col_,AT.rowind(),AT.col(),false,cutoff,color);
+    if(num_colors<0) return CRSSparsity();
+    
+    // Return sparsity in sparse triplet format
+    return sp_triplet(num_colors,nrow_,color,range(color.size()));
+  }
+
+  CRSSparsity CRSSparsityInternal::starColoringParallel(int ordering, int cutoff) const{
+    // Reorder, if necessary
+    if(ordering!=0){
+      casadi_assert(ordering==1);
+    
+      // Ordering
+      vector<int> ord = largestFirstOrdering();
+
+      // Create a new sparsity pattern 
+      CRSSparsity sp_permuted = pmult(ord,true,true,true);
+    
+      // Star coloring for the permuted matrix
+      CRSSparsity ret_permuted = sp_permuted.starColoringParallel(0,cutoff);
+      if(ret_permuted.isNull()) return ret_permuted;
+        
+      // Permute result back
+      return ret_permuted.pmult(ord,false,true,false);
+    }
+    
+    vector<int> color;
+    int num_colors = parallelColoring(nrow_,rowind_,col_,rowind_,col_,true,cutoff,color);
+    if(num_colors<0) return CRSSparsity();
+
+    // Return sparsity in sparse triplet format
+    return sp_triplet(num_colors,nrow_,color,range(color.size()));
+  }
+
   std::vector<int> CRSSparsityInternal::largestFirstOrdering() const{
     vector<int> degree = rowind_;
     int max_degree = 0;
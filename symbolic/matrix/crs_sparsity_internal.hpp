@@ -266,6 +266,12 @@ namespace CasADi{
     /// Perform a star coloring of a symmetric matrix: An improved distance-2 coloring algorithm (Algorithm 4.1 in A. H. GEBREMEDHIN, A. TARAFDAR, F. MANNE, A. POTHEN)
     CRSSparsity starColoring2(int ordering, int cutoff) const;
 
+    /// Perform a unidirectional coloring using the thread pool: speculative coloring with iterative conflict resolution
+    CRSSparsity unidirectionalColoringParallel(const CRSSparsity& AT, int cutoff) const;
+
+    /// Perform a star coloring of a symmetric matrix using the thread pool: speculative coloring with iterative conflict resolution
+    CRSSparsity starColoringParallel(int ordering, int cutoff) const;
+
     /// Order the rows by decreasing degree
     std::vector<int> largestFirstOrdering() const;
 
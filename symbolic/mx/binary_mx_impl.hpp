@@ -146,6 +146,17 @@ namespace CasADi{
     stream << ";" << endl;
   }
 
+  template<bool ScX, bool ScY>
+  void BinaryMX<ScX,ScY>::evaluateD(const double** input, double** output, int* itmp, double* rtmp){
+    if(!ScX && !ScY){
+      casadi_math<double>::fun(op_, input[0], input[1], output[0], size());
+    } else if(ScX){
+      casadi_math<double>::fun(op_, input[0][0], input[1],    output[0], size());
+    } else {
+      casadi_math<double>::fun(op_, input[0],    input[1][0], output[0], size());
+    }
+  }
+
   template<bool ScX, bool ScY>
   void BinaryMX<ScX,ScY>::evaluateD(const DMatrixPtrV& input, DMatrixPtrV& output, const DMatrixPtrVV& fwdSeed, DMatrixPtrVV& fwdSens, const DMatrixPtrVV& adjSeed, DMatrixPtrVV& adjSens){
     evaluateGen<double,DMatrixPtrV,DMatrixPtrVV>(input,output,fwdSeed,fwdSens,adjSeed,adjSens);
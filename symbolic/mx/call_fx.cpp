@@ -62,6 +62,10 @@ namespace CasADi {
     fcn_->evaluateD(this,arg,res,fseed,fsens,aseed,asens,itmp,rtmp);
   }
 
+  void CallFX::evaluateD(const double** input, double** output, int* itmp, double* rtmp){
+    fcn_->evaluateD(this,input,output,itmp,rtmp);
+  }
+
   int CallFX::getNumOutputs() const {
     return fcn_.getNumOutputs();
   }
@@ -101,4 +105,21 @@ namespace CasADi {
     fcn_->nTmp(this,ni,nr);
   }
 
+  void CallFX::nWork(size_t& ni, size_t& nr){
+    fcn_->nWork(this,ni,nr);
+  }
+
+  bool CallFX::isReentrant() const{
+    return fcn_->isReentrant();
+  }
+
+  bool CallFX::isEqual(const MXNode* node, int depth) const{
+    // Check dependencies
+    if(!sameOpAndDeps(node,depth)) return false;
+
+    // Check if same function
+    const CallFX* n = dynamic_cast<const CallFX*>(node);
+    return n!=0 && fcn_.get()==n->fcn_.get();
+  }
+
 } // namespace CasADi
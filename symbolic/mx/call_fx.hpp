@@ -53,6 +53,9 @@ namespace CasADi{
     /** \brief  Evaluate the function numerically */
     virtual void evaluateD(const DMatrixPtrV& input, DMatrixPtrV& output, const DMatrixPtrVV& fwdSeed, DMatrixPtrVV& fwdSens, const DMatrixPtrVV& adjSeed, DMatrixPtrVV& adjSens, std::vector<int>& itmp, std::vector<double>& rtmp);
 
+    /** \brief  Evaluate the function numerically, no derivatives, operating directly on the nonzeros */
+    virtual void evaluateD(const double** input, double** output, int* itmp, double* rtmp);
+
     /** \brief  Evaluate the function symbolically (SX) */
     virtual void evaluateSX(const SXMatrixPtrV& input, SXMatrixPtrV& output, const SXMatrixPtrVV& fwdSeed, SXMatrixPtrVV& fwdSens, const SXMatrixPtrVV& adjSeed, SXMatrixPtrVV& adjSens, std::vector<int>& itmp, std::vector<SX>& rtmp);
 
@@ -86,6 +89,15 @@ namespace CasADi{
     /// Get number of temporary variables needed
     virtual void nTmp(size_t& ni, size_t& nr);
 
+    /// Get number of temporary variables needed when operating directly on the nonzeros
+    virtual void nWork(size_t& ni, size_t& nr);
+
+    /// Can the node be evaluated concurrently when operating directly on the nonzeros
+    virtual bool isReentrant() const;
+
+    /** \brief Check if two nodes are equivalent up to a given depth */
+    virtual bool isEqual(const MXNode* node, int depth) const;
+
     // Function to be evaluated
     FX fcn_;
   };
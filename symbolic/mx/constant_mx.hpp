@@ -111,6 +111,11 @@ namespace CasADi{
       ConstantMX::evaluateD(input,output,fwdSeed,fwdSens,adjSeed,adjSens);
     }
 
+    /** \brief  Evaluate the function numerically, no derivatives, operating directly on the nonzeros */
+    virtual void evaluateD(const double** input, double** output, int* itmp, double* rtmp){
+      std::copy(x_.begin(),x_.end(),output[0]);
+    }
+
     /** \brief  Evaluate the function symbolically (SX) */
     virtual void evaluateSX(const SXMatrixPtrV& input, SXMatrixPtrV& output, const SXMatrixPtrVV& fwdSeed, SXMatrixPtrVV& fwdSens, const SXMatrixPtrVV& adjSeed, SXMatrixPtrVV& adjSens){
       output[0]->set(SXMatrix(x_));
@@ -172,6 +177,9 @@ namespace CasADi{
     /** \brief  Evaluate the function numerically */
     virtual void evaluateD(const DMatrixPtrV& input, DMatrixPtrV& output, const DMatrixPtrVV& fwdSeed, DMatrixPtrVV& fwdSens, const DMatrixPtrVV& adjSeed, DMatrixPtrVV& adjSens);
 
+    /** \brief  Evaluate the function numerically, no derivatives, operating directly on the nonzeros */
+    virtual void evaluateD(const double** input, double** output, int* itmp, double* rtmp);
+
     /** \brief  Evaluate the function symbolically (SX) */
     virtual void evaluateSX(const SXMatrixPtrV& input, SXMatrixPtrV& output, const SXMatrixPtrVV& fwdSeed, SXMatrixPtrVV& fwdSens, const SXMatrixPtrVV& adjSeed, SXMatrixPtrVV& adjSens);
 
@@ -278,6 +286,11 @@ namespace CasADi{
     ConstantMX::evaluateD(input,output,fwdSeed,fwdSens,adjSeed,adjSens);
   }
 
+  template<typename Value>
+  void Constant<Value>::evaluateD(const double** input, double** output, int* itmp, double* rtmp){
+    std::fill(output[0],output[0]+size(),double(v_.value));
+  }
+
   template<typename Value>
   void Constant<Value>::evaluateSX(const SXMatrixPtrV& input, SXMatrixPtrV& output, const SXMatrixPtrVV& fwdSeed, SXMatrixPtrVV& fwdSens, const SXMatrixPtrVV& adjSeed, SXMatrixPtrVV& adjSens){
     output[0]->set(SX(v_.value));
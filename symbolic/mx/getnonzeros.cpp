@@ -41,6 +41,14 @@ namespace CasADi{
     evaluateGen<double,DMatrixPtrV,DMatrixPtrVV>(input,output,fwdSeed,fwdSens,adjSeed,adjSens);
   }
 
+  void GetNonzerosVector::evaluateD(const double** input, double** output, int* itmp, double* rtmp){
+    const double* idata = input[0];
+    double* odata = output[0];
+    for(vector<int>::const_iterator k=nz_.begin(); k!=nz_.end(); ++k){
+      *odata++ = *k>=0 ? idata[*k] : 0;
+    }
+  }
+
   void GetNonzerosVector::evaluateSX(const SXMatrixPtrV& input, SXMatrixPtrV& output, const SXMatrixPtrVV& fwdSeed, SXMatrixPtrVV& fwdSens, const SXMatrixPtrVV& adjSeed, SXMatrixPtrVV& adjSens){
     evaluateGen<SX,SXMatrixPtrV,SXMatrixPtrVV>(input,output,fwdSeed,fwdSens,adjSeed,adjSens);
   }
@@ -83,6 +91,15 @@ namespace CasADi{
     evaluateGen<double,DMatrixPtrV,DMatrixPtrVV>(input,output,fwdSeed,fwdSens,adjSeed,adjSens);
   }
 
+  void GetNonzerosSlice::evaluateD(const double** input, double** output, int* itmp, double* rtmp){
+    const double* idata_ptr = input[0] + s_.start_;
+    const double* idata_stop = input[0] + s_.stop_;
+    double* odata_ptr = output[0];
+    for(; idata_ptr != idata_stop; idata_ptr += s_.step_){
+      *odata_ptr++ = *idata_ptr;
+    }
+  }
+
   void GetNonzerosSlice::evaluateSX(const SXMatrixPtrV& input, SXMatrixPtrV& output, const SXMatrixPtrVV& fwdSeed, SXMatrixPtrVV& fwdSens, const SXMatrixPtrVV& adjSeed, SXMatrixPtrVV& adjSens){
     evaluateGen<SX,SXMatrixPtrV,SXMatrixPtrVV>(input,output,fwdSeed,fwdSens,adjSeed,adjSens);
   }
@@ -131,6 +148,17 @@ namespace CasADi{
     evaluateGen<double,DMatrixPtrV,DMatrixPtrVV>(input,output,fwdSeed,fwdSens,adjSeed,adjSens);
   }
 
+  void GetNonzerosSlice2::evaluateD(const double** input, double** output, int* itmp, double* rtmp){
+    const double* outer_ptr = input[0] + outer_.start_;
+    const double* outer_stop = input[0] + outer_.stop_;
+    double* odata_ptr = output[0];
+    for(; outer_ptr != outer_stop; outer_ptr += outer_.step_){
+      for(const double* inner_ptr = outer_ptr+inner_.start_; inner_ptr != outer_ptr+inner_.stop_; inner_ptr += inner_.step_){
+        *odata_ptr++ = *inner_ptr;
+      }
+    }
+  }
+
   void GetNonzerosSlice2::evaluateSX(const SXMatrixPtrV& input, SXMatrixPtrV& output, const SXMatrixPtrVV& fwdSeed, SXMatrixPtrVV& fwdSens, const SXMatrixPtrVV& adjSeed, SXMatrixPtrVV& adjSens){
     evaluateGen<SX,SXMatrixPtrV,SXMatrixPtrVV>(input,output,fwdSeed,fwdSens,adjSeed,adjSens);
   }
@@ -63,6 +63,48 @@ namespace CasADi{
     evaluateGen<double,DMatrixPtrV,DMatrixPtrVV>(input,output,fwdSeed,fwdSens,adjSeed,adjSens);
   }
 
+  template<bool TrX, bool TrY>
+  void Multiplication<TrX,TrY>::evaluateD(const double** input, double** output, int* itmp, double* rtmp){
+    double* z_data = output[0];
+    if(z_data==0) return;
+    const CRSSparsity& sp_z = this->sparsity();
+    if(input[0]==0){
+      std::fill(z_data,z_data+sp_z.size(),0.0);
+    } else if(input[0]!=z_data){
+      std::copy(input[0],input[0]+sp_z.size(),z_data);
+    }
+    
+    // A missing factor is treated as zero
+    const double *x_data = input[1], *y_trans_data = input[2];
+    if(x_data==0 || y_trans_data==0) return;
+    
+    // z += mul(x,trans(y)), as in Matrix<T>::mul_no_alloc_nt
+    const vector<int> &x_rowind = this->dep(1).sparsity().rowind();
+    const vector<int> &x_col = this->dep(1).sparsity().col();
+    const vector<int> &y_colind = this->dep(2).sparsity().rowind();
+    const vector<int> &y_row = this->dep(2).sparsity().col();
+    const vector<int> &z_rowind = sp_z.rowind();
+    const vector<int> &z_col = sp_z.col();
+    for(int i=0; i<z_rowind.size()-1; ++i){
+      for(int el=z_rowind[i]; el<z_rowind[i+1]; ++el){
+        int j = z_col[el];
+        int el1 = x_rowind[i];
+        int el2 = y_colind[j];
+        while(el1 < x_rowind[i+1] && el2 < y_colind[j+1]){
+          int j1 = x_col[el1];
+          int i2 = y_row[el2];      
+          if(j1==i2){
+            z_data[el] += x_data[el1++] * y_trans_data[el2++];
+          } else if(j1<i2) {
+            el1++;
+          } else {
+            el2++;
+          }
+        }
+      }
+    }
+  }
+
   template<bool TrX, bool TrY>
   void Multiplication<TrX,TrY>::evaluateSX(const SXMatrixPtrV& input, SXMatrixPtrV& output, const SXMatrixPtrVV& fwdSeed, SXMatrixPtrVV& fwdSens, const SXMatrixPtrVV& adjSeed, SXMatrixPtrVV& adjSens){
     evaluateGen<SX,SXMatrixPtrV,SXMatrixPtrVV>(input,output,fwdSeed,fwdSens,adjSeed,adjSens);
@@ -254,6 +254,37 @@ namespace CasADi{
     evaluateD(input,output,fwdSeed, fwdSens, adjSeed, adjSens, itmp, rtmp);
   }
   
+  void MXNode::evaluateD(const double** input, double** output, int* itmp, double* rtmp){
+    // Copy the arguments to temporary matrices
+    vector<DMatrix> arg(ndep()), res(getNumOutputs());
+    DMatrixPtrV argp(arg.size(),0), resp(res.size(),0);
+    for(int i=0; i<arg.size(); ++i){
+      if(input[i]!=0 && !dep(i).isNull()){
+        arg[i] = DMatrix(dep(i).sparsity(),0);
+        copy(input[i],input[i]+arg[i].size(),arg[i].begin());
+        argp[i] = &arg[i];
+      }
+    }
+    for(int i=0; i<res.size(); ++i){
+      if(output[i]!=0){
+        res[i] = DMatrix(sparsity(i),0);
+        resp[i] = &res[i];
+      }
+    }
+
+    // Evaluate
+    size_t ni, nr;
+    nTmp(ni,nr);
+    vector<int> itmp_v(ni);
+    vector<double> rtmp_v(nr);
+    evaluateD(argp,resp,itmp_v,rtmp_v);
+
+    // Copy the results
+    for(int i=0; i<res.size(); ++i){
+      if(output[i]!=0) copy(res[i].begin(),res[i].end(),output[i]);
+    }
+  }
+  
   void MXNode::evaluateD(const DMatrixPtrV& input, DMatrixPtrV& output, 
                          const DMatrixPtrVV& fwdSeed, DMatrixPtrVV& fwdSens, 
                          const DMatrixPtrVV& adjSeed, DMatrixPtrVV& adjSens){
@@ -135,6 +135,10 @@ namespace CasADi{
     /** \brief  Evaluate the function, no derivatives*/
     void evaluateD(const DMatrixPtrV& input, DMatrixPtrV& output, std::vector<int>& itmp, std::vector<double>& rtmp);
 
+    /** \brief  Evaluate the function numerically, no derivatives, operating directly on the nonzeros
+        The default implementation copies the data to temporary matrices. */
+    virtual void evaluateD(const double** input, double** output, int* itmp, double* rtmp);
+
     /** \brief  Evaluate symbolically (SX) */
     virtual void evaluateSX(const SXMatrixPtrV& input, SXMatrixPtrV& output, 
                             const SXMatrixPtrVV& fwdSeed, SXMatrixPtrVV& fwdSens, 
@@ -220,6 +224,12 @@ namespace CasADi{
     /// Get number of temporary variables needed
     virtual void nTmp(size_t& ni, size_t& nr){ ni=0; nr=0;}
 
+    /// Get number of temporary variables needed when operating directly on the nonzeros
+    virtual void nWork(size_t& ni, size_t& nr){ ni=0; nr=0;}
+
+    /// Can the node be evaluated concurrently when operating directly on the nonzeros
+    virtual bool isReentrant() const{ return true;}
+
     /// Set unary dependency
     void setDependencies(const MX& dep);
     
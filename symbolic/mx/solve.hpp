@@ -70,6 +70,9 @@ namespace CasADi{
     /// Can the operation be performed inplace (i.e. overwrite the result)
     virtual int numInplace() const{ return 1;}
 
+    /// The linear solver instance is shared between calls
+    virtual bool isReentrant() const{ return false;}
+
     /** \brief  Get function reference */
     virtual FX& getFunction(){ return linear_solver_;}
 
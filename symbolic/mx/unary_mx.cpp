@@ -53,6 +53,12 @@ namespace CasADi{
     }
   }
 
+  void UnaryMX::evaluateD(const double** input, double** output, int* itmp, double* rtmp){
+    double nan = numeric_limits<double>::quiet_NaN();
+    for(int i=0; i<size(); ++i)
+      casadi_math<double>::fun(op_,input[0][i],nan,output[0][i]);
+  }
+
   void UnaryMX::evaluateD(const DMatrixPtrV& input, DMatrixPtrV& output, const DMatrixPtrVV& fwdSeed, DMatrixPtrVV& fwdSens, const DMatrixPtrVV& adjSeed, DMatrixPtrVV& adjSens){
     double nan = numeric_limits<double>::quiet_NaN();
     vector<double> &outputd = output[0]->data();
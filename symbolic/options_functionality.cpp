@@ -24,6 +24,7 @@
 
 #include "stl_vector_tools.hpp"
 #include "casadi_exception.hpp"
+#include "casadi_options.hpp"
 #include <algorithm>
 #include <string>
 #include <ctype.h>
@@ -34,6 +35,8 @@ using namespace std;
 
 namespace CasADi {
 
+CASADI_THREAD_LOCAL int OptionsFunctionalityNode::evaluation_depth_ = 0;
+
 
 double OptionsFunctionalityNode::wordDistance(const std::string &a,const std::string &b) {
   /// Levenshtein edit distance
@@ -221,6 +224,14 @@ GenericType OptionsFunctionalityNode::getOption(const string &name) const{
     }
     casadi_error(ss.str());
   }
+
+  // Report lookups on evaluation paths
+  if(CasadiOptions::debug_option_access && evaluation_depth_>0){
+    Dictionary::const_iterator it_name = dictionary_.find("name");
+    cerr << "CasADi warning: option \"" << name << "\" of ";
+    if(it_name!=dictionary_.end()) cerr << "\"" << it_name->second << "\" ";
+    cerr << "looked up during evaluation, consider reading it in init()" << endl;
+  }
   
   // Return the option
   return GenericType(it->second);
@@ -25,6 +25,7 @@
 
 #include "generic_type.hpp"
 #include "shared_object.hpp"
+#include "casadi_options.hpp"
 #include <map>
 
 namespace CasADi{
@@ -242,6 +243,21 @@ virtual ~OptionsFunctionalityNode();
   /** \brief A distance metric between two words */
   static double wordDistance(const std::string &a,const std::string &b);
 
+  /** \brief Number of function evaluations in progress in the calling thread.
+  *  Only tracked when CasadiOptions::debug_option_access is set, see FX::evaluate.
+  *  Zero while an object is being initialized, see SharedObject::init.
+  */
+  static CASADI_THREAD_LOCAL int evaluation_depth_;
+
+  /** \brief Suspends the tracking of evaluations in the calling thread during its lifetime,
+  *  for the initialization or generation of objects on an evaluation path.
+  */
+  struct NoEvaluationScope{
+    NoEvaluationScope() : evaluation_depth(evaluation_depth_){ evaluation_depth_ = 0;}
+    ~NoEvaluationScope(){ evaluation_depth_ = evaluation_depth;}
+    int evaluation_depth;
+  };
+
 protected:
 
 
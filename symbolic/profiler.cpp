@@ -0,0 +1,316 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "profiler.hpp"
+#include "thread_pool.hpp"
+#include "casadi_exception.hpp"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <set>
+#ifdef WITH_THREADS
+#include <pthread.h>
+#endif // WITH_THREADS
+#ifndef _WIN32
+#include <time.h>
+#include <sys/time.h>
+#endif // _WIN32
+
+using namespace std;
+
+namespace CasADi{
+
+  CASADI_THREAD_LOCAL Profiler::Buffer* Profiler::local_buffer_ = 0;
+  CASADI_THREAD_LOCAL int Profiler::local_session_ = 0;
+  int Profiler::session_ = 0;
+
+  namespace{
+    /// State of the profiling session, only accessed outside of the event recording
+    struct ProfilerSession{
+      /// File to write to
+      string filename;
+      /// Number of events per thread
+      int buffer_size;
+      /// Event buffers of all threads
+      vector<Profiler::Buffer*> buffers;
+      /// Function names
+      vector<string> names;
+      /// Descriptions of the algorithm elements
+      vector<vector<string> > nodes;
+      /// Ids of the registered objects
+      map<const void*,int> ids;
+      /// Wall time and ticks at the start of the session
+      double wall_start;
+      unsigned long long ticks_start;
+#ifdef WITH_THREADS
+      /// Protects the above
+      pthread_mutex_t mutex;
+      ProfilerSession(){ pthread_mutex_init(&mutex,0);}
+      ~ProfilerSession(){ pthread_mutex_destroy(&mutex);}
+#endif // WITH_THREADS
+    };
+
+    ProfilerSession& getProfilerSession(){
+      static ProfilerSession s;
+      return s;
+    }
+
+    /// Scoped lock of the session state
+    struct ProfilerLock{
+#ifdef WITH_THREADS
+      ProfilerLock(){ pthread_mutex_lock(&getProfilerSession().mutex);}
+      ~ProfilerLock(){ pthread_mutex_unlock(&getProfilerSession().mutex);}
+#endif // WITH_THREADS
+    };
+
+    /// Write a string as a JSON string literal
+    void writeJSON(ostream& stream, const string& s){
+      stream << '"';
+      for(string::const_iterator c=s.begin(); c!=s.end(); ++c){
+        switch(*c){
+          case '"': stream << "\\\""; break;
+          case '\\': stream << "\\\\"; break;
+          case '\n': stream << "\\n"; break;
+          case '\t': stream << "\\t"; break;
+          default:
+            if(static_cast<unsigned char>(*c)<0x20){
+              stream << "\\u" << hex << setw(4) << setfill('0') << int(*c) << dec << setfill(' ');
+            } else {
+              stream << *c;
+            }
+        }
+      }
+      stream << '"';
+    }
+
+    /// Aggregated statistics of a function or an algorithm element
+    struct ProfilerStats{
+      ProfilerStats() : calls(0), inclusive(0), exclusive(0), nfdir(0), nadir(0){}
+      long calls;
+      double inclusive;
+      double exclusive;
+      long nfdir;
+      long nadir;
+      set<int> callees;
+    };
+
+    /// An interval which has begun but not yet ended
+    struct OpenInterval{
+      const Profiler::Event* begin;
+      double child_time;
+    };
+  } // namespace
+
+  void Profiler::start(const std::string& filename, int buffer_size){
+    if(CasadiOptions::profiling) stop();
+    
+    // Check that the file can be written before starting
+    ofstream test(filename.c_str());
+    casadi_assert_message(test.is_open(), "Did not manage to open file " << filename << " for logging.");
+    test.close();
+    
+    // Round the buffer size up to a power of two
+    int n = 1;
+    while(n<buffer_size) n *= 2;
+
+    ProfilerSession& s = getProfilerSession();
+    ProfilerLock lock;
+    s.filename = filename;
+    s.buffer_size = n;
+    s.names.clear();
+    s.nodes.clear();
+    s.ids.clear();
+    s.wall_start = ThreadPool::getWallTime();
+    s.ticks_start = getTicks();
+    session_++;
+    CasadiOptions::profiling = true;
+  }
+
+  void Profiler::stop(){
+    if(!CasadiOptions::profiling) return;
+    CasadiOptions::profiling = false;
+    ProfilerSession& s = getProfilerSession();
+    
+    // Calibrate the ticks against the wall time
+    double wall_stop = ThreadPool::getWallTime();
+    unsigned long long ticks_stop = getTicks();
+    double sec_per_tick = ticks_stop>s.ticks_start ? (wall_stop-s.wall_start)/double(ticks_stop-s.ticks_start) : 0;
+    
+    // Write the results
+    ofstream stream(s.filename.c_str());
+    write(stream,sec_per_tick);
+    
+    // Free the buffers, the threads will allocate new ones in the next session
+    ProfilerLock lock;
+    for(vector<Buffer*>::iterator it=s.buffers.begin(); it!=s.buffers.end(); ++it) delete *it;
+    s.buffers.clear();
+    s.ids.clear();
+    session_++;
+  }
+
+  Profiler::Buffer* Profiler::getLocalBuffer(){
+    ProfilerSession& s = getProfilerSession();
+    ProfilerLock lock;
+    Buffer* b = new Buffer();
+    b->events.resize(s.buffer_size);
+    b->count = 0;
+    b->thread = s.buffers.size();
+    s.buffers.push_back(b);
+    local_buffer_ = b;
+    local_session_ = session_;
+    return b;
+  }
+
+  unsigned long long Profiler::getTicksFallback(){
+#ifdef _WIN32
+    return static_cast<unsigned long long>(ThreadPool::getWallTime()*1e9);
+#else // _WIN32
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return static_cast<unsigned long long>(ts.tv_sec)*1000000000ULL + ts.tv_nsec;
+#endif // _WIN32
+  }
+
+  int Profiler::registerFunction(const void* obj, const std::string& name, const std::vector<std::string>& nodes, int& session, int& id){
+    ProfilerSession& s = getProfilerSession();
+    ProfilerLock lock;
+    map<const void*,int>::const_iterator it = s.ids.find(obj);
+    if(it!=s.ids.end()){
+      id = it->second;
+    } else {
+      id = s.names.size();
+      s.names.push_back(name);
+      s.nodes.push_back(nodes);
+      s.ids[obj] = id;
+    }
+    session = session_;
+    return id;
+  }
+
+  int Profiler::cachedId(const int& session, const int& id){
+    ProfilerLock lock;
+    return session==session_ ? id : -1;
+  }
+
+  void Profiler::unregisterFunction(const void* obj){
+    ProfilerSession& s = getProfilerSession();
+    ProfilerLock lock;
+    s.ids.erase(obj);
+  }
+
+  void Profiler::write(std::ostream& stream, double sec_per_tick){
+    ProfilerSession& s = getProfilerSession();
+    ProfilerLock lock;
+    
+    // Aggregated statistics for each function (node -1) and algorithm element
+    map<pair<int,int>,ProfilerStats> stats;
+    
+    stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << endl;
+    stream << setprecision(15);
+    bool first = true;
+    long dropped = 0;
+    for(vector<Buffer*>::const_iterator b=s.buffers.begin(); b!=s.buffers.end(); ++b){
+      const vector<Event>& ev = (*b)->events;
+      unsigned long long mask = ev.size()-1;
+      unsigned long long count = (*b)->count;
+      unsigned long long first_event = count>ev.size() ? count-ev.size() : 0;
+      dropped += first_event;
+      
+      // Match the events into intervals
+      vector<OpenInterval> open;
+      for(unsigned long long k=first_event; k<count; ++k){
+        const Event& e = ev[k & mask];
+        if(e.begin){
+          OpenInterval o = {&e,0};
+          open.push_back(o);
+          continue;
+        }
+
+        // Find the matching beginning, intervals left open by exceptions are discarded
+        int m = open.size()-1;
+        while(m>=0 && (open[m].begin->fcn!=e.fcn || open[m].begin->node!=e.node)) m--;
+        if(m<0) continue; // began before the oldest event in the buffer
+        open.resize(m+1);
+        const Event& e0 = *open.back().begin;
+        double inclusive = double(e.ticks-e0.ticks)*sec_per_tick;
+        ProfilerStats& st = stats[make_pair(e.fcn,e.node<0 ? -1 : e.node)];
+        st.calls++;
+        st.inclusive += inclusive;
+        st.exclusive += inclusive - open.back().child_time;
+        st.nfdir += e0.nfdir;
+        st.nadir += e0.nadir;
+        open.pop_back();
+        if(!open.empty()){
+          open.back().child_time += inclusive;
+          if(e.node<0){
+            const Event& p = *open.back().begin;
+            stats[make_pair(p.fcn,p.node<0 ? -1 : p.node)].callees.insert(e.fcn);
+          }
+        }
+        
+        // Trace event
+        if(!first) stream << "," << endl;
+        first = false;
+        stream << "{\"name\":";
+        stringstream name;
+        name << (e.fcn<s.names.size() ? s.names[e.fcn] : "unknown");
+        if(e.node>=0){
+          name << ":" << e.node;
+          if(e.fcn<s.nodes.size() && e.node<s.nodes[e.fcn].size()) name << " " << s.nodes[e.fcn][e.node];
+        }
+        writeJSON(stream,name.str());
+        stream << ",\"cat\":\"" << (e.node<0 ? "function" : "node") << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << (*b)->thread;
+        stream << ",\"ts\":" << double(e0.ticks-s.ticks_start)*sec_per_tick*1e6 << ",\"dur\":" << inclusive*1e6;
+        stream << ",\"args\":{\"fcn\":" << e.fcn << ",\"node\":" << e.node << ",\"nfdir\":" << e0.nfdir << ",\"nadir\":" << e0.nadir << "}}";
+      }
+    }
+    stream << endl << "]," << endl;
+    
+    // Functions
+    stream << "\"casadiFunctions\":[";
+    for(int i=0; i<s.names.size(); ++i){
+      if(i>0) stream << ",";
+      writeJSON(stream,s.names[i]);
+    }
+    stream << "]," << endl;
+    
+    // Aggregated statistics
+    stream << "\"casadiStats\":[" << endl;
+    for(map<pair<int,int>,ProfilerStats>::const_iterator it=stats.begin(); it!=stats.end(); ++it){
+      int fcn = it->first.first, node = it->first.second;
+      const ProfilerStats& st = it->second;
+      if(it!=stats.begin()) stream << "," << endl;
+      stream << "{\"fcn\":" << fcn << ",\"node\":" << node << ",\"description\":";
+      writeJSON(stream, node>=0 && fcn<s.nodes.size() && node<s.nodes[fcn].size() ? s.nodes[fcn][node] : string());
+      stream << ",\"calls\":" << st.calls << ",\"inclusive\":" << st.inclusive << ",\"exclusive\":" << st.exclusive;
+      stream << ",\"nfdir\":" << st.nfdir << ",\"nadir\":" << st.nadir << ",\"callees\":[";
+      for(set<int>::const_iterator c=st.callees.begin(); c!=st.callees.end(); ++c){
+        if(c!=st.callees.begin()) stream << ",";
+        stream << *c;
+      }
+      stream << "]}";
+    }
+    stream << endl << "]," << endl;
+    stream << "\"casadiDroppedEvents\":" << dropped << "}" << endl;
+  }
+
+} // namespace CasADi
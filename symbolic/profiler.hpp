@@ -0,0 +1,148 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <vector>
+#include <string>
+#include <map>
+#include <iostream>
+#include "casadi_options.hpp"
+
+namespace CasADi{
+
+  /** \brief Low-overhead profiler for function evaluations
+  
+      While profiling is active (CasadiOptions::profiling), the beginning and end of each evaluation of a function, 
+      and of each element of its algorithm, are written as fixed-size binary records into a ring buffer owned by the 
+      calling thread. Recording an event therefore requires neither locks nor formatting, only a time stamp read from 
+      the processor's time-stamp counter where available. When the buffer of a thread is full, its oldest events are 
+      overwritten.
+      
+      When profiling is stopped, the events are matched into intervals and written to a file in the Chrome trace 
+      event format, which can be viewed in chrome://tracing. The file also contains the call count, the inclusive 
+      and exclusive time and the number of derivative directions for each function and each algorithm element
+      (key "casadiStats"), see casadi.tools.profilereport.
+      
+      Profiling should be started and stopped when no evaluation is in progress.
+  */
+  class Profiler{
+  public:
+    /// Start a profiling session, the results are written to filename when the session is stopped
+    static void start(const std::string& filename, int buffer_size=1<<20);
+    
+    /// Stop the profiling session and write the results
+    static void stop();
+    
+    /// Record the beginning of the evaluation of a function (node<0) or of an element of its algorithm
+    static inline void begin(int fcn, int node, int nfdir=0, int nadir=0){ record(fcn,node,nfdir,nadir,true);}
+
+    /// Record the end of the evaluation of a function (node<0) or of an element of its algorithm
+    static inline void end(int fcn, int node, int nfdir=0, int nadir=0){ record(fcn,node,nfdir,nadir,false);}
+    
+    /** \brief Register a function in the current session and get its id
+        The descriptions of the algorithm elements are used to label the node events. If the same object 
+        is registered twice in a session, the existing id is returned. The session and the id are stored in
+        session and id, a registration cached by the caller that is written under the registry mutex. */
+    static int registerFunction(const void* obj, const std::string& name, const std::vector<std::string>& nodes, int& session, int& id);
+
+    /// The id of a registration cached by registerFunction, read under the registry mutex, or -1 if it is not from the current session
+    static int cachedId(const int& session, const int& id);
+    
+    /// Forget an object registered in the current session, since the address may be reused
+    static void unregisterFunction(const void* obj);
+    
+    /// Current session, zero if profiling was never started
+    static int getSession(){ return session_;}
+
+    /// Time stamp in ticks, the length of which is determined by calibration against the wall time
+    static inline unsigned long long getTicks(){
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+      return __builtin_ia32_rdtsc();
+#else
+      return getTicksFallback();
+#endif
+    }
+    
+    /// An event
+    struct Event{
+      /// Time stamp
+      unsigned long long ticks;
+      /// Function id
+      int fcn;
+      /// Algorithm element, negative for the function as a whole
+      int node;
+      /// Number of forward directions
+      int nfdir;
+      /// Number of adjoint directions
+      int nadir;
+      /// Beginning (true) or end (false) of an interval
+      bool begin;
+    };
+    
+    /// Ring buffer of the events of one thread
+    struct Buffer{
+      /// Events, the size is a power of two
+      std::vector<Event> events;
+      /// Total number of events recorded, the last min(count,events.size()) of which are stored
+      unsigned long long count;
+      /// Thread number in the trace
+      int thread;
+    };
+    
+  private:
+    /// Record an event
+    static inline void record(int fcn, int node, int nfdir, int nadir, bool begin){
+      Buffer* b = local_buffer_;
+      if(b==0 || local_session_!=session_) b = getLocalBuffer();
+      Event& e = b->events[b->count++ & (b->events.size()-1)];
+      e.ticks = getTicks();
+      e.fcn = fcn;
+      e.node = node;
+      e.nfdir = nfdir;
+      e.nadir = nadir;
+      e.begin = begin;
+    }
+    
+    /// Get the buffer of the calling thread, allocating it if needed
+    static Buffer* getLocalBuffer();
+    
+    /// Time stamp in nanoseconds, for processors without time-stamp counter
+    static unsigned long long getTicksFallback();
+    
+    /// Write the events of a session in the Chrome trace event format
+    static void write(std::ostream& stream, double sec_per_tick);
+    
+    /// Buffer of the current thread
+    static CASADI_THREAD_LOCAL Buffer* local_buffer_;
+    
+    /// Session for which the buffer of the current thread was allocated
+    static CASADI_THREAD_LOCAL int local_session_;
+    
+    /// Current session
+    static int session_;
+  };
+
+} // namespace CasADi
+
+#endif // PROFILER_HPP
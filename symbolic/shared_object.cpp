@@ -23,6 +23,7 @@
 #include "shared_object.hpp"
 #include "casadi_exception.hpp"
 #include "weak_ref.hpp"
+#include "options_functionality.hpp"
 
 #include <typeinfo>
 #include <cassert>
@@ -127,6 +128,8 @@ SharedObjectNode::~SharedObjectNode(){
 
 void SharedObject::init(bool allow_reinit){
   if(allow_reinit || !isInit()){
+    // Option lookups during an initialization are not reported, also when it is triggered by an evaluation
+    OptionsFunctionalityNode::NoEvaluationScope scope;
     (*this)->init();
   }
 }
@@ -123,6 +123,20 @@ class BinarySX : public SXNode{
       }
     }
     
+    /** \brief  Allocate from the pool of nodes of this type */
+    static void* operator new(std::size_t size){
+      return size==sizeof(BinarySX) ? SXNodePool<BinarySX>::allocate() : ::operator new(size);
+    }
+    
+    /** \brief  Return to the pool */
+    static void operator delete(void* p, std::size_t size){
+      if(size==sizeof(BinarySX)){
+        SXNodePool<BinarySX>::deallocate(p);
+      } else {
+        ::operator delete(p);
+      }
+    }
+    
     virtual bool isSmooth() const{ return operation_checker<SmoothChecker>(op_);}
     
     virtual bool hasDep() const{ return true; }
@@ -21,6 +21,8 @@
  */
 
 #include "sx_node.hpp"
+#include "binary_sx.hpp"
+#include "unary_sx.hpp"
 #include <limits>
 #include <typeinfo>
 #include <cassert>
@@ -121,5 +123,21 @@ void SXNode::mark(){
   temp = -temp-1;
 }
 
+template<typename Node>
+void* SXNodePool<Node>::free_list_ = 0;
+
+template<typename Node>
+void* SXNodePool<Node>::chunks_ = 0;
+
+template<typename Node>
+std::size_t SXNodePool<Node>::num_used_ = 0;
+
+template<typename Node>
+std::size_t SXNodePool<Node>::num_chunks_ = 0;
+
+// The pools, defined once in the library
+template class SXNodePool<BinarySX>;
+template class SXNodePool<UnarySX>;
+
 
 } // namespace CasADi
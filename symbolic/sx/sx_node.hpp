@@ -26,6 +26,8 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <cstdlib>
+#include <new>
 #include <math.h>
 
 /** \brief  Scalar expression (which also works as a smart pointer class to this class) */
@@ -114,6 +116,96 @@ unsigned int count;
 
 };
 
+/** \brief Pool of memory blocks for the nodes of type Node in SX expression graphs
+  Blocks are carved out of large chunks and recycled through a free list, so that creating and destroying
+  a node does not require calls to malloc and free. There is one pool per node type for the whole process,
+  not one per expression graph, and the chunks are released all or nothing: only when the last node of the type 
+  in the process is destroyed, and then all chunks are freed if more than one was allocated. As long as any
+  node of the type is alive, e.g. in a long-lived expression, the chunks of the largest graph built so far 
+  stay allocated and are reused by later graphs.
+  
+  The static members are defined in sx_node.cpp, which explicitly instantiates the pools of BinarySX and
+  UnarySX, so that there is a single pool for each node type in the CasADi library. They are zero-initialized, 
+  so the pool can be used during static initialization.
+  
+  Like the reference counting of SXNode, the pool is not thread-safe: SX nodes must only be created and 
+  destroyed by one thread at a time. The tasks that CasADi runs on the thread pool (FX::evaluateBatch, the
+  "threads" mode of Parallelizer, "parallel_jacobian", the parallel colorings and the parallel linear solvers)
+  only evaluate numerically; the function copies they need are made beforehand by the calling thread. 
+  Functions that create expressions while being evaluated, e.g. by generating derivative functions on first 
+  use, must therefore not be evaluated concurrently.
+*/
+template<typename Node>
+class SXNodePool{
+  public:
+    /// Number of blocks in each chunk
+    static const std::size_t chunk_blocks = 4096;
+
+    /// Get a block
+    static inline void* allocate(){
+      if(free_list_==0) grow();
+      void* ret = free_list_;
+      free_list_ = *static_cast<void**>(ret);
+      num_used_++;
+      return ret;
+    }
+
+    /// Return a block
+    static inline void deallocate(void* p){
+      *static_cast<void**>(p) = free_list_;
+      free_list_ = p;
+      if(--num_used_==0 && num_chunks_>1) release();
+    }
+
+    /// Number of blocks in use
+    static std::size_t getNumUsed(){ return num_used_;}
+
+    /// Number of chunks allocated
+    static std::size_t getNumChunks(){ return num_chunks_;}
+
+  private:
+    /// Allocate a new chunk and add its blocks to the free list
+    static void grow(){
+      // The first word of each chunk links to the previously allocated chunk
+      char* chunk = static_cast<char*>(std::malloc(header_size + chunk_blocks*sizeof(Node)));
+      if(chunk==0) throw std::bad_alloc();
+      *reinterpret_cast<void**>(chunk) = chunks_;
+      chunks_ = chunk;
+      num_chunks_++;
+      
+      // Link the blocks, in order of increasing address
+      char* first = chunk + header_size;
+      for(std::size_t i=chunk_blocks; i-->0; ){
+        void* b = first + i*sizeof(Node);
+        *static_cast<void**>(b) = free_list_;
+        free_list_ = b;
+      }
+    }
+    
+    /// Free all chunks, only called when no blocks are in use
+    static void release(){
+      while(chunks_!=0){
+        void* next = *static_cast<void**>(chunks_);
+        std::free(chunks_);
+        chunks_ = next;
+      }
+      free_list_ = 0;
+      num_chunks_ = 0;
+    }
+
+    /// Size of the chunk header, keeping the blocks aligned
+    static const std::size_t header_size = sizeof(double)>sizeof(void*) ? sizeof(double) : sizeof(void*);
+
+    /// Free blocks, linked through their first word
+    static void* free_list_;
+    
+    /// Allocated chunks, linked through their first word
+    static void* chunks_;
+    
+    /// Number of blocks in use and number of chunks
+    static std::size_t num_used_, num_chunks_;
+};
+
 } // namespace CasADi
 
 #endif // SX_NODE_HPP
@@ -57,6 +57,20 @@ class UnarySX : public SXNode{
     /** \brief Destructor */
     virtual ~UnarySX(){}
     
+    /** \brief  Allocate from the pool of nodes of this type */
+    static void* operator new(std::size_t size){
+      return size==sizeof(UnarySX) ? SXNodePool<UnarySX>::allocate() : ::operator new(size);
+    }
+    
+    /** \brief  Return to the pool */
+    static void operator delete(void* p, std::size_t size){
+      if(size==sizeof(UnarySX)){
+        SXNodePool<UnarySX>::deallocate(p);
+      } else {
+        ::operator delete(p);
+      }
+    }
+    
     virtual bool isSmooth() const{ return operation_checker<SmoothChecker>(op_);}
     
     virtual bool hasDep() const{ return true; }
@@ -0,0 +1,289 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "thread_pool.hpp"
+#include "casadi_exception.hpp"
+#include "casadi_options.hpp"
+#include <algorithm>
+#ifdef _WIN32
+#include <windows.h>
+#else // _WIN32
+#include <unistd.h>
+#include <sys/time.h>
+#endif // _WIN32
+
+using namespace std;
+
+namespace CasADi{
+
+  ThreadPool::ThreadPool(int num_threads){
+    num_threads_ = num_threads>0 ? num_threads : getNumProcessors();
+#ifndef WITH_THREADS
+    num_threads_ = 1;
+#endif // WITH_THREADS
+    queue_.resize(num_threads_);
+    
+#ifdef WITH_THREADS
+    // Synchronization objects
+    queue_mutex_.resize(num_threads_);
+    for(int i=0; i<num_threads_; ++i){
+      pthread_mutex_init(&queue_mutex_[i],0);
+    }
+    pthread_mutex_init(&mutex_,0);
+    pthread_mutex_init(&run_mutex_,0);
+    pthread_cond_init(&cond_start_,0);
+    pthread_cond_init(&cond_finish_,0);
+    generation_ = 0;
+    active_ = 0;
+    stop_ = false;
+    busy_ = false;
+#ifndef _WIN32
+    pid_ = getpid();
+#endif // _WIN32
+    
+    // Start the workers, the calling thread acts as thread 0
+    workers_.resize(num_threads_-1);
+    worker_arg_.resize(num_threads_-1);
+    for(int i=0; i<workers_.size(); ++i){
+      worker_arg_[i] = make_pair(this,i+1);
+      int flag = pthread_create(&workers_[i],0,workerMain,&worker_arg_[i]);
+      casadi_assert_message(flag==0,"ThreadPool: Could not create thread, error code " << flag);
+    }
+#endif // WITH_THREADS
+  }
+
+  ThreadPool::~ThreadPool(){
+#ifdef WITH_THREADS
+    // Shut down the workers
+    pthread_mutex_lock(&mutex_);
+    stop_ = true;
+    pthread_cond_broadcast(&cond_start_);
+    pthread_mutex_unlock(&mutex_);
+    for(int i=0; i<workers_.size(); ++i){
+      pthread_join(workers_[i],0);
+    }
+    
+    // Free synchronization objects
+    for(int i=0; i<queue_mutex_.size(); ++i){
+      pthread_mutex_destroy(&queue_mutex_[i]);
+    }
+    pthread_mutex_destroy(&mutex_);
+    pthread_mutex_destroy(&run_mutex_);
+    pthread_cond_destroy(&cond_start_);
+    pthread_cond_destroy(&cond_finish_);
+#endif // WITH_THREADS
+  }
+
+  ThreadPool& ThreadPool::getInstance(){
+    static ThreadPool instance(CasadiOptions::num_threads);
+    return instance;
+  }
+
+  int ThreadPool::getNumProcessors(){
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return std::max(1,int(info.dwNumberOfProcessors));
+#else // _WIN32
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n>0 ? int(n) : 1;
+#endif // _WIN32
+  }
+
+  double ThreadPool::getWallTime(){
+#ifdef _WIN32
+    return GetTickCount()/1000.0;
+#else // _WIN32
+    struct timeval tm;
+    gettimeofday(&tm,0);
+    return tm.tv_sec + tm.tv_usec/1000000.0;
+#endif // _WIN32
+  }
+
+  void ThreadPool::runSerial(TaskFcn fcn, void* user_data, int ntask, std::vector<int>* allocation){
+    if(allocation) allocation->assign(ntask,0);
+    for(int task=0; task<ntask; ++task){
+      fcn(user_data,task,0);
+    }
+  }
+
+  void ThreadPool::run(TaskFcn fcn, void* user_data, int ntask, const double* cost, std::vector<int>* allocation){
+#ifdef WITH_THREADS
+#ifndef _WIN32
+    // The worker threads do not exist in a process forked after the pool was created (see Parallelizer)
+    if(getpid()!=pid_){
+      runSerial(fcn,user_data,ntask,allocation);
+      return;
+    }
+#endif // _WIN32
+
+    // Execute serially if there is nothing to parallelize or if called from within a task
+    if(num_threads_==1 || ntask<=1 || inTask()){
+      runSerial(fcn,user_data,ntask,allocation);
+      return;
+    }
+    
+    // Wait for batches submitted from other threads
+    pthread_mutex_lock(&run_mutex_);
+    
+    // Order the tasks by decreasing cost
+    vector<int> order(ntask);
+    for(int task=0; task<ntask; ++task) order[task] = task;
+    vector<pair<double,int> > cost_task;
+    if(cost){
+      cost_task.resize(ntask);
+      for(int task=0; task<ntask; ++task) cost_task[task] = make_pair(-cost[task],task);
+      stable_sort(cost_task.begin(),cost_task.end());
+      for(int task=0; task<ntask; ++task) order[task] = cost_task[task].second;
+    }
+    
+    // Assign each task to the thread with the least work so far
+    vector<double> load(num_threads_,0);
+    for(vector<int>::const_iterator it=order.begin(); it!=order.end(); ++it){
+      int thread = min_element(load.begin(),load.end()) - load.begin();
+      queue_[thread].push_back(*it);
+      load[thread] += cost ? std::max(cost[*it],0.0) + 1e-9 : 1;
+    }
+    
+    // Start the workers
+    fcn_ = fcn;
+    user_data_ = user_data;
+    allocation_ = allocation;
+    if(allocation) allocation->resize(ntask);
+    failed_ = false;
+    error_.clear();
+    pthread_mutex_lock(&mutex_);
+    owner_ = pthread_self();
+    busy_ = true;
+    active_ = num_threads_-1;
+    generation_++;
+    pthread_cond_broadcast(&cond_start_);
+    pthread_mutex_unlock(&mutex_);
+    
+    // Take part in the work
+    work(0);
+    
+    // Wait for the workers to finish
+    pthread_mutex_lock(&mutex_);
+    while(active_>0) pthread_cond_wait(&cond_finish_,&mutex_);
+    busy_ = false;
+    pthread_mutex_unlock(&mutex_);
+    
+    // Allow new batches
+    bool failed = failed_;
+    string error = error_;
+    pthread_mutex_unlock(&run_mutex_);
+    
+    // Pass on errors
+    if(failed) throw CasadiException(error);
+#else // WITH_THREADS
+    runSerial(fcn,user_data,ntask,allocation);
+#endif // WITH_THREADS
+  }
+
+#ifdef WITH_THREADS
+  void* ThreadPool::workerMain(void* arg){
+    pair<ThreadPool*,int>* a = static_cast<pair<ThreadPool*,int>*>(arg);
+    ThreadPool* pool = a->first;
+    int thread = a->second;
+    unsigned long generation = 0;
+    while(true){
+      // Wait for a new batch
+      pthread_mutex_lock(&pool->mutex_);
+      while(!pool->stop_ && pool->generation_==generation){
+        pthread_cond_wait(&pool->cond_start_,&pool->mutex_);
+      }
+      if(pool->stop_){
+        pthread_mutex_unlock(&pool->mutex_);
+        return 0;
+      }
+      generation = pool->generation_;
+      pthread_mutex_unlock(&pool->mutex_);
+      
+      // Process tasks
+      pool->work(thread);
+      
+      // Mark finished
+      pthread_mutex_lock(&pool->mutex_);
+      if(--pool->active_==0) pthread_cond_signal(&pool->cond_finish_);
+      pthread_mutex_unlock(&pool->mutex_);
+    }
+  }
+
+  bool ThreadPool::inTask(){
+    pthread_t self = pthread_self();
+
+    // The owner of the current batch, read under the lock since another thread may be starting or finishing a batch
+    pthread_mutex_lock(&mutex_);
+    bool owner = busy_ && pthread_equal(owner_,self);
+    pthread_mutex_unlock(&mutex_);
+    if(owner) return true;
+
+    // The worker threads never change after construction
+    for(vector<pthread_t>::const_iterator it=workers_.begin(); it!=workers_.end(); ++it){
+      if(pthread_equal(*it,self)) return true;
+    }
+    return false;
+  }
+
+  int ThreadPool::nextTask(int thread){
+    // Look in the own queue first, then in the queues of the other threads
+    for(int k=0; k<num_threads_; ++k){
+      int victim = (thread+k) % num_threads_;
+      pthread_mutex_lock(&queue_mutex_[victim]);
+      deque<int>& q = queue_[victim];
+      int task = -1;
+      if(!q.empty()){
+        if(k==0){
+          task = q.front();
+          q.pop_front();
+        } else {
+          // Steal from the back of another queue
+          task = q.back();
+          q.pop_back();
+        }
+      }
+      pthread_mutex_unlock(&queue_mutex_[victim]);
+      if(task>=0) return task;
+    }
+    return -1;
+  }
+
+  void ThreadPool::work(int thread){
+    int task;
+    while((task=nextTask(thread))>=0){
+      if(allocation_) (*allocation_)[task] = thread;
+      try{
+        fcn_(user_data_,task,thread);
+      } catch(exception& ex){
+        pthread_mutex_lock(&mutex_);
+        if(!failed_){
+          failed_ = true;
+          error_ = ex.what();
+        }
+        pthread_mutex_unlock(&mutex_);
+      }
+    }
+  }
+#endif // WITH_THREADS
+
+} // namespace CasADi
@@ -0,0 +1,156 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010 by Joel Andersson, Moritz Diehl, K.U.Leuven. All rights reserved.
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <deque>
+#include <string>
+#ifdef WITH_THREADS
+#include <pthread.h>
+#endif // WITH_THREADS
+
+namespace CasADi{
+
+  /** \brief Persistent pool of worker threads with work stealing
+  
+      A batch of independent tasks is distributed over one queue per thread. Each thread 
+      processes its own queue from the front and, when it runs empty, steals tasks from the
+      back of the other queues. The calling thread takes part in the work as thread 0.
+      
+      If the tasks are given in order of decreasing cost, cheap tasks are the ones being 
+      stolen, which keeps the load balanced also when the task costs differ a lot.
+      
+      A batch started from within a task of the same pool is executed serially by the 
+      calling thread, as is a batch started in a child process forked after the pool
+      was created, since the worker threads are not duplicated by fork. Without thread support (WITH_THREADS not defined), all batches are
+      executed serially.
+  */
+  class ThreadPool{
+  public:
+    /// Function executing a task
+    typedef void (*TaskFcn)(void* user_data, int task, int thread);
+    
+    /// Create a pool with a given number of threads (including the calling thread), 0 means the number of processors
+    explicit ThreadPool(int num_threads=0);
+    
+    /// Destructor, joins the worker threads
+    ~ThreadPool();
+    
+    /// Get the pool shared by all of CasADi, created on first use with CasadiOptions::getNumThreads threads
+    static ThreadPool& getInstance();
+    
+    /// Get the number of processors available
+    static int getNumProcessors();
+    
+    /// Wall clock time in seconds, for measuring the duration of tasks
+    static double getWallTime();
+    
+    /// Number of threads, including the calling thread
+    int getNumThreads() const{ return num_threads_;}
+    
+    /** \brief Execute a batch of tasks and wait for all of them to finish
+        \param fcn Function called as fcn(user_data,task,thread) for each task
+        \param ntask Number of tasks
+        \param cost Estimated cost of each task (can be null), used to balance the initial distribution
+        \param allocation If not null, filled with the thread that executed each task
+        
+        If tasks throw, the first error message is rethrown after the batch has finished.
+    */
+    void run(TaskFcn fcn, void* user_data, int ntask, const double* cost=0, std::vector<int>* allocation=0);
+    
+  private:
+    /// Not copyable
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+    
+    /// Execute a batch serially in the calling thread
+    void runSerial(TaskFcn fcn, void* user_data, int ntask, std::vector<int>* allocation);
+    
+    /// Process the queues from a given thread until all are empty
+    void work(int thread);
+    
+    /// Get the next task for a thread, -1 if none left
+    int nextTask(int thread);
+    
+    /// Number of threads
+    int num_threads_;
+    
+    /// Task queues, one per thread
+    std::vector<std::deque<int> > queue_;
+    
+    /// The current batch
+    TaskFcn fcn_;
+    void* user_data_;
+    std::vector<int>* allocation_;
+    
+    /// First error encountered in the current batch
+    std::string error_;
+    bool failed_;
+    
+#ifdef WITH_THREADS
+    /// Entry point of the worker threads
+    static void* workerMain(void* arg);
+    
+    /// Is the calling thread executing a task of this pool
+    bool inTask();
+    
+    /// Worker threads
+    std::vector<pthread_t> workers_;
+    
+    /// Arguments passed to the worker threads
+    std::vector<std::pair<ThreadPool*,int> > worker_arg_;
+    
+    /// Mutex for each queue
+    std::vector<pthread_mutex_t> queue_mutex_;
+    
+    /// Mutex and conditions for starting and finishing batches
+    pthread_mutex_t mutex_;
+    pthread_cond_t cond_start_, cond_finish_;
+    
+    /// Serializes batches submitted from different threads
+    pthread_mutex_t run_mutex_;
+    
+    /// Batch counter, incremented for each batch
+    unsigned long generation_;
+    
+    /// Number of worker threads still working on the current batch
+    int active_;
+    
+    /// Shut down the workers
+    bool stop_;
+    
+    /// Thread submitting the current batch, protected by mutex_
+    pthread_t owner_;
+    bool busy_;
+
+#ifndef _WIN32
+    /// Process that started the worker threads
+    int pid_;
+#endif // _WIN32
+#endif // WITH_THREADS
+  };
+
+} // namespace CasADi
+
+#endif // THREAD_POOL_HPP
@@ -548,6 +548,57 @@ class ADtests(casadiTestCase):
     print f.input().shape
     J=f.jacobian(0,0)
     
+  def test_parallel_jacobian(self):
+    self.message("Numeric Jacobian with parallel directional derivative sweeps")
+    def check(f_in,f_out,name,fcn=SXFunction):
+      J = []
+      for parallel in [False,True]:
+        f = fcn(f_in,f_out)
+        f.setOption("numeric_jacobian",True)
+        f.setOption("parallel_jacobian",parallel)
+        f.init()
+        J.append(f.jacobian(0,0))
+        J[-1].init()
+        for i in range(f.getNumInputs()):
+          J[-1].setInput([0.3+0.1*k+i for k in range(f.input(i).size())],i)
+        J[-1].evaluate()
+      for i in range(J[0].getNumOutputs()):
+        self.checkarray(J[1].output(i),J[0].output(i),"%s output %d" % (name,i),digits=12)
+    
+    # SXFunction with more directions than fit in one sweep
+    x = ssym("x",40)
+    y = vertcat([sin(x[i])*x[(i+1)%40]+x[(7*i)%40]**2 for i in range(30)])
+    check([x],[y,sumAll(x)],"SXFunction")
+    
+    # MXFunction with calls to an SXFunction
+    f = SXFunction([x],[y])
+    f.init()
+    X = msym("X",40)
+    [Y] = f.call([X])
+    check([X],[Y+X[:30],mul(trans(Y),Y)],"MXFunction",MXFunction)
+
+  @requires("CSparse")
+  def test_parallel_jacobian_not_reentrant(self):
+    self.message("Numeric Jacobian with parallel directional derivative sweeps of a function that is not reentrant")
+    A_ = DMatrix([[3,7,0],[1,2,0],[0,1,4]])
+    A = msym("A",A_.sparsity())
+    b = msym("b",20,3)
+    solver = CSparse(A.sparsity())
+    solver.init()
+    J = []
+    for parallel in [False,True]:
+      f = MXFunction([b,A],[solver.solve(A,b,False)])
+      f.setOption("numeric_jacobian",True)
+      f.setOption("parallel_jacobian",parallel)
+      f.init()
+      J.append(f.jacobian(0,0))
+      J[-1].init()
+      J[-1].setInput([0.3+0.1*k for k in range(60)],0)
+      J[-1].setInput(A_,1)
+      J[-1].evaluate()
+    for i in range(J[0].getNumOutputs()):
+      self.checkarray(J[1].output(i),J[0].output(i),"output %d" % i,digits=12)
+    
     
   def test_MX(self):
     x = msym("x",2)
@@ -74,7 +74,7 @@ class FXtests(casadiTestCase):
     #! Evaluate this function ten times in parallel
     p = Parallelizer([f]*2)
     
-    for mode in ["openmp","serial"]:
+    for mode in ["openmp","serial","threads","mpi"]:
       p.setOption("parallelization",mode)
       p.init()
       
@@ -157,7 +157,7 @@ class FXtests(casadiTestCase):
     
     #! Evaluate this function ten times in parallel
     pp = Parallelizer([f]*2)
-    for mode in ["serial","openmp"]:
+    for mode in ["serial","openmp","threads","mpi"]:
       pp.setOption("parallelization",mode)
       pp.init()
       
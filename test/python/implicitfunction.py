@@ -263,6 +263,71 @@ class NLPtests(casadiTestCase):
     
     self.checkarray(G.output(),DMatrix([2]))
     self.checkarray(J.output(),DMatrix([2]))
+
+  def test_many_directions(self):
+    self.message("More directions than right-hand sides in a panel of the linear solver")
+    n = 5
+    nd = 11
+    
+    # The Jacobian of the residual with respect to y is symmetric, so that LDL^T factorizations can be used
+    A = DMatrix(4*eye(n)+diag(ones(n-1),1)+diag(ones(n-1),-1))
+    makeSparse(A)
+    B = DMatrix([[cos(i+2*j) for j in range(3)] for i in range(n)])
+    y = ssym("y",n)
+    x = ssym("x",3)
+    f = SXFunction([y,x],[mul(A,y)+y**3-mul(B,x)])
+    f.init()
+    x0 = DMatrix([0.3,-0.2,0.5])
+    fseed = [DMatrix([cos(d+k) for k in range(3)]) for d in range(nd)]
+    aseed = [DMatrix([sin(2*d+k) for k in range(n)]) for d in range(nd)]
+    
+    linear_solvers = [CSparse]
+    try:
+      linear_solvers.append(LapackLDLSparse)
+    except:
+      pass
+    for Solver, options in solvers:
+      if 'NLPImplicit' in str(Solver): continue
+      for linear_solver in linear_solvers:
+        message = "%s with %s" % (Solver.__name__, linear_solver.__name__)
+        self.message(message)
+        solver = Solver(f)
+        solver.setOption(options)
+        solver.setOption("linear_solver",linear_solver)
+        solver.setOption("number_of_fwd_dir",nd)
+        solver.setOption("number_of_adj_dir",nd)
+        solver.init()
+        
+        # Jacobian of the solution by central differences
+        h = 1e-5
+        J = DMatrix.zeros(n,3)
+        for k in range(3):
+          for sign in [1,-1]:
+            xp = DMatrix(x0)
+            xp[k] += sign*h
+            solver.setInput(xp)
+            solver.evaluate()
+            J[:,k] += sign*solver.output()/(2*h)
+
+        # All directions at once
+        solver.setInput(x0)
+        for d in range(nd):
+          solver.setFwdSeed(fseed[d],0,d)
+          solver.setAdjSeed(aseed[d],0,d)
+        solver.evaluate(nd,nd)
+        fsens = [DMatrix(solver.getFwdSens(0,d)) for d in range(nd)]
+        asens = [DMatrix(solver.getAdjSens(0,d)) for d in range(nd)]
+        for d in range(nd):
+          self.checkarray(fsens[d],mul(J,fseed[d]),"%s fwd %d" % (message,d),digits=6)
+          self.checkarray(asens[d],mul(J.T,aseed[d]),"%s adj %d" % (message,d),digits=6)
+        
+        # One direction at a time
+        for d in range(nd):
+          solver.setFwdSeed(fseed[d],0,0)
+          solver.setAdjSeed(aseed[d],0,0)
+          solver.evaluate(1,1)
+          self.checkarray(solver.getFwdSens(0,0),fsens[d],"%s single fwd %d" % (message,d),digits=10)
+          self.checkarray(solver.getAdjSens(0,0),asens[d],"%s single adj %d" % (message,d),digits=10)
     
 if __name__ == '__main__':
     unittest.main()
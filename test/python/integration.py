@@ -1402,7 +1402,49 @@ class Integrationtests(casadiTestCase):
 
     integrator.setFwdSeed([1],0)
     integrator.evaluate(1,0) # fail
-    
+
+  @requires("CVodesIntegrator")
+  def test_evaluate_in_place(self):
+    self.message("CVodes right hand sides evaluated in place, sparse parameters")
+    t=ssym("t")
+    x=ssym("x",3)
+    p=ssym("p",sp_diag(2))
+    rx=ssym("rx",2)
+    rp=ssym("rp",sp_diag(2))
+    ode = vertcat([-p[0,0]*x[0]+sin(t)*x[2], x[0]-p[1,1]*x[1], -x[2]*x[1]])
+    quad = x[0]**2 + p[1,1]*x[2]
+    f = SXFunction(daeIn(t=t,x=x,p=p),daeOut(ode=ode,quad=quad))
+    f.init()
+    rode = vertcat([rp[0,0]*rx[0]+x[1]*rx[1], -rx[0]*p[0,0]+rp[1,1]*x[2]])
+    rquad = rx[0]*x[0]+rx[1]
+    g = SXFunction(rdaeIn(t=t,x=x,p=p,rx=rx,rp=rp),rdaeOut(ode=rode,quad=rquad))
+    g.init()
+
+    # Evaluate with and without forward sensitivities, in place and copying via the inputs and outputs of f and g
+    for nfdir,all_at_once in [(0,True),(1,True),(2,True),(2,False)]:
+      results = []
+      for in_place in [True,False]:
+        integrator = CVodesIntegrator(f,g)
+        integrator.setOption({"abstol": 1e-12, "reltol": 1e-12, "tf": 1.3, "evaluate_in_place": in_place, "number_of_fwd_dir": nfdir, "fsens_all_at_once": all_at_once})
+        integrator.init()
+        integrator.setInput([1,0.5,2],"x0")
+        integrator.setInput([0.3,0.7],"p")
+        integrator.setInput([0.2,-1],"rx0")
+        integrator.setInput([0.4,1.1],"rp")
+        if nfdir>0:
+          integrator.setFwdSeed([0.1,1,0],"x0")
+          integrator.setFwdSeed([1,0],"p")
+        if nfdir>1:
+          integrator.setFwdSeed([0,0,1],"x0",1)
+          integrator.setFwdSeed([0,-1],"p",1)
+        integrator.evaluate(nfdir,0)
+        r = [integrator.getOutput(i) for i in range(integrator.getNumOutputs())]
+        for d in range(nfdir):
+          r += [integrator.getFwdSens(i,d) for i in range(integrator.getNumOutputs())]
+        results.append(r)
+      for a,b in zip(results[0],results[1]):
+        self.checkarray(a,b,"evaluate_in_place",digits=12)
+
   def test_collocationPoints(self):
     self.message("collocation points")
     with self.assertRaises(Exception):
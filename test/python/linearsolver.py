@@ -42,6 +42,11 @@ try:
   lsolvers.append((LapackQRDense,{}))
 except:
   pass
+
+try:
+  lsolvers.append((BlockLU,{}))
+except:
+  pass
   
 #try:
 #  lsolvers.append((SymbolicQR,{}))
@@ -313,5 +318,177 @@ class LinearSolverTests(casadiTestCase):
     S.init()
     S.getFactorizationSparsity().spy()
 
+  @requires("LapackLDLSparse")
+  def test_ldl_sparse(self):
+    random.seed(1)
+    n = 10
+    L = self.randDMatrix(n,n,sparsity=0.2) +  c.diag(range(1,n+1))
+    M = mul(L,L.T)
+    b = DMatrix(range(n))
+
+    for ordering in ["natural","amd"]:
+      S = LapackLDLSparse(M.sparsity())
+      S.setOption("ordering",ordering)
+      S.init()
+      S.setInput(M,"A")
+      S.setInput(b.T,"B")
+      S.evaluate()
+      self.checkarray(mul(M,S.output("X").T),b)
+
+  @requires("LapackLDLSparse")
+  def test_ldl_sparse_indefinite(self):
+    self.message("LapackLDLSparse with an indefinite KKT matrix and refactorization")
+    # Hessian with zero diagonal entries and constraint Jacobian
+    nx = 20
+    nc = 8
+    H = DMatrix(nx,nx,0)
+    for i in range(nx):
+      if i%3: H[i,i] = 1+i
+      if i+1<nx:
+        H[i,i+1] = 0.5
+        H[i+1,i] = 0.5
+    J = DMatrix(nc,nx,0)
+    for j in range(nc):
+      for i in range(nx):
+        if (i+j)%5==0 or i==2*j: J[j,i] = 1+(i*j)%3
+    K = blockcat([[H,J.T],[J,DMatrix(nc,nc,0)]])
+    makeSparse(K)
+
+    # The constraints first, so that the first pivots are zero without pivoting
+    p = range(nx,nx+nc)+range(nx)
+    Kp = K[p,p]
+    
+    # New values with the same sparsity pattern
+    H2 = DMatrix(H)
+    for i in range(nx):
+      if i%3==1: H2[i,i] = -0.5*i
+    K2 = 2*blockcat([[H2,J.T],[J,DMatrix(nc,nc,0)]])
+    makeSparse(K2)
+    self.assertTrue(K2.sparsity()==K.sparsity())
+    
+    b = DMatrix([[sin(k+r) for k in range(nx+nc)] for r in range(3)])
+    for ordering in ["natural","amd"]:
+      for A,A2 in [(K,K2),(Kp,K2[p,p])]:
+        S = LapackLDLSparse(A.sparsity(),b.size1())
+        S.setOption("ordering",ordering)
+        S.init()
+        
+        # Factorize, refactorize with new values and go back to the first values
+        for v in [A, A2, A]:
+          S.setInput(v,"A")
+          S.setInput(b,"B")
+          S.evaluate()
+          self.checkarray(mul(v,S.output("X").T),b.T,digits=10)
+    
+    # A singular matrix cannot be factorized
+    A = DMatrix([[0,1,0],[1,0,0],[0,0,0]])
+    S = LapackLDLSparse(sp_dense(3,3))
+    S.init()
+    S.setInput(A,"A")
+    S.setInput(DMatrix([[1,1,1]]),"B")
+    self.assertRaises(Exception,lambda : S.evaluate())
+
+  @requires("LapackLDLSparse")
+  def test_ldl_sparse_grid(self):
+    self.message("LapackLDLSparse with a deep elimination tree")
+    # Shifted 2D Laplacian: indefinite, and AMD gives many independent supernodes on each level
+    g = 12
+    n = g*g
+    A = DMatrix(n,n,0)
+    for i in range(g):
+      for j in range(g):
+        k = i*g+j
+        A[k,k] = 0.7
+        if i+1<g:
+          A[k,k+g] = -1
+          A[k+g,k] = -1
+        if j+1<g:
+          A[k,k+1] = -1
+          A[k+1,k] = -1
+    makeSparse(A)
+    b = DMatrix([[cos(k*(r+1)) for k in range(n)] for r in range(2)])
+    for ordering in ["natural","amd"]:
+      S = LapackLDLSparse(A.sparsity(),b.size1())
+      S.setOption("ordering",ordering)
+      S.init()
+      S.setInput(A,"A")
+      S.setInput(b,"B")
+      S.evaluate()
+      self.checkarray(mul(A,S.output("X").T),b.T,digits=10)
+
+  @requires("CSparse")
+  def test_csparse_refactorize(self):
+    self.message("CSparse with repeated factorizations of the same sparsity pattern")
+    A = DMatrix([[4,1,0,2],[1,5,0,0],[0,2,6,1],[3,0,1,7]])
+    makeSparse(A)
+    b = DMatrix([[1,2,3,4],[0,1,0,-1]])
+    
+    # The same values twice, new values, a tiny diagonal entry whose pivot must be rejected and the first values again
+    tiny = DMatrix(A)
+    tiny[0,0] = 1e-14
+    values = [A, A, 2*A+DMatrix(A.sparsity(),1), tiny, A]
+    
+    for ordering in ["natural","amd","amd_ata"]:
+      solver = CSparse(A.sparsity(),b.size1())
+      solver.setOption("ordering",ordering)
+      solver.init()
+      for A_ in values:
+        for tr in [False,True]:
+          solver.setInput(A_,"A")
+          solver.setInput(b,"B")
+          solver.setInput(tr,"T")
+          solver.evaluate()
+          X = solver.output("X")
+          self.checkarray(mul(A_ if tr else A_.T,X.T),b.T,"%s transpose %d" % (ordering,tr),digits=10)
+
+  def checkblocklu(self,A,options):
+    b = DMatrix([[sin(k+3*r) for k in range(A.size1())] for r in range(2)])
+    solver = BlockLU(A.sparsity(),b.size1())
+    solver.setOption(options)
+    solver.init()
+    for A_ in [A, 2*A]:
+      for tr in [False,True]:
+        solver.setInput(A_,"A")
+        solver.setInput(b,"B")
+        solver.setInput(tr,"T")
+        solver.evaluate()
+        X = solver.output("X")
+        self.checkarray(mul(A_ if tr else A_.T,X.T),b.T,"%s transpose %d" % (str(options),tr),digits=10)
+
+  @requires("CSparse")
+  def test_blocklu_blocks(self):
+    self.message("BlockLU with several nontrivial diagonal blocks")
+    # Irreducible blocks of sizes 3, 5 and 4, coupled below the diagonal
+    n = 12
+    A = DMatrix(n,n,0)
+    offset = 0
+    for b,m in enumerate([3,5,4]):
+      for i in range(m):
+        A[offset+i,offset+i] = 4+i
+        A[offset+i,offset+(i+1)%m] = 1+b
+        if b>0: A[offset+i,offset-1-i%2] = 0.5
+      offset += m
+    makeSparse(A)
+    self.checkblocklu(A,{})
+    self.checkblocklu(A,{"max_dense_block":3,"sparse_solver":CSparse})
+
+  @requires("CSparse")
+  def test_blocklu_large_block(self):
+    self.message("BlockLU with a large irreducible block")
+    n = 80
+    A = DMatrix(n,n,0)
+    for i in range(n):
+      A[i,i] = 2+cos(i)
+      A[i,(i+1)%n] = -1
+      A[i,(i+7)%n] = 0.3
+    makeSparse(A)
+    self.checkblocklu(A,{})
+    
+    # Above the threshold, a sparse linear solver is required
+    solver = BlockLU(A.sparsity())
+    solver.setOption("max_dense_block",20)
+    self.assertRaises(Exception,lambda : solver.init())
+    self.checkblocklu(A,{"max_dense_block":20,"sparse_solver":CSparse})
+
 if __name__ == '__main__':
     unittest.main()
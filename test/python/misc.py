@@ -355,8 +355,52 @@ class Misctests(casadiTestCase):
     b = pickle.loads(s)
     self.checkarray(a,b)
 
+  def test_profiling(self):
+    self.message("profiling")
+    import copy
+    import json
+    import subprocess
+    import sys
+
+    y = ssym("y",3)
+    g = SXFunction([y],[sin(y)])
+    g.setOption("name","profiled_inner")
+    g.init()
+    x = msym("x",3)
+    f = MXFunction([x],[g.call([x])[0]*x])
+    f.setOption("name","profiled_outer")
+    f.init()
+
+    CasadiOptions.startProfiling("profiling.json")
+    f.setInput([1,2,3])
+    f.evaluate()
+    f.evaluate(1,1)
+
+    # A copy is registered separately from the original
+    f2 = copy.deepcopy(f)
+    f2.evaluate()
+    CasadiOptions.stopProfiling()
+
+    profile = json.load(file("profiling.json"))
+    names = profile["casadiFunctions"]
+    self.assertEqual(names.count("profiled_outer"),2)
+    self.assertEqual(names.count("profiled_inner"),2)
+    calls = {}
+    for st in profile["casadiStats"]:
+      if st["node"]<0:
+        calls[st["fcn"]] = st["calls"]
+        self.assertTrue(st["inclusive"]>=st["exclusive"]>=0)
+    outer = [i for i,n in enumerate(names) if n=="profiled_outer"]
+    self.assertEqual(sorted(calls[i] for i in outer),[1,2])
+    self.assertEqual(profile["casadiDroppedEvents"],0)
+
+    # The report tool must be able to read the profile
+    try:
+      import pydot
+    except:
+      return
+    self.assertEqual(subprocess.call([sys.executable,"-mcasadi.tools.profilereport","-o","profiling.html","profiling.json"]),0)
 
-    
 pickle.dump(CRSSparsity(),file("temp.txt","w"))
     
 if __name__ == '__main__':
@@ -2093,6 +2093,31 @@ class MXtests(casadiTestCase):
     with self.assertRaises(RuntimeError):
       mul(msym("X",4,5),MX.zeros(3,2))
 
+  def test_cse(self):
+    self.message("Common subexpression elimination")
+    x = msym("x",2)
+    A = msym("A",2,2)
+    xs = ssym("x",2)
+    g = SXFunction([xs],[sin(xs)])
+    g.init()
+    [g1] = g.call([mul(A,x)])
+    [g2] = g.call([mul(A,x)])
+    r = g1 + g2 + mul(A,x)
+    f = MXFunction([x,A],[r])
+    f.init()
+    h = MXFunction([x,A],[r])
+    h.setOption("cse",True)
+    h.init()
+    self.assertTrue(h.getAlgorithmSize()<f.getAlgorithmSize())
+    for fcn in [f,h]:
+      fcn.setInput([0.3,0.7],0)
+      fcn.setInput([1,2,3,4],1)
+      fcn.setFwdSeed([1,0],0)
+      fcn.setAdjSeed([0,1],0)
+      fcn.evaluate(1,1)
+    self.checkarray(f.output(),h.output(),"cse")
+    self.checkarray(f.fwdSens(),h.fwdSens(),"cse fwd")
+    self.checkarray(f.adjSens(1),h.adjSens(1),"cse adj")
     
 if __name__ == '__main__':
     unittest.main()
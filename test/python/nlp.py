@@ -1194,6 +1194,98 @@ class NLPtests(casadiTestCase):
       self.checkarray(solver.getOutput("lam_g"),DMatrix([4+8.0/9,20.0/9,0]),str(solver),digits=6)
       
       self.assertAlmostEqual(solver.getOutput("f")[0],-10-16.0/9,6,str(solver))
+
+  @requires("IpoptSolver")
+  def test_eval_cache_fusion(self):
+    self.message("Cached NLP evaluations with and without the fused objective gradient and constraint Jacobian")
+    x=ssym("x",2)
+    p=ssym("p")
+    nlp=SXFunction(nlpIn(x=x,p=p),nlpOut(f=(1-x[0])**2+p*(x[1]-x[0]**2)**2,g=vertcat([x[0]**2+x[1]**2,x[0]-x[1]])))
+    nlp.init()
+    
+    sol = []
+    for fused in [True,False]:
+      solver = IpoptSolver(nlp)
+      solver.setOption({"tol":1e-10,"print_level":0,"print_time":False})
+      if not fused:
+        # A user supplied gradient disables the fusion
+        grad_f = nlp.gradient("x","f")
+        solver.setOption("grad_f",grad_f)
+      solver.init()
+      solver.setInput([-1.2,1],"x0")
+      solver.setInput(10,"p")
+      solver.setInput([-inf,-1],"lbg")
+      solver.setInput([1.5,inf],"ubg")
+      solver.solve()
+      sol.append(solver)
+    
+    for r in ["x","f","g","lam_x","lam_g"]:
+      self.checkarray(sol[0].getOutput(r),sol[1].getOutput(r),"fused " + r,digits=10)
+    self.assertEqual(sol[0].getStat("iter_count"),sol[1].getStat("iter_count"))
+
+    for fused, solver in zip([True,False],sol):
+      # Number of function calls from IPOPT and of actual evaluations
+      n_call = dict([(k,solver.getStat("n_call_" + k)) for k in ["f","g","grad_f","jac_g"]])
+      n_eval = dict([(k,solver.getStat("n_eval_" + k)) for k in ["fg","grad_f","jac_g","grad_f_jac_g"]])
+      self.assertTrue(n_call["grad_f"]>0 and n_call["jac_g"]>0)
+      if fused:
+        # Every objective gradient and constraint Jacobian comes from the fused function, which also gives f and g
+        self.assertEqual(n_eval["grad_f"],0)
+        self.assertEqual(n_eval["jac_g"],0)
+        self.assertTrue(n_eval["grad_f_jac_g"]>0)
+        self.assertTrue(n_eval["grad_f_jac_g"]<n_call["grad_f"]+n_call["jac_g"])
+      else:
+        self.assertEqual(n_eval["grad_f_jac_g"],0)
+        self.assertTrue(0<n_eval["grad_f"]<=n_call["grad_f"])
+        self.assertTrue(0<n_eval["jac_g"]<=n_call["jac_g"])
+      
+      # f and g at the same point share one evaluation of the NLP
+      self.assertTrue(n_eval["fg"]+n_eval["grad_f_jac_g"]<n_call["f"]+n_call["g"])
+
+  @requires("IpoptSolver")
+  def test_eval_cache_parameter(self):
+    self.message("Cached NLP evaluations are not reused after the parameters change")
+    x=ssym("x",2)
+    p=ssym("p")
+    nlp=SXFunction(nlpIn(x=x,p=p),nlpOut(f=(p-x[0])**2+10*(x[1]-x[0]**2)**2,g=x[0]+x[1]))
+    def solve(solver,pv,x0):
+      solver.setInput(x0,"x0")
+      solver.setInput(pv,"p")
+      solver.setInput(-10,"lbg")
+      solver.setInput(10,"ubg")
+      solver.solve()
+      return solver.getOutput("x"), solver.getStat("iter_count")
+    def newsolver():
+      solver = IpoptSolver(nlp)
+      solver.setOption({"tol":1e-10,"print_level":0,"print_time":False})
+      solver.init()
+      return solver
+    
+    # Solve twice with the same solver, the second solve starts at the last point evaluated in the first one
+    solver = newsolver()
+    x1, _ = solve(solver,1,[-1.2,1])
+    x1 = DMatrix(x1)
+    x2, iter2 = solve(solver,2,x1)
+    
+    # Same as a fresh solver
+    x2_ref, iter2_ref = solve(newsolver(),2,x1)
+    self.checkarray(x2,x2_ref,"second solve",digits=10)
+    self.checkarray(x2,DMatrix([2,4]),"second solve",digits=6)
+    self.assertEqual(iter2,iter2_ref)
+
+  @requires("IpoptSolver")
+  def test_eval_cache_no_constraints(self):
+    self.message("Cached NLP evaluations without constraints")
+    x=ssym("x",2)
+    nlp=SXFunction(nlpIn(x=x),nlpOut(f=(1-x[0])**2+10*(x[1]-x[0]**2)**2))
+    for hessian_approximation in ["exact","limited-memory"]:
+      solver = IpoptSolver(nlp)
+      solver.setOption({"tol":1e-10,"print_level":0,"print_time":False,"hessian_approximation":hessian_approximation})
+      solver.init()
+      solver.setInput([-1.2,1],"x0")
+      solver.solve()
+      self.checkarray(solver.getOutput("x"),DMatrix([1,1]),"x " + hessian_approximation,digits=6)
+      self.assertAlmostEqual(solver.getOutput("f")[0],0,9)
       
 if __name__ == '__main__':
     unittest.main()
@@ -559,6 +559,68 @@ class Sparsitytests(casadiTestCase):
     
     self.assertTrue(J.output()[:X.size(),:].sparsity()==sp_diag(100))
 
+  def test_jacsparsityHierarchicalBlockBanded(self):
+    self.message("Hierarchical sparsity detection of a multiple shooting transcription")
+    N = 40
+    nx = 10
+    x = ssym("x",nx)
+    u = ssym("u")
+    F = SXFunction([x,u],[sin(x)*sumAll(x) + u*x])
+    F.init()
+
+    V = msym("V",N*(nx+1)+nx)
+    g = []
+    for k in range(N):
+      [xf] = F.call([V[k*(nx+1):k*(nx+1)+nx],V[k*(nx+1)+nx]])
+      g.append(xf - V[(k+1)*(nx+1):(k+1)*(nx+1)+nx])
+    G = MXFunction([V],[vertcat(g)])
+    G.init()
+
+    # Expected block-banded pattern
+    row = []
+    col = []
+    for k in range(N):
+      for i in range(nx):
+        for j in range(nx+1):
+          row.append(k*nx+i)
+          col.append(k*(nx+1)+j)
+        row.append(k*nx+i)
+        col.append((k+1)*(nx+1)+i)
+    self.assertTrue(G.jacSparsity()==sp_triplet(N*nx,N*(nx+1)+nx,row,col))
+
+  def test_coloringParallel(self):
+    self.message("parallel colorings")
+    x = ssym("x",40)
+    f = SXFunction([x],[vertcat([x[i]*x[(i+1)%40]*sin(x[(7*i)%40]) for i in range(40)])])
+    f.init()
+    sp = f.jacSparsity()
+
+    # The rows of one color must not share any column
+    D = sp.unidirectionalColoringParallel()
+    for c in range(D.size1()):
+      rows = D.getCol()[D.rowind(c):D.rowind(c+1)]
+      cols = [j for i in rows for j in sp.getCol()[sp.rowind(i):sp.rowind(i+1)]]
+      self.assertEqual(len(cols),len(set(cols)))
+
+    # Compare Jacobians and Hessians calculated with and without parallel colorings
+    for parallel in [False,True]:
+      f = SXFunction([x],[vertcat([x[i]*x[(i+1)%40]*sin(x[(7*i)%40]) for i in range(40)]),sum([x[i]*sin(x[(i+3)%40]) for i in range(40)])])
+      f.setOption("parallel_coloring",parallel)
+      f.init()
+      J = f.jacobian(0,0)
+      J.init()
+      H = f.hessian(0,1)
+      H.init()
+      for F in [J,H]:
+        F.setInput(range(40))
+        F.evaluate()
+      if parallel:
+        self.checkarray(J.output(),J_ref,"jacobian")
+        self.checkarray(H.output(),H_ref,"hessian")
+      else:
+        J_ref = DMatrix(J.output())
+        H_ref = DMatrix(H.output())
+
 
 if __name__ == '__main__':
     unittest.main()
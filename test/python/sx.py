@@ -1254,7 +1254,99 @@ class SXtests(casadiTestCase):
     self.assertTrue(h.output().sparsity()==H.sparsity())
     
     self.checkarray(h.output().data(),H.data())
-    
+
+  def test_cse(self):
+    self.message("Common subexpression elimination")
+    x = ssym("x",2)
+    y = [sin(x[0])*cos(x[1]), cos(x[1])*sin(x[0]), sin(x[0])*cos(x[1])+x[1]]
+    f = SXFunction([x],[vertcat(y)])
+    f.init()
+    g = SXFunction([x],[vertcat(y)])
+    g.setOption("cse",True)
+    g.init()
+    self.assertTrue(g.getAlgorithmSize()<f.getAlgorithmSize())
+    for fcn in [f,g]:
+      fcn.setInput([0.3,0.7])
+      fcn.evaluate()
+    self.checkarray(f.output(),g.output(),"cse")
+    J = f.jacobian()
+    J.init()
+    K = g.jacobian()
+    K.init()
+    for fcn in [J,K]:
+      fcn.setInput([0.3,0.7])
+      fcn.evaluate()
+    self.checkarray(J.output(),K.output(),"cse jacobian")
+
+  def test_sparsity_width(self):
+    self.message("Sparsity propagation with several words per nonzero")
+    x = ssym("x",1000)
+    y = vertcat([x[i]*sin(x[(7*i)%1000])+x[(i+1)%1000] for i in range(600)])
+    for mode in ["forward","reverse"]:
+      sp = []
+      for width in [1,3,8]:
+        f = SXFunction([x],[y])
+        f.setOption("sparsity_width",width)
+        f.setOption("ad_mode",mode)
+        f.init()
+        sp.append(f.jacSparsity())
+      for s in sp:
+        self.assertTrue(s==sp[0])
+
+  def test_compact_algorithm(self):
+    self.message("Compact algorithm and direct-threaded interpreter")
+    def check(inputs,outputs,name):
+      ref = SXFunction(inputs,outputs)
+      ref.setOption("compact_algorithm",False)
+      ref.init()
+      for compact in [False,True]:
+        for threaded in [False,True]:
+          f = SXFunction(inputs,outputs)
+          f.setOption("compact_algorithm",compact)
+          f.setOption("threaded_interpreter",threaded)
+          f.init()
+          for fcn in [ref,f]:
+            for i in range(fcn.getNumInputs()):
+              fcn.setInput([0.3+0.1*k+i for k in range(fcn.input(i).size())],i)
+            fcn.evaluate()
+          for i in range(f.getNumOutputs()):
+            self.checkarray(f.output(i),ref.output(i),"%s compact %d threaded %d output %d" % (name,compact,threaded,i),digits=12)
+
+    x = ssym("x",8)
+    y = ssym("y",3)
+    
+    # Fused multiply-add
+    muladd = [x[0]*x[1]+x[2], x[2]+x[0]*x[1]*x[3]]
+    
+    # Operations with a constant operand
+    const = [x[0]+2, x[0]-2, 2-x[1], x[2]*3, x[3]/3, 3/x[4]]
+    
+    # Linear combinations with constant coefficients
+    dot1 = 0
+    for k in range(8): dot1 += (k+2.)*x[k]
+    dot2 = 0
+    for k in range(6): dot2 += (k+1.5)*sin(x[k])
+    
+    # Chain that overwrites work vector elements in place
+    chain = y[1]
+    for k in range(3): chain = chain*y[2]+x[k]
+    
+    # Outputs that are inputs
+    check([x,y],[vertcat(muladd),vertcat(const),dot1,dot2*y[0]+dot1,chain,y,x],"16 bit")
+    
+    # 32 bit indices are used when the algorithm, the work vector or an input or output has more than 65535 elements,
+    # here the algorithm is the largest (the work vector is much shorter)
+    z = ssym("z",100)
+    acc = z
+    tot = 0
+    for it in range(400):
+      acc = vertcat([sin(acc[(k+1)%100])*acc[k] + 0.5*acc[(k+7)%100] + 1.0/(it+2) for k in range(100)])
+      tot += acc[it%100]*(it+1.)
+    f = SXFunction([z],[acc,tot])
+    f.init()
+    self.assertTrue(max(f.getAlgorithmSize(),f.getWorkSize())>65535)
+    check([z],[acc,tot],"32 bit")
+
 if __name__ == '__main__':
     unittest.main()
 